@@ -0,0 +1,189 @@
+///////////////////////////////////////////////////////////////////////////////
+// allocationcounter.cpp
+// ============
+// count the heap allocations made by the frame threads between two points
+///////////////////////////////////////////////////////////////////////////////
+
+#include "AllocationCounter.h"
+
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+// declaration of global variables and helper functions
+namespace
+{
+	// set on the threads whose allocations are counted
+	thread_local bool g_bMarkedThread = false;
+	// switches the counting on for every marked thread
+	std::atomic<bool> g_bCounting(false);
+
+	std::atomic<uint64_t> g_AllocationCount(0);
+	std::atomic<uint64_t> g_AllocationBytes(0);
+
+	/***********************************************************
+	 *  Allocate()
+	 *
+	 *  This function is used for allocating heap memory the way
+	 *  the standard operator new does, calling the new handler
+	 *  until the memory can be allocated or there is no handler
+	 *  left, and counting the allocation when the calling thread
+	 *  is marked and counting is on.  NULL is only returned
+	 *  when bThrow is false.
+	 ***********************************************************/
+	void* Allocate(std::size_t size, bool bThrow)
+	{
+		if ((g_bMarkedThread == true) && (g_bCounting.load(std::memory_order_relaxed) == true))
+		{
+			g_AllocationCount.fetch_add(1, std::memory_order_relaxed);
+			g_AllocationBytes.fetch_add(size, std::memory_order_relaxed);
+		}
+
+		if (size == 0)
+		{
+			size = 1;
+		}
+
+		void* pMemory = malloc(size);
+		while (NULL == pMemory)
+		{
+			std::new_handler handler = std::get_new_handler();
+			if (NULL == handler)
+			{
+				if (bThrow == true)
+				{
+					throw std::bad_alloc();
+				}
+				return(NULL);
+			}
+			handler();
+			pMemory = malloc(size);
+		}
+		return(pMemory);
+	}
+}
+
+/***********************************************************
+ *  operator new()
+ *
+ *  These functions replace the global allocation functions
+ *  so that the allocations can be counted.  The memory comes
+ *  from malloc() and goes back with free().
+ ***********************************************************/
+void* operator new(std::size_t size)
+{
+	return(Allocate(size, true));
+}
+
+void* operator new[](std::size_t size)
+{
+	return(Allocate(size, true));
+}
+
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept
+{
+	return(Allocate(size, false));
+}
+
+void* operator new[](std::size_t size, const std::nothrow_t&) noexcept
+{
+	return(Allocate(size, false));
+}
+
+void operator delete(void* pMemory) noexcept
+{
+	free(pMemory);
+}
+
+void operator delete[](void* pMemory) noexcept
+{
+	free(pMemory);
+}
+
+void operator delete(void* pMemory, const std::nothrow_t&) noexcept
+{
+	free(pMemory);
+}
+
+void operator delete[](void* pMemory, const std::nothrow_t&) noexcept
+{
+	free(pMemory);
+}
+
+void operator delete(void* pMemory, std::size_t) noexcept
+{
+	free(pMemory);
+}
+
+void operator delete[](void* pMemory, std::size_t) noexcept
+{
+	free(pMemory);
+}
+
+/***********************************************************
+ *  Start()
+ *
+ *  This method is used for marking the calling thread and
+ *  counting the allocations of every marked thread from now
+ *  on.
+ ***********************************************************/
+void AllocationCounter::Start()
+{
+	g_bMarkedThread = true;
+	g_bCounting.store(true);
+}
+
+/***********************************************************
+ *  Stop()
+ *
+ *  This method is used for no longer counting the
+ *  allocations of the marked threads.
+ ***********************************************************/
+void AllocationCounter::Stop()
+{
+	g_bCounting.store(false);
+}
+
+/***********************************************************
+ *  MarkThread()
+ *
+ *  This method is used for having the allocations of the
+ *  calling thread counted whenever counting is on.
+ ***********************************************************/
+void AllocationCounter::MarkThread()
+{
+	g_bMarkedThread = true;
+}
+
+/***********************************************************
+ *  Reset()
+ *
+ *  This method is used for setting the counts back to zero.
+ ***********************************************************/
+void AllocationCounter::Reset()
+{
+	g_AllocationCount.store(0, std::memory_order_relaxed);
+	g_AllocationBytes.store(0, std::memory_order_relaxed);
+}
+
+/***********************************************************
+ *  GetCount()
+ *
+ *  This method is used for getting the number of counted
+ *  allocations.
+ ***********************************************************/
+uint64_t AllocationCounter::GetCount()
+{
+	return(g_AllocationCount.load(std::memory_order_relaxed));
+}
+
+/***********************************************************
+ *  GetBytes()
+ *
+ *  This method is used for getting the number of bytes the
+ *  counted allocations asked for.
+ ***********************************************************/
+uint64_t AllocationCounter::GetBytes()
+{
+	return(g_AllocationBytes.load(std::memory_order_relaxed));
+}
@@ -0,0 +1,41 @@
+///////////////////////////////////////////////////////////////////////////////
+// allocationcounter.h
+// ============
+// count the heap allocations made by the frame threads between two points
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <cstdint>
+
+/***********************************************************
+ *  AllocationCounter
+ *
+ *  This class counts the calls to the global operator new,
+ *  which this module replaces with a version that forwards
+ *  to malloc().  Counting is switched on and off for all
+ *  threads at once, but only the allocations of the threads
+ *  that render a frame are counted - the thread that called
+ *  Start() and the threads that marked themselves, such as
+ *  the worker pool threads that run the scene systems - so
+ *  that the logger thread and the driver's own threads do
+ *  not show up in the count.  While counting is off, the
+ *  replaced operator new costs one thread-local flag check.
+ ***********************************************************/
+class AllocationCounter
+{
+public:
+	// start and stop counting the allocations of the marked
+	// threads - starting marks the calling thread
+	static void Start();
+	static void Stop();
+	// mark the calling thread as one whose allocations are
+	// counted while counting is on
+	static void MarkThread();
+
+	// forget the counted allocations
+	static void Reset();
+	// allocations and bytes counted since the last Reset()
+	static uint64_t GetCount();
+	static uint64_t GetBytes();
+};
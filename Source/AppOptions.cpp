@@ -0,0 +1,354 @@
+///////////////////////////////////////////////////////////////////////////////
+// appoptions.cpp
+// ============
+// parse the command line options that select the application run mode
+///////////////////////////////////////////////////////////////////////////////
+
+#include "AppOptions.h"
+
+#include <iostream>
+#include <cstdlib>
+#include <cstring>
+
+// declaration of the helper functions
+namespace
+{
+	/***********************************************************
+	 *  ReadIntValue()
+	 *
+	 *  This function is used for reading the integer value that
+	 *  follows an option name on the command line.
+	 ***********************************************************/
+	bool ReadIntValue(int argc, char* argv[], int& index, int& value)
+	{
+		if (index + 1 >= argc)
+		{
+			std::cerr << "Missing value for option " << argv[index] << std::endl;
+			return(false);
+		}
+
+		index++;
+		value = atoi(argv[index]);
+		return(true);
+	}
+
+	/***********************************************************
+	 *  ReadFloatValue()
+	 *
+	 *  This function is used for reading the floating point
+	 *  value that follows an option name on the command line.
+	 ***********************************************************/
+	bool ReadFloatValue(int argc, char* argv[], int& index, float& value)
+	{
+		if (index + 1 >= argc)
+		{
+			std::cerr << "Missing value for option " << argv[index] << std::endl;
+			return(false);
+		}
+
+		index++;
+		value = (float)atof(argv[index]);
+		return(true);
+	}
+
+	/***********************************************************
+	 *  ReadStringValue()
+	 *
+	 *  This function is used for reading the string value that
+	 *  follows an option name on the command line.
+	 ***********************************************************/
+	bool ReadStringValue(int argc, char* argv[], int& index, std::string& value)
+	{
+		if (index + 1 >= argc)
+		{
+			std::cerr << "Missing value for option " << argv[index] << std::endl;
+			return(false);
+		}
+
+		index++;
+		value = argv[index];
+		return(true);
+	}
+}
+
+/***********************************************************
+ *  ParseCommandLine()
+ *
+ *  This function is used for parsing the passed in command
+ *  line arguments into the application options.
+ ***********************************************************/
+bool ParseCommandLine(int argc, char* argv[], APP_OPTIONS& options)
+{
+	bool bReturn = true;
+
+	for (int i = 1; (i < argc) && (bReturn == true); i++)
+	{
+		if (strcmp(argv[i], "--benchmark") == 0)
+		{
+			options.bBenchmark = true;
+		}
+		else if (strcmp(argv[i], "--frames") == 0)
+		{
+			bReturn = ReadIntValue(argc, argv, i, options.benchmarkFrames);
+		}
+		else if (strcmp(argv[i], "--warmup") == 0)
+		{
+			bReturn = ReadIntValue(argc, argv, i, options.warmupFrames);
+		}
+		else if (strcmp(argv[i], "--report") == 0)
+		{
+			bReturn = ReadStringValue(argc, argv, i, options.reportPath);
+		}
+		else if (strcmp(argv[i], "--profile") == 0)
+		{
+			bReturn = ReadStringValue(argc, argv, i, options.profileTracePath);
+		}
+		else if (strcmp(argv[i], "--stats") == 0)
+		{
+			options.bLogStats = true;
+		}
+		else if (strcmp(argv[i], "--pacing") == 0)
+		{
+			bReturn = ReadStringValue(argc, argv, i, options.pacingReportPath);
+		}
+		else if (strcmp(argv[i], "--pipeline-stats") == 0)
+		{
+			options.bPipelineStats = true;
+		}
+		else if (strcmp(argv[i], "--gpu-categories") == 0)
+		{
+			options.bCategoryTimes = true;
+		}
+		else if (strcmp(argv[i], "--capture") == 0)
+		{
+			options.bBenchmark = true;
+			bReturn = ReadStringValue(argc, argv, i, options.capturePath);
+		}
+		else if (strcmp(argv[i], "--replay") == 0)
+		{
+			options.bBenchmark = true;
+			bReturn = ReadStringValue(argc, argv, i, options.replayPath);
+		}
+		else if (strcmp(argv[i], "--camera-path") == 0)
+		{
+			bReturn = ReadStringValue(argc, argv, i, options.cameraPathFile);
+		}
+		else if (strcmp(argv[i], "--time-step") == 0)
+		{
+			bReturn = ReadFloatValue(argc, argv, i, options.cameraTimeStep);
+		}
+		else if (strcmp(argv[i], "--startup-report") == 0)
+		{
+			bReturn = ReadStringValue(argc, argv, i, options.startupReportPath);
+		}
+		else if (strcmp(argv[i], "--startup-bench") == 0)
+		{
+			options.bStartupBenchmark = true;
+		}
+		else if (strcmp(argv[i], "--startup-runs") == 0)
+		{
+			bReturn = ReadIntValue(argc, argv, i, options.startupRuns);
+		}
+		else if (strcmp(argv[i], "--scene") == 0)
+		{
+			bReturn = ReadStringValue(argc, argv, i, options.sceneFile);
+		}
+		else if (strcmp(argv[i], "--stress") == 0)
+		{
+			bReturn = ReadIntValue(argc, argv, i, options.stressObjects);
+		}
+		else if (strcmp(argv[i], "--stress-seed") == 0)
+		{
+			bReturn = ReadIntValue(argc, argv, i, options.stressSeed);
+		}
+		else if (strcmp(argv[i], "--baked-scene") == 0)
+		{
+			options.bBakedScene = true;
+		}
+		else if (strcmp(argv[i], "--compiled-scene") == 0)
+		{
+			bReturn = ReadStringValue(argc, argv, i, options.compiledSceneFile);
+		}
+		else if (strcmp(argv[i], "--compile-scene") == 0)
+		{
+			bReturn = ReadStringValue(argc, argv, i, options.compileScenePath);
+		}
+		else if (strcmp(argv[i], "--system-threads") == 0)
+		{
+			bReturn = ReadIntValue(argc, argv, i, options.systemThreads);
+		}
+		else if (strcmp(argv[i], "--stream-cells") == 0)
+		{
+			bReturn = ReadFloatValue(argc, argv, i, options.streamCellSize);
+		}
+		else if (strcmp(argv[i], "--stream-radius") == 0)
+		{
+			bReturn = ReadFloatValue(argc, argv, i, options.streamRadius);
+		}
+		else if (strcmp(argv[i], "--stream-budget") == 0)
+		{
+			bReturn = ReadIntValue(argc, argv, i, options.streamBudgetMB);
+		}
+		else if (strcmp(argv[i], "--debug-view") == 0)
+		{
+			std::string view;
+			bReturn = ReadStringValue(argc, argv, i, view);
+			if (view == "shaded")
+			{
+				options.debugView = 0;
+			}
+			else if (view == "overdraw")
+			{
+				options.debugView = 1;
+			}
+			else if (view == "cost")
+			{
+				options.debugView = 2;
+			}
+			else if (bReturn == true)
+			{
+				std::cerr << "Unknown debug view: " << view << std::endl;
+				bReturn = false;
+			}
+		}
+		else if (strcmp(argv[i], "--microbench") == 0)
+		{
+			options.bMicrobench = true;
+		}
+		else if (strcmp(argv[i], "--transform-bench") == 0)
+		{
+			options.bTransformBenchmark = true;
+		}
+		else if (strcmp(argv[i], "--check-allocs") == 0)
+		{
+			options.bBenchmark = true;
+			options.bCheckAllocations = true;
+		}
+		else if (strcmp(argv[i], "--check-edits") == 0)
+		{
+			options.bBenchmark = true;
+			options.bCheckEdits = true;
+		}
+		else
+		{
+			std::cerr << "Unknown option: " << argv[i] << std::endl;
+			bReturn = false;
+		}
+	}
+
+	if ((bReturn == true) && !options.capturePath.empty() && !options.replayPath.empty())
+	{
+		std::cerr << "A draw stream cannot be captured and replayed at the same time" << std::endl;
+		bReturn = false;
+	}
+
+	if ((bReturn == true) && options.bCheckAllocations && (!options.capturePath.empty() || !options.replayPath.empty()))
+	{
+		std::cerr << "The allocation check runs the scene code and cannot capture or replay a draw stream" << std::endl;
+		bReturn = false;
+	}
+
+	if ((bReturn == true) && options.bCheckEdits && (options.bCheckAllocations || !options.capturePath.empty() || !options.replayPath.empty()))
+	{
+		std::cerr << "The object edit check runs on its own and cannot capture or replay a draw stream" << std::endl;
+		bReturn = false;
+	}
+
+	if ((bReturn == true) && options.bCheckEdits && !options.compiledSceneFile.empty())
+	{
+		std::cerr << "The object edit check needs the scene objects and cannot use a compiled scene" << std::endl;
+		bReturn = false;
+	}
+
+	if ((bReturn == true) && ((options.benchmarkFrames <= 0) || (options.warmupFrames < 0)))
+	{
+		std::cerr << "The benchmark frame counts must be positive" << std::endl;
+		bReturn = false;
+	}
+
+	if ((bReturn == true) && (options.startupRuns <= 0))
+	{
+		std::cerr << "The number of startup runs must be positive" << std::endl;
+		bReturn = false;
+	}
+
+	if ((bReturn == true) && (options.stressObjects < 0))
+	{
+		std::cerr << "The number of stress scene objects cannot be negative" << std::endl;
+		bReturn = false;
+	}
+
+	if ((bReturn == true) && (options.systemThreads <= 0))
+	{
+		std::cerr << "The number of scene system threads must be positive" << std::endl;
+		bReturn = false;
+	}
+
+	if ((bReturn == true) && ((options.streamCellSize < 0.0f) || (options.streamRadius <= 0.0f) || (options.streamBudgetMB <= 0)))
+	{
+		std::cerr << "The stream cell size, radius and budget must be positive" << std::endl;
+		bReturn = false;
+	}
+
+	if ((bReturn == true) && (options.streamCellSize > 0.0f) && (options.compiledSceneFile.empty() || (options.stressObjects > 0)))
+	{
+		std::cerr << "Only a compiled scene (--compiled-scene) can be streamed" << std::endl;
+		bReturn = false;
+	}
+
+	if ((bReturn == true) && options.bCheckAllocations && (options.streamCellSize > 0.0f))
+	{
+		std::cerr << "The allocation check cannot stream scene cells, which allocate as they load" << std::endl;
+		bReturn = false;
+	}
+
+	if ((bReturn == true) && (options.cameraTimeStep <= 0.0f))
+	{
+		std::cerr << "The camera path time step must be positive" << std::endl;
+		bReturn = false;
+	}
+
+	return(bReturn);
+}
+
+/***********************************************************
+ *  PrintUsage()
+ *
+ *  This function is used for displaying the supported
+ *  command line arguments.
+ ***********************************************************/
+void PrintUsage(const char* programName)
+{
+	std::cerr << "Usage: " << programName << " [options]\n"
+		<< "  --benchmark          render offscreen and report frame timings\n"
+		<< "  --frames <count>     number of measured benchmark frames (default 500)\n"
+		<< "  --warmup <count>     number of unmeasured warmup frames (default 50)\n"
+		<< "  --report <file>      JSON report path, \"-\" for stdout (default benchmark_report.json)\n"
+		<< "  --profile <file>     record CPU/GPU zones into a Chrome trace file\n"
+		<< "  --stats              log draw, uniform, texture and triangle counts every second\n"
+		<< "  --pacing <file>      write frame time histogram, stutters and 1% lows on exit\n"
+		<< "  --pipeline-stats     report shader invocations per object group in the benchmark\n"
+		<< "  --gpu-categories     rank the GPU time of each object category in the benchmark\n"
+		<< "  --capture <file>     record --frames offscreen frames into a draw stream file\n"
+		<< "  --replay <file>      benchmark the replay of a recorded draw stream file\n"
+		<< "  --camera-path <file> fly the camera along a keyframed path file\n"
+		<< "  --time-step <sec>    simulated seconds per frame on the camera path (default 1/60)\n"
+		<< "  --startup-report <file> write the startup phase timings after the first frame\n"
+		<< "  --startup-bench      time headless startups with cold and warm file caches\n"
+		<< "  --startup-runs <count> number of cold and of warm startups (default 3)\n"
+		<< "  --scene <file>       load the scene objects from a scene file (default scenes/default.scene)\n"
+		<< "  --stress <count>     draw generated trees, mountains and clouds instead of the scene\n"
+		<< "  --stress-seed <seed> seed of the generated object placement (default 1)\n"
+		<< "  --baked-scene        draw the default scene with its matrices baked in at compile time\n"
+		<< "  --compiled-scene <file> draw a compiled scene file, mapped and used in place\n"
+		<< "  --compile-scene <file> compile the selected scene (--scene or --stress) into a file and exit\n"
+		<< "  --system-threads <count> split the scene transform, culling and draw list systems across threads (default 1)\n"
+		<< "  --stream-cells <size> stream the compiled scene in cells of this size around the camera\n"
+		<< "  --stream-radius <distance> keep the cells within this distance of the camera (default 200)\n"
+		<< "  --stream-budget <MB> memory the streamed cells may take (default 256)\n"
+		<< "  --debug-view <view>  start in the shaded, overdraw or cost view (F1-F3 switch)\n"
+		<< "  --microbench         time the per-draw scene helpers without OpenGL\n"
+		<< "  --transform-bench    time batched model matrix building for 1k to 1M objects\n"
+		<< "  --check-allocs       fail if 1000 headless frames after the warmup allocate heap memory\n"
+		<< "  --check-edits        add, remove, re-add and move 1000 objects and fail on a wrong handle or upload\n";
+}
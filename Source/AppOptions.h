@@ -0,0 +1,123 @@
+///////////////////////////////////////////////////////////////////////////////
+// appoptions.h
+// ============
+// parse the command line options that select the application run mode
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <string>
+
+/***********************************************************
+ *  APP_OPTIONS
+ *
+ *  This structure holds the settings that were passed in on
+ *  the command line.  When no options are passed in, the
+ *  application runs the interactive GLFW display loop.
+ ***********************************************************/
+struct APP_OPTIONS
+{
+	// run the headless offscreen benchmark instead of the
+	// interactive display window
+	bool bBenchmark = false;
+	// number of measured benchmark frames
+	int benchmarkFrames = 500;
+	// number of unmeasured frames rendered before measuring
+	int warmupFrames = 50;
+	// path of the JSON benchmark report - "-" for stdout
+	std::string reportPath = "benchmark_report.json";
+
+	// record profiler zones into this Chrome trace file as the
+	// frames finish, completing it on exit or when F12 is
+	// pressed - empty when disabled
+	std::string profileTracePath;
+
+	// write the per-frame GL call counters once every second
+	bool bLogStats = false;
+	// write the frame pacing histogram and stutter counts of the
+	// display loop to this file on exit - empty when disabled
+	std::string pacingReportPath;
+	// add the shader invocation counts of each object group to
+	// the benchmark report
+	bool bPipelineStats = false;
+	// add the GPU time of each object category to the benchmark
+	// report
+	bool bCategoryTimes = false;
+
+	// record the uniform writes and draws of the benchmark frames
+	// into this draw stream file instead of measuring them
+	std::string capturePath;
+	// benchmark the replay of this draw stream file instead of
+	// running the scene code
+	std::string replayPath;
+
+	// drive the camera from this keyframed path file instead of
+	// the keyboard and mouse - empty for interactive control
+	std::string cameraPathFile;
+	// simulated seconds the camera path advances every frame
+	float cameraTimeStep = 1.0f / 60.0f;
+
+	// write the startup phase timings of the display loop to
+	// this file after the first frame - empty when disabled
+	std::string startupReportPath;
+	// time repeated headless startups with cold and warm file
+	// caches and write the results to the report path
+	bool bStartupBenchmark = false;
+	// number of cold and of warm startups
+	int startupRuns = 3;
+
+	// load the scene objects from this file instead of the
+	// default scene file - empty for the default
+	std::string sceneFile;
+	// draw this many generated trees, mountains and clouds
+	// instead of the scene file objects - 0 when disabled
+	int stressObjects = 0;
+	// seed of the generated object placement
+	int stressSeed = 1;
+	// draw the default scene baked in at compile time instead of
+	// loading the scene file
+	bool bBakedScene = false;
+	// draw the objects of this compiled scene file, mapped in
+	// place - empty when not used
+	std::string compiledSceneFile;
+	// compile the scene that would be drawn into this file and
+	// exit - empty when not compiling
+	std::string compileScenePath;
+	// number of threads the per-frame scene systems are split
+	// across, counting the render thread
+	int systemThreads = 1;
+	// stream the compiled scene in square cells of this size
+	// around the camera - 0 draws all of it
+	float streamCellSize = 0.0f;
+	// distance from the camera within which cells are resident
+	float streamRadius = 200.0f;
+	// megabytes the resident cells may take
+	int streamBudgetMB = 256;
+
+	// debug view rendered from the start - 0 shaded, 1 overdraw,
+	// 2 shader cost, matching ViewManager::DEBUG_VIEW
+	int debugView = 0;
+
+	// time the per-draw SceneManager helpers without OpenGL and
+	// write the results to the report path
+	bool bMicrobench = false;
+	// count the heap allocations of the headless benchmark
+	// frames after the warmup and fail when there are any
+	bool bCheckAllocations = false;
+	// number of frames whose allocations are counted
+	int allocationCheckFrames = 1000;
+	// add, remove, re-add and move objects of the headless
+	// scene and fail when a handle or an object buffer upload
+	// is wrong
+	bool bCheckEdits = false;
+	// number of objects the edit check adds
+	int editCheckObjects = 1000;
+	// time building the model matrices of 1k to 1M objects with
+	// and without the batched transform store
+	bool bTransformBenchmark = false;
+};
+
+// parse the passed in command line arguments into the options
+bool ParseCommandLine(int argc, char* argv[], APP_OPTIONS& options);
+// display the supported command line arguments
+void PrintUsage(const char* programName);
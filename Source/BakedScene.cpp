@@ -0,0 +1,189 @@
+///////////////////////////////////////////////////////////////////////////////
+// bakedscene.cpp
+// ============
+// the default scene with its model matrices computed at compile time
+///////////////////////////////////////////////////////////////////////////////
+
+#include "BakedScene.h"
+#include "CompositeShapes.h"
+
+// declaration of global variables and helper functions
+namespace
+{
+	/***********************************************************
+	 *  BAKED_PLACEMENT
+	 *
+	 *  This structure holds where one composite shape of the
+	 *  baked scene is placed.
+	 ***********************************************************/
+	struct BAKED_PLACEMENT
+	{
+		COMPOSITE_TYPE type;
+		float position[3];
+		float scale;
+	};
+
+	// the shapes of scenes/default.scene
+	constexpr BAKED_PLACEMENT g_DefaultPlacements[] =
+	{
+		{ COMPOSITE_PLANES, { 0.0f, 0.0f, -100.0f }, 1.0f },
+
+		{ COMPOSITE_PYRAMID_TREE, { -5.0f, 0.0f, -30.0f }, 1.0f },
+		{ COMPOSITE_PYRAMID_TREE, { 5.0f, 0.0f, -10.0f }, 1.0f },
+		{ COMPOSITE_SPHERICAL_TREE, { -45.0f, 0.0f, -15.0f }, 1.0f },
+		{ COMPOSITE_SPHERICAL_TREE, { -40.0f, 0.0f, -35.0f }, 1.0f },
+		{ COMPOSITE_PYRAMID_TREE, { 45.0f, 0.0f, -10.0f }, 1.0f },
+		{ COMPOSITE_SPHERICAL_TREE, { 50.0f, 0.0f, -35.0f }, 1.0f },
+
+		{ COMPOSITE_MOUNTAIN, { -50.0f, 25.0f, -80.0f }, 50.0f },
+		{ COMPOSITE_MOUNTAIN, { -30.0f, 15.0f, -120.0f }, 30.0f },
+		{ COMPOSITE_MOUNTAIN, { 40.0f, 10.0f, -80.0f }, 20.0f },
+		{ COMPOSITE_MOUNTAIN, { 55.0f, 24.0f, -120.0f }, 48.0f },
+		{ COMPOSITE_MOUNTAIN, { 70.0f, 10.0f, -80.0f }, 20.0f },
+
+		{ COMPOSITE_CLOUD, { 10.0f, 100.0f, -80.0f }, 2.0f },
+		{ COMPOSITE_CLOUD, { -50.0f, 85.0f, -90.0f }, 2.0f },
+		{ COMPOSITE_CLOUD, { 50.0f, 50.0f, -70.0f }, 2.0f }
+	};
+
+	const size_t PLACEMENT_COUNT = sizeof(g_DefaultPlacements) / sizeof(g_DefaultPlacements[0]);
+
+	/***********************************************************
+	 *  BAKED_OBJECT
+	 *
+	 *  This structure holds one part of a placed shape with its
+	 *  final scale, position and model matrix.
+	 ***********************************************************/
+	struct BAKED_OBJECT
+	{
+		const COMPOSITE_PART* pPart;
+		float scale[3];
+		float position[3];
+		TransformStore::AFFINE_3X4 affine;
+	};
+
+	template <size_t COUNT>
+	struct BAKED_TABLE
+	{
+		BAKED_OBJECT objects[COUNT];
+	};
+
+	/***********************************************************
+	 *  CountParts()
+	 *
+	 *  This function is used for counting the parts of every
+	 *  placed shape.
+	 ***********************************************************/
+	constexpr size_t CountParts(const BAKED_PLACEMENT* pPlacements, size_t count)
+	{
+		size_t parts = 0;
+		for (size_t i = 0; i < count; i++)
+		{
+			parts += g_CompositeShapes[pPlacements[i].type].partCount;
+		}
+		return(parts);
+	}
+
+	/***********************************************************
+	 *  BakeScene()
+	 *
+	 *  This function is used for expanding the placed shapes
+	 *  into their parts and composing the model matrix of each
+	 *  part, in the same order as the scene file loader.
+	 ***********************************************************/
+	template <size_t COUNT>
+	constexpr BAKED_TABLE<COUNT> BakeScene(const BAKED_PLACEMENT* pPlacements, size_t placementCount)
+	{
+		BAKED_TABLE<COUNT> table = {};
+		size_t object = 0;
+
+		for (size_t i = 0; i < placementCount; i++)
+		{
+			const BAKED_PLACEMENT& placement = pPlacements[i];
+			const COMPOSITE_SHAPE& shape = g_CompositeShapes[placement.type];
+
+			for (size_t p = 0; p < shape.partCount; p++)
+			{
+				const COMPOSITE_PART& part = shape.pParts[p];
+				float partScale = (part.bScaled == true) ? placement.scale : 1.0f;
+				BAKED_OBJECT& baked = table.objects[object];
+
+				baked.pPart = &part;
+				for (int axis = 0; axis < 3; axis++)
+				{
+					baked.scale[axis] = part.scale[axis] * partScale;
+					baked.position[axis] = placement.position[axis] + part.offset[axis];
+				}
+				ComposeAffine(baked.scale, part.rotation, baked.position, baked.affine.m);
+				object++;
+			}
+		}
+		return(table);
+	}
+
+	constexpr size_t BAKED_OBJECT_COUNT = CountParts(g_DefaultPlacements, PLACEMENT_COUNT);
+
+	// evaluated by the compiler - the executable holds only the
+	// finished table
+	constexpr BAKED_TABLE<BAKED_OBJECT_COUNT> g_BakedScene =
+		BakeScene<BAKED_OBJECT_COUNT>(g_DefaultPlacements, PLACEMENT_COUNT);
+}
+
+/***********************************************************
+ *  GetCount()
+ *
+ *  This method is used for getting the number of objects in
+ *  the baked table.
+ ***********************************************************/
+size_t BakedScene::GetCount()
+{
+	return(BAKED_OBJECT_COUNT);
+}
+
+/***********************************************************
+ *  AddToScene()
+ *
+ *  This method is used for adding every baked object to the
+ *  end of the passed in scene.
+ ***********************************************************/
+void BakedScene::AddToScene(SceneDescription& scene)
+{
+	for (size_t i = 0; i < BAKED_OBJECT_COUNT; i++)
+	{
+		const BAKED_OBJECT& baked = g_BakedScene.objects[i];
+		const COMPOSITE_PART& part = *baked.pPart;
+
+		SceneDescription::OBJECT object;
+		object.kind = (SceneDescription::OBJECT_KIND)part.kind;
+		object.mesh = part.mesh;
+		object.scale = glm::vec3(baked.scale[0], baked.scale[1], baked.scale[2]);
+		object.rotation = glm::vec3(part.rotation[0], part.rotation[1], part.rotation[2]);
+		object.position = glm::vec3(baked.position[0], baked.position[1], baked.position[2]);
+		object.color = glm::vec4(part.color[0], part.color[1], part.color[2], part.color[3]);
+		object.textureTag = part.textureTag;
+		object.materialTag = part.materialTag;
+		scene.AddObject(object);
+	}
+}
+
+/***********************************************************
+ *  SetTransforms()
+ *
+ *  This method is used for storing the baked transforms with
+ *  their finished model matrices, so the store does not
+ *  compose them again.
+ ***********************************************************/
+void BakedScene::SetTransforms(TransformStore& transforms)
+{
+	for (size_t i = 0; i < BAKED_OBJECT_COUNT; i++)
+	{
+		const BAKED_OBJECT& baked = g_BakedScene.objects[i];
+		const float* rotation = baked.pPart->rotation;
+
+		transforms.SetComposed((uint32_t)i,
+			glm::vec3(baked.scale[0], baked.scale[1], baked.scale[2]),
+			glm::vec3(rotation[0], rotation[1], rotation[2]),
+			glm::vec3(baked.position[0], baked.position[1], baked.position[2]),
+			baked.affine);
+	}
+}
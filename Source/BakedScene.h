@@ -0,0 +1,34 @@
+///////////////////////////////////////////////////////////////////////////////
+// bakedscene.h
+// ============
+// the default scene with its model matrices computed at compile time
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include "SceneDescription.h"
+#include "TransformStore.h"
+
+#include <cstddef>
+
+/***********************************************************
+ *  BakedScene
+ *
+ *  This class holds the composite shapes of the default
+ *  scene expanded into their parts, together with the model
+ *  matrix of every part, in a table that the compiler builds.
+ *  A scene prepared from it reads no scene file and does no
+ *  transform math, neither at startup nor while rendering,
+ *  until an object is moved.
+ ***********************************************************/
+class BakedScene
+{
+public:
+	// number of objects in the baked table
+	static size_t GetCount();
+	// add the baked objects to the end of the scene
+	static void AddToScene(SceneDescription& scene);
+	// store the baked transforms and model matrices as the first
+	// GetCount() objects of a store of at least that size
+	static void SetTransforms(TransformStore& transforms);
+};
@@ -0,0 +1,688 @@
+///////////////////////////////////////////////////////////////////////////////
+// benchmarkrunner.cpp
+// ============
+// render a fixed number of offscreen frames and report the frame timings
+///////////////////////////////////////////////////////////////////////////////
+
+#include "BenchmarkRunner.h"
+#include "FrameProfiler.h"
+#include "RenderStats.h"
+#include "PipelineStats.h"
+#include "CategoryTimer.h"
+#include "MemoryStats.h"
+#include "AllocationCounter.h"
+#include "Logger.h"
+
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <iostream>
+
+// declaration of global variables and helper functions
+namespace
+{
+	// number of frames the GPU timestamp queries are allowed to
+	// lag behind the CPU before their results are read back
+	const int QUERY_LATENCY = 4;
+	// GL call counters summarized in the report
+	const int RENDER_COUNTERS = 5;
+
+	typedef std::chrono::steady_clock Clock;
+
+	/***********************************************************
+	 *  ElapsedMs()
+	 *
+	 *  This function is used for getting the milliseconds that
+	 *  have passed between two clock readings.
+	 ***********************************************************/
+	double ElapsedMs(Clock::time_point start, Clock::time_point end)
+	{
+		return(std::chrono::duration<double, std::milli>(end - start).count());
+	}
+
+	/***********************************************************
+	 *  Percentile()
+	 *
+	 *  This function is used for getting the nearest-rank
+	 *  percentile from a sorted list of values.
+	 ***********************************************************/
+	double Percentile(const std::vector<double>& sorted, double percent)
+	{
+		if (sorted.empty())
+		{
+			return(0.0);
+		}
+
+		size_t rank = (size_t)(percent / 100.0 * sorted.size() + 0.5);
+		rank = std::max<size_t>(rank, 1);
+		rank = std::min(rank, sorted.size());
+		return(sorted[rank - 1]);
+	}
+
+	/***********************************************************
+	 *  WriteSummary()
+	 *
+	 *  This function is used for writing the mean, minimum,
+	 *  maximum and latency percentiles of one timing column.
+	 ***********************************************************/
+	void WriteSummary(std::ostream& out, const char* name, std::vector<double> values)
+	{
+		std::sort(values.begin(), values.end());
+
+		double total = 0.0;
+		for (size_t i = 0; i < values.size(); i++)
+		{
+			total += values[i];
+		}
+		double mean = values.empty() ? 0.0 : total / values.size();
+
+		out << "    \"" << name << "\": { "
+			<< "\"mean\": " << mean
+			<< ", \"min\": " << (values.empty() ? 0.0 : values.front())
+			<< ", \"max\": " << (values.empty() ? 0.0 : values.back())
+			<< ", \"p50\": " << Percentile(values, 50.0)
+			<< ", \"p95\": " << Percentile(values, 95.0)
+			<< ", \"p99\": " << Percentile(values, 99.0)
+			<< " }";
+	}
+
+	/***********************************************************
+	 *  WriteCounter()
+	 *
+	 *  This function is used for writing the per-frame mean and
+	 *  the maximum of one GL call counter.
+	 ***********************************************************/
+	void WriteCounter(std::ostream& out, const char* name, double total, uint64_t maximum, size_t frames)
+	{
+		out << "\"" << name << "\": { "
+			<< "\"mean\": " << ((frames > 0) ? total / frames : 0.0)
+			<< ", \"max\": " << maximum
+			<< " }";
+	}
+}
+
+/***********************************************************
+ *  BenchmarkRunner()
+ *
+ *  The constructor for the class
+ ***********************************************************/
+BenchmarkRunner::BenchmarkRunner(
+	ViewManager* pViewManager,
+	SceneManager* pSceneManager)
+{
+	m_pViewManager = pViewManager;
+	m_pSceneManager = pSceneManager;
+	m_pPlayer = NULL;
+	m_pRecorder = NULL;
+	m_warmupFrames = 0;
+}
+
+/***********************************************************
+ *  BenchmarkRunner()
+ *
+ *  The constructor for replaying a recorded draw stream
+ ***********************************************************/
+BenchmarkRunner::BenchmarkRunner(
+	DrawStreamPlayer* pPlayer)
+{
+	m_pViewManager = NULL;
+	m_pSceneManager = NULL;
+	m_pPlayer = pPlayer;
+	m_pRecorder = NULL;
+	m_warmupFrames = 0;
+}
+
+/***********************************************************
+ *  ~BenchmarkRunner()
+ *
+ *  The destructor for the class
+ ***********************************************************/
+BenchmarkRunner::~BenchmarkRunner()
+{
+	m_pViewManager = NULL;
+	m_pSceneManager = NULL;
+	m_pPlayer = NULL;
+	m_pRecorder = NULL;
+}
+
+/***********************************************************
+ *  RenderFrame()
+ *
+ *  This method is used for rendering one frame with the same
+ *  calls that the main display loop makes, or with the next
+ *  frame of the draw stream that is being replayed.
+ ***********************************************************/
+void BenchmarkRunner::RenderFrame()
+{
+	FrameProfiler::Instance().BeginFrame();
+	RenderStats::Instance().BeginFrame();
+	PipelineStats::Instance().BeginFrame();
+	CategoryTimer::Instance().BeginFrame();
+	{
+		PROFILE_ZONE("Frame");
+		{
+			PROFILE_ZONE("Clear");
+
+			// Enable z-depth
+			glEnable(GL_DEPTH_TEST);
+
+			// Clear the frame and z buffers
+			glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
+			glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+		}
+		if (NULL != m_pPlayer)
+		{
+			PROFILE_ZONE("ReplayFrame");
+
+			// re-issue the recorded uniforms and draws
+			m_pPlayer->ExecuteFrame();
+		}
+		else
+		{
+			if (NULL != m_pRecorder)
+			{
+				m_pRecorder->BeginFrame();
+			}
+			{
+				PROFILE_ZONE("PrepareSceneView");
+
+				// convert from 3D object space to 2D view
+				m_pViewManager->PrepareSceneView();
+				m_pSceneManager->SetView(m_pViewManager->GetViewProjection(), m_pViewManager->GetCameraPosition());
+			}
+			{
+				PROFILE_ZONE("RenderScene");
+
+				// refresh the 3D scene
+				m_pSceneManager->RenderScene();
+			}
+		}
+	}
+	CategoryTimer::Instance().EndFrame();
+	PipelineStats::Instance().EndFrame();
+	RenderStats::Instance().EndFrame();
+	FrameProfiler::Instance().EndFrame();
+}
+
+/***********************************************************
+ *  Run()
+ *
+ *  This method is used for rendering the warmup frames and
+ *  then the measured frames.  The GPU time of each frame is
+ *  taken from a pair of GL_TIMESTAMP queries that are read
+ *  back a few frames later so that the CPU never waits on
+ *  them, and glFinish() bounds each frame so that the total
+ *  frame time includes the GPU work.
+ ***********************************************************/
+bool BenchmarkRunner::Run(int frameCount, int warmupFrames)
+{
+	if ((NULL == m_pPlayer) && ((NULL == m_pViewManager) || (NULL == m_pSceneManager)))
+	{
+		return(false);
+	}
+
+	m_warmupFrames = warmupFrames;
+	m_timings.assign(frameCount, FRAME_TIMING());
+	// the warmup frames are cleared out of the history before the
+	// measured frames, so the larger of the two fits both
+	PipelineStats::Instance().ReserveHistory((size_t)std::max(frameCount, warmupFrames));
+
+	for (int i = 0; i < warmupFrames; i++)
+	{
+		RenderFrame();
+	}
+	glFinish();
+
+	// only the measured frames go into the pipeline statistics
+	PipelineStats::Instance().Flush();
+	PipelineStats::Instance().ClearHistory();
+	CategoryTimer::Instance().ResetTotals();
+
+	GLuint queries[QUERY_LATENCY][2];
+	glGenQueries(QUERY_LATENCY * 2, &queries[0][0]);
+
+	for (int frame = 0; frame < frameCount + QUERY_LATENCY; frame++)
+	{
+		int slot = frame % QUERY_LATENCY;
+
+		// read back the timestamps that were issued in this slot
+		// before the slot is reused
+		if (frame >= QUERY_LATENCY)
+		{
+			GLuint64 beginTime = 0;
+			GLuint64 endTime = 0;
+			glGetQueryObjectui64v(queries[slot][0], GL_QUERY_RESULT, &beginTime);
+			glGetQueryObjectui64v(queries[slot][1], GL_QUERY_RESULT, &endTime);
+			m_timings[frame - QUERY_LATENCY].gpuMs = (endTime - beginTime) / 1000000.0;
+		}
+
+		if (frame >= frameCount)
+		{
+			continue;
+		}
+
+		Clock::time_point frameStart = Clock::now();
+		glQueryCounter(queries[slot][0], GL_TIMESTAMP);
+
+		RenderFrame();
+
+		glQueryCounter(queries[slot][1], GL_TIMESTAMP);
+		Clock::time_point submitEnd = Clock::now();
+
+		glFinish();
+		Clock::time_point frameEnd = Clock::now();
+
+		m_timings[frame].stats = RenderStats::Instance().GetLastFrameStats();
+		m_timings[frame].cpuMs = ElapsedMs(frameStart, submitEnd);
+		m_timings[frame].frameMs = ElapsedMs(frameStart, frameEnd);
+	}
+
+	glDeleteQueries(QUERY_LATENCY * 2, &queries[0][0]);
+	PipelineStats::Instance().Flush();
+	CategoryTimer::Instance().Flush();
+
+	return(true);
+}
+
+/***********************************************************
+ *  CountFrameAllocations()
+ *
+ *  This method is used for checking that rendering a frame
+ *  does not touch the heap once the scene has settled.  The
+ *  warmup frames fill the caches that are built on first use,
+ *  such as the uniform locations, so there is always at least
+ *  one, and every allocation made on this thread or on the
+ *  worker pool threads during the frames after them is
+ *  counted.
+ ***********************************************************/
+uint64_t BenchmarkRunner::CountFrameAllocations(int frameCount, int warmupFrames)
+{
+	// at least one frame has to fill the caches
+	for (int i = 0; i < std::max(warmupFrames, 1); i++)
+	{
+		RenderFrame();
+	}
+	glFinish();
+
+	AllocationCounter::Reset();
+	AllocationCounter::Start();
+	for (int frame = 0; frame < frameCount; frame++)
+	{
+		RenderFrame();
+	}
+	AllocationCounter::Stop();
+	glFinish();
+
+	return(AllocationCounter::GetCount());
+}
+
+/***********************************************************
+ *  CheckObjectEdits()
+ *
+ *  This method is used for checking the object handles and
+ *  the object buffer uploads while objects come and go.  It
+ *  adds the objects, removes every other one, adds as many
+ *  again, which have to take the freed slots, and checks that
+ *  the old handles no longer work.  An idle frame then has to
+ *  upload nothing and moving one object has to upload only
+ *  the block of slots it is in.  Every failed check is logged.
+ ***********************************************************/
+bool BenchmarkRunner::CheckObjectEdits(int objectCount, int warmupFrames)
+{
+	bool bReturn = true;
+
+	// at least one frame has to create the object buffer
+	for (int i = 0; i < std::max(warmupFrames, 1); i++)
+	{
+		RenderFrame();
+	}
+
+	SceneDescription::OBJECT object;
+	object.kind = SceneDescription::KIND_PYRAMID_TREE;
+	object.mesh = SceneManager::MESH_PYRAMID3;
+	object.scale = glm::vec3(1.0f, 2.0f, 1.0f);
+	object.rotation = glm::vec3(0.0f);
+	object.color = glm::vec4(0.2f, 0.6f, 0.2f, 1.0f);
+
+	std::vector<SceneManager::OBJECT_HANDLE> handles(objectCount);
+	for (int i = 0; i < objectCount; i++)
+	{
+		object.position = glm::vec3((float)(i % 32) * 2.0f, 1.0f, (float)(i / 32) * 2.0f);
+		handles[i] = m_pSceneManager->AddObject(object);
+		if (m_pSceneManager->IsObjectAlive(handles[i]) == false)
+		{
+			LOG_ERROR("Added object %d is not alive", i);
+			return(false);
+		}
+	}
+	RenderFrame();
+
+	// remove every other object and keep its handle
+	std::vector<SceneManager::OBJECT_HANDLE> removed;
+	std::vector<uint32_t> freedSlots;
+	for (int i = 0; i < objectCount; i += 2)
+	{
+		if (m_pSceneManager->RemoveObject(handles[i]) == false)
+		{
+			LOG_ERROR("Object %d could not be removed", i);
+			bReturn = false;
+		}
+		if (m_pSceneManager->RemoveObject(handles[i]) == true)
+		{
+			LOG_ERROR("Object %d was removed twice", i);
+			bReturn = false;
+		}
+		removed.push_back(handles[i]);
+		freedSlots.push_back(handles[i].slot);
+	}
+	std::sort(freedSlots.begin(), freedSlots.end());
+	RenderFrame();
+
+	// the new objects take the freed slots
+	for (size_t i = 0; i < removed.size(); i++)
+	{
+		object.position = glm::vec3((float)i * 2.0f, 1.0f, -4.0f);
+		handles[i * 2] = m_pSceneManager->AddObject(object);
+		if (std::binary_search(freedSlots.begin(), freedSlots.end(), handles[i * 2].slot) == false)
+		{
+			LOG_ERROR("Re-added object %llu took slot %u, which was not freed",
+				(unsigned long long)i, handles[i * 2].slot);
+			bReturn = false;
+		}
+	}
+
+	// the old handles name slots that are in use again
+	for (size_t i = 0; i < removed.size(); i++)
+	{
+		if (m_pSceneManager->IsObjectAlive(removed[i]) == true)
+		{
+			LOG_ERROR("Removed object in slot %u is still alive", removed[i].slot);
+			bReturn = false;
+		}
+		if (m_pSceneManager->MoveObject(removed[i], object.scale, object.rotation, object.position) == true)
+		{
+			LOG_ERROR("Removed object in slot %u was moved", removed[i].slot);
+			bReturn = false;
+		}
+	}
+
+	// the first frame copies the re-added objects, the second
+	// has nothing to copy
+	RenderFrame();
+	RenderFrame();
+	uint64_t idleBytes = m_pSceneManager->GetLastObjectUploadBytes();
+	if (idleBytes != 0)
+	{
+		LOG_ERROR("A frame without edits uploaded %llu bytes", (unsigned long long)idleBytes);
+		bReturn = false;
+	}
+
+	const uint64_t blockBytes = SceneWorld::CHANGED_BLOCK_SLOTS * sizeof(TransformStore::AFFINE_3X4);
+	if (objectCount > 1)
+	{
+		object.position = glm::vec3(-8.0f, 1.0f, -8.0f);
+		if (m_pSceneManager->MoveObject(handles[1], object.scale, object.rotation, object.position) == false)
+		{
+			LOG_ERROR("Live object in slot %u could not be moved", handles[1].slot);
+			bReturn = false;
+		}
+		RenderFrame();
+		uint64_t moveBytes = m_pSceneManager->GetLastObjectUploadBytes();
+		if ((moveBytes == 0) || (moveBytes > blockBytes))
+		{
+			LOG_ERROR("Moving one object uploaded %llu bytes, expected 1 to %llu",
+				(unsigned long long)moveBytes, (unsigned long long)blockBytes);
+			bReturn = false;
+		}
+	}
+	glFinish();
+
+	return(bReturn);
+}
+
+/***********************************************************
+ *  WriteReport()
+ *
+ *  This method is used for writing the JSON benchmark report
+ *  to the passed in file path, or to stdout if the path is
+ *  a single dash.
+ ***********************************************************/
+bool BenchmarkRunner::WriteReport(const std::string& reportPath) const
+{
+	if (reportPath == "-")
+	{
+		WriteReportJSON(std::cout);
+		return(true);
+	}
+
+	std::ofstream file(reportPath.c_str());
+	if (!file.is_open())
+	{
+		std::cerr << "Could not open benchmark report file:" << reportPath << std::endl;
+		return(false);
+	}
+
+	WriteReportJSON(file);
+	return(file.good());
+}
+
+/***********************************************************
+ *  WriteReportJSON()
+ *
+ *  This method is used for writing the timing summaries and
+ *  the per-frame timings as a JSON document.
+ ***********************************************************/
+void BenchmarkRunner::WriteReportJSON(std::ostream& out) const
+{
+	std::vector<double> cpuMs;
+	std::vector<double> gpuMs;
+	std::vector<double> frameMs;
+	for (size_t i = 0; i < m_timings.size(); i++)
+	{
+		cpuMs.push_back(m_timings[i].cpuMs);
+		gpuMs.push_back(m_timings[i].gpuMs);
+		frameMs.push_back(m_timings[i].frameMs);
+	}
+
+	const GLubyte* renderer = glGetString(GL_RENDERER);
+	const GLubyte* version = glGetString(GL_VERSION);
+
+	out << "{\n";
+	out << "  \"renderer\": \"" << (renderer ? (const char*)renderer : "") << "\",\n";
+	out << "  \"gl_version\": \"" << (version ? (const char*)version : "") << "\",\n";
+	out << "  \"frames\": " << m_timings.size() << ",\n";
+	out << "  \"warmup_frames\": " << m_warmupFrames << ",\n";
+	out << "  \"summary\": {\n";
+	WriteSummary(out, "cpu_ms", cpuMs);
+	out << ",\n";
+	WriteSummary(out, "gpu_ms", gpuMs);
+	out << ",\n";
+	WriteSummary(out, "frame_ms", frameMs);
+	out << "\n  },\n";
+
+	// culling, a camera path and streaming change the counters
+	// from frame to frame, so they are summed over the measured
+	// frames
+	double totals[RENDER_COUNTERS] = { 0.0, 0.0, 0.0, 0.0, 0.0 };
+	uint64_t maxima[RENDER_COUNTERS] = { 0, 0, 0, 0, 0 };
+	for (size_t i = 0; i < m_timings.size(); i++)
+	{
+		const RenderStats::FRAME_STATS& stats = m_timings[i].stats;
+		uint64_t values[RENDER_COUNTERS] = { stats.drawCalls, stats.uniformUploads, stats.redundantUniformUploads,
+			stats.samplerUpdates, stats.trianglesSubmitted };
+		for (int counter = 0; counter < RENDER_COUNTERS; counter++)
+		{
+			totals[counter] += (double)values[counter];
+			maxima[counter] = std::max(maxima[counter], values[counter]);
+		}
+	}
+	out << "  \"render_stats\": { ";
+	WriteCounter(out, "draw_calls", totals[0], maxima[0], m_timings.size());
+	out << ", ";
+	WriteCounter(out, "uniform_uploads", totals[1], maxima[1], m_timings.size());
+	out << ", ";
+	WriteCounter(out, "redundant_uniform_uploads", totals[2], maxima[2], m_timings.size());
+	out << ", ";
+	WriteCounter(out, "sampler_updates", totals[3], maxima[3], m_timings.size());
+	out << ", ";
+	WriteCounter(out, "triangles", totals[4], maxima[4], m_timings.size());
+	// a static scene rebuilds and uploads no model matrices after
+	// its first frame
+	if (NULL != m_pSceneManager)
+	{
+		out << ", \"model_matrix_updates\": " << m_pSceneManager->GetLastMatrixUpdates()
+			<< ", \"object_buffer_upload_bytes\": " << m_pSceneManager->GetLastObjectUploadBytes();
+
+		// the cells resident at the end depend on where the camera
+		// stopped
+		const SceneStreamer& streamer = m_pSceneManager->GetStreamer();
+		if (streamer.IsRunning() == true)
+		{
+			out << ", \"stream_cells\": " << streamer.GetCellCount()
+				<< ", \"resident_cells\": " << streamer.GetResidentCells()
+				<< ", \"resident_objects\": " << streamer.GetResidentObjects()
+				<< ", \"resident_bytes\": " << streamer.GetResidentBytes()
+				<< ", \"pending_cell_loads\": " << streamer.GetPendingLoads()
+				<< ", \"cell_loads\": " << streamer.GetLoadCount()
+				<< ", \"cell_unloads\": " << streamer.GetUnloadCount();
+		}
+	}
+	out << " },\n";
+
+	// streamed cells come and go while frames are measured, so
+	// this is the memory held after the last frame
+	out << "  \"memory\": ";
+	MemoryStats::Instance().WriteJSON(out, "  ");
+	out << ",\n";
+
+	// the pipeline statistics history holds one entry for every
+	// measured frame when they are enabled
+	const std::vector<PipelineStats::FRAME_RESULT>& pipeline = PipelineStats::Instance().GetHistory();
+	bool bPipelineStats = PipelineStats::Instance().IsEnabled() && (pipeline.size() == m_timings.size());
+	if (bPipelineStats)
+	{
+		WritePipelineStatsJSON(out);
+	}
+	if (CategoryTimer::Instance().IsEnabled())
+	{
+		WriteCategoryTimesJSON(out);
+	}
+
+	out << "  \"per_frame\": [\n";
+	for (size_t i = 0; i < m_timings.size(); i++)
+	{
+		out << "    { \"cpu_ms\": " << m_timings[i].cpuMs
+			<< ", \"gpu_ms\": " << m_timings[i].gpuMs
+			<< ", \"frame_ms\": " << m_timings[i].frameMs
+			<< ", \"draw_calls\": " << m_timings[i].stats.drawCalls
+			<< ", \"triangles\": " << m_timings[i].stats.trianglesSubmitted;
+		if (bPipelineStats)
+		{
+			// totals of all groups for the frame
+			for (int stat = 0; stat < PipelineStats::STAT_COUNT; stat++)
+			{
+				uint64_t total = 0;
+				for (int group = 0; group < PipelineStats::GROUP_COUNT; group++)
+				{
+					total += pipeline[i].values[group][stat];
+				}
+				out << ", \"" << PipelineStats::GetStatisticName(stat) << "\": " << total;
+			}
+		}
+		out << " }" << ((i + 1 < m_timings.size()) ? ",\n" : "\n");
+	}
+	out << "  ]\n";
+	out << "}" << std::endl;
+}
+
+/***********************************************************
+ *  WritePipelineStatsJSON()
+ *
+ *  This method is used for writing the per-frame mean of
+ *  every pipeline statistic, for the whole scene pass and
+ *  for each object group.
+ ***********************************************************/
+void BenchmarkRunner::WritePipelineStatsJSON(std::ostream& out) const
+{
+	const std::vector<PipelineStats::FRAME_RESULT>& pipeline = PipelineStats::Instance().GetHistory();
+
+	double means[PipelineStats::GROUP_COUNT][PipelineStats::STAT_COUNT] = {};
+	for (size_t i = 0; i < pipeline.size(); i++)
+	{
+		for (int group = 0; group < PipelineStats::GROUP_COUNT; group++)
+		{
+			for (int stat = 0; stat < PipelineStats::STAT_COUNT; stat++)
+			{
+				means[group][stat] += (double)pipeline[i].values[group][stat] / pipeline.size();
+			}
+		}
+	}
+
+	out << "  \"pipeline_statistics\": {\n";
+	out << "    \"scene\": { ";
+	for (int stat = 0; stat < PipelineStats::STAT_COUNT; stat++)
+	{
+		double total = 0.0;
+		for (int group = 0; group < PipelineStats::GROUP_COUNT; group++)
+		{
+			total += means[group][stat];
+		}
+		out << ((stat > 0) ? ", " : "") << "\"" << PipelineStats::GetStatisticName(stat) << "\": " << total;
+	}
+	out << " },\n";
+	out << "    \"groups\": {\n";
+	for (int group = 0; group < PipelineStats::GROUP_COUNT; group++)
+	{
+		out << "      \"" << PipelineStats::GetGroupName(group) << "\": { ";
+		for (int stat = 0; stat < PipelineStats::STAT_COUNT; stat++)
+		{
+			out << ((stat > 0) ? ", " : "") << "\"" << PipelineStats::GetStatisticName(stat) << "\": " << means[group][stat];
+		}
+		out << " }" << ((group + 1 < PipelineStats::GROUP_COUNT) ? ",\n" : "\n");
+	}
+	out << "    }\n";
+	out << "  },\n";
+}
+
+/***********************************************************
+ *  WriteCategoryTimesJSON()
+ *
+ *  This method is used for writing the GPU time of each
+ *  object category over the measured frames, ranked from the
+ *  most to the least expensive category.
+ ***********************************************************/
+void BenchmarkRunner::WriteCategoryTimesJSON(std::ostream& out) const
+{
+	const CategoryTimer& timer = CategoryTimer::Instance();
+
+	int ranking[CategoryTimer::CATEGORY_COUNT];
+	uint64_t totalNs = 0;
+	for (int i = 0; i < CategoryTimer::CATEGORY_COUNT; i++)
+	{
+		ranking[i] = i;
+		totalNs += timer.GetTotal(i).gpuNs;
+	}
+	std::sort(ranking, ranking + CategoryTimer::CATEGORY_COUNT,
+		[&timer](int a, int b) { return(timer.GetTotal(a).gpuNs > timer.GetTotal(b).gpuNs); });
+
+	double frames = (timer.GetResolvedFrames() > 0) ? (double)timer.GetResolvedFrames() : 1.0;
+
+	out << "  \"gpu_categories\": [\n";
+	for (int i = 0; i < CategoryTimer::CATEGORY_COUNT; i++)
+	{
+		const CategoryTimer::CATEGORY_TOTAL& total = timer.GetTotal(ranking[i]);
+		double runs = (total.runs > 0) ? (double)total.runs : 1.0;
+		double objects = (total.objects > 0) ? (double)total.objects : 1.0;
+
+		out << "    { \"category\": \"" << CategoryTimer::GetCategoryName(ranking[i]) << "\""
+			<< ", \"total_ms\": " << total.gpuNs / 1000000.0
+			<< ", \"ms_per_frame\": " << total.gpuNs / 1000000.0 / frames
+			<< ", \"runs\": " << total.runs
+			<< ", \"us_per_run\": " << total.gpuNs / 1000.0 / runs
+			<< ", \"objects\": " << total.objects
+			<< ", \"us_per_object\": " << total.gpuNs / 1000.0 / objects
+			<< ", \"share\": " << ((totalNs > 0) ? (double)total.gpuNs / totalNs : 0.0) << " }"
+			<< ((i + 1 < CategoryTimer::CATEGORY_COUNT) ? ",\n" : "\n");
+	}
+	out << "  ],\n";
+}
@@ -0,0 +1,88 @@
+///////////////////////////////////////////////////////////////////////////////
+// benchmarkrunner.h
+// ============
+// render a fixed number of offscreen frames and report the frame timings
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include "SceneManager.h"
+#include "ViewManager.h"
+#include "DrawStream.h"
+#include "RenderStats.h"
+
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <vector>
+
+/***********************************************************
+ *  BenchmarkRunner
+ *
+ *  This class drives the same per-frame calls as the main
+ *  display loop against an offscreen context and records the
+ *  CPU submission time, the GPU time, the total frame time
+ *  and the GL call counters for every measured frame.  It can also replay a recorded
+ *  draw stream instead of running the scene code.
+ ***********************************************************/
+class BenchmarkRunner
+{
+public:
+	// constructor
+	BenchmarkRunner(
+		ViewManager* pViewManager,
+		SceneManager* pSceneManager);
+	// constructor for replaying a recorded draw stream
+	BenchmarkRunner(
+		DrawStreamPlayer* pPlayer);
+	// destructor
+	~BenchmarkRunner();
+
+	struct FRAME_TIMING
+	{
+		double cpuMs;
+		double gpuMs;
+		double frameMs;
+		// GL work counted for the frame - the triangle count
+		// trails by a few frames
+		RenderStats::FRAME_STATS stats;
+	};
+
+	// render the warmup frames followed by the measured frames
+	bool Run(int frameCount, int warmupFrames);
+	// render the warmup frames, then count the heap allocations
+	// made while rendering the passed in number of frames
+	uint64_t CountFrameAllocations(int frameCount, int warmupFrames);
+	// render the warmup frames, then add, remove, re-add and move
+	// objects and check their handles and the object buffer
+	// uploads - false when any check fails
+	bool CheckObjectEdits(int objectCount, int warmupFrames);
+	// write the JSON report to a file, or stdout for "-"
+	bool WriteReport(const std::string& reportPath) const;
+
+	// mark the start of every rendered frame in the recorder
+	void SetDrawStreamRecorder(DrawStreamRecorder* pRecorder) { m_pRecorder = pRecorder; }
+
+private:
+	// pointer to view manager object
+	ViewManager* m_pViewManager;
+	// pointer to scene manager object
+	SceneManager* m_pSceneManager;
+	// recorded draw stream that replaces the scene code
+	DrawStreamPlayer* m_pPlayer;
+	// optional recorder of the rendered frames
+	DrawStreamRecorder* m_pRecorder;
+	// number of frames rendered before measuring
+	int m_warmupFrames;
+	// timings of the measured frames
+	std::vector<FRAME_TIMING> m_timings;
+
+	// render a single frame exactly like the main display loop
+	void RenderFrame();
+	// write the JSON report into the passed in stream
+	void WriteReportJSON(std::ostream& out) const;
+	// write the mean pipeline statistics of the measured frames
+	void WritePipelineStatsJSON(std::ostream& out) const;
+	// write the GPU time of each object category, most expensive first
+	void WriteCategoryTimesJSON(std::ostream& out) const;
+};
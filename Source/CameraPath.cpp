@@ -0,0 +1,172 @@
+///////////////////////////////////////////////////////////////////////////////
+// camerapath.cpp
+// ============
+// keyframed camera paths that are played back with a fixed time step
+///////////////////////////////////////////////////////////////////////////////
+
+#include "CameraPath.h"
+#include "Logger.h"
+
+#include <cmath>
+#include <fstream>
+#include <sstream>
+
+// declaration of the helper functions
+namespace
+{
+	/***********************************************************
+	 *  CatmullRom()
+	 *
+	 *  This function is used for interpolating between p1 and
+	 *  p2 with the uniform Catmull-Rom spline, where p0 and p3
+	 *  are the neighbouring keyframe values.
+	 ***********************************************************/
+	template <typename T>
+	T CatmullRom(const T& p0, const T& p1, const T& p2, const T& p3, float t)
+	{
+		float t2 = t * t;
+		float t3 = t2 * t;
+
+		return(0.5f * ((2.0f * p1) +
+			(p2 - p0) * t +
+			(2.0f * p0 - 5.0f * p1 + 4.0f * p2 - p3) * t2 +
+			(3.0f * p1 - p0 - 3.0f * p2 + p3) * t3));
+	}
+}
+
+/***********************************************************
+ *  Load()
+ *
+ *  This method is used for reading the keyframes of a path
+ *  file.  The file is rejected if a line cannot be parsed or
+ *  the keyframe times do not increase.
+ ***********************************************************/
+bool CameraPath::Load(const std::string& filename)
+{
+	std::ifstream file(filename.c_str());
+	if (!file.is_open())
+	{
+		LOG_ERROR("Could not open camera path:%s", filename.c_str());
+		return(false);
+	}
+
+	m_keyframes.clear();
+
+	std::string line;
+	int lineNumber = 0;
+	while (std::getline(file, line))
+	{
+		lineNumber++;
+
+		std::istringstream fields(line);
+		std::string keyword;
+		if (!(fields >> keyword) || (keyword[0] == '#'))
+		{
+			continue;
+		}
+
+		KEYFRAME key;
+		if ((keyword != "key") ||
+			!(fields >> key.time
+				>> key.position.x >> key.position.y >> key.position.z
+				>> key.front.x >> key.front.y >> key.front.z
+				>> key.zoom))
+		{
+			LOG_ERROR("Bad camera path line %d:%s", lineNumber, filename.c_str());
+			return(false);
+		}
+
+		if (!m_keyframes.empty() && (key.time <= m_keyframes.back().time))
+		{
+			LOG_ERROR("Camera path times must increase, line %d:%s", lineNumber, filename.c_str());
+			return(false);
+		}
+
+		key.front = glm::normalize(key.front);
+		m_keyframes.push_back(key);
+	}
+
+	if (m_keyframes.empty())
+	{
+		LOG_ERROR("Camera path has no keyframes:%s", filename.c_str());
+		return(false);
+	}
+
+	return(true);
+}
+
+/***********************************************************
+ *  GetDuration()
+ *
+ *  This method is used for getting the time of the last
+ *  keyframe.
+ ***********************************************************/
+float CameraPath::GetDuration() const
+{
+	if (m_keyframes.empty())
+	{
+		return(0.0f);
+	}
+	return(m_keyframes.back().time);
+}
+
+/***********************************************************
+ *  Sample()
+ *
+ *  This method is used for getting the camera at the passed
+ *  in time.  The keyframes at either end of the path are
+ *  repeated as the outer spline control points, so the path
+ *  starts and ends on its first and last keyframes.
+ ***********************************************************/
+CameraPath::KEYFRAME CameraPath::Sample(float time) const
+{
+	KEYFRAME result = { time, glm::vec3(0.0f), glm::vec3(0.0f, 0.0f, -1.0f), 45.0f };
+
+	if (m_keyframes.empty())
+	{
+		return(result);
+	}
+	if (m_keyframes.size() == 1)
+	{
+		result = m_keyframes[0];
+		result.time = time;
+		return(result);
+	}
+
+	// wrap the time into the path, before the first keyframe
+	// the camera holds still on it
+	float duration = GetDuration();
+	if (time > duration)
+	{
+		time = fmodf(time, duration);
+	}
+	if (time <= m_keyframes[0].time)
+	{
+		result = m_keyframes[0];
+		result.time = time;
+		return(result);
+	}
+
+	// find the segment that holds the time
+	size_t segment = 0;
+	while ((segment + 2 < m_keyframes.size()) && (time > m_keyframes[segment + 1].time))
+	{
+		segment++;
+	}
+
+	size_t last = m_keyframes.size() - 1;
+	const KEYFRAME& k0 = m_keyframes[(segment > 0) ? segment - 1 : 0];
+	const KEYFRAME& k1 = m_keyframes[segment];
+	const KEYFRAME& k2 = m_keyframes[segment + 1];
+	const KEYFRAME& k3 = m_keyframes[(segment + 2 <= last) ? segment + 2 : last];
+
+	float t = (time - k1.time) / (k2.time - k1.time);
+	t = (t < 0.0f) ? 0.0f : ((t > 1.0f) ? 1.0f : t);
+
+	result.time = time;
+	result.position = CatmullRom(k0.position, k1.position, k2.position, k3.position, t);
+	result.front = glm::normalize(CatmullRom(k0.front, k1.front, k2.front, k3.front, t));
+	result.zoom = CatmullRom(k0.zoom, k1.zoom, k2.zoom, k3.zoom, t);
+
+	return(result);
+}
@@ -0,0 +1,49 @@
+///////////////////////////////////////////////////////////////////////////////
+// camerapath.h
+// ============
+// keyframed camera paths that are played back with a fixed time step
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <glm/glm.hpp>
+
+#include <string>
+#include <vector>
+
+/***********************************************************
+ *  CameraPath
+ *
+ *  This class holds a list of camera keyframes and samples
+ *  a Catmull-Rom spline through them.  A path file is plain
+ *  text with one keyframe per line:
+ *
+ *    key <time> <px> <py> <pz> <fx> <fy> <fz> <zoom>
+ *
+ *  where time is in seconds, p is the camera position, f is
+ *  the front direction and zoom is the vertical field of view
+ *  in degrees.  Blank lines and lines starting with '#' are
+ *  ignored, and the keyframe times must increase.
+ ***********************************************************/
+class CameraPath
+{
+public:
+	struct KEYFRAME
+	{
+		float time;
+		glm::vec3 position;
+		glm::vec3 front;
+		float zoom;
+	};
+
+	// load the keyframes from a path file
+	bool Load(const std::string& filename);
+	// sample the path at the passed in time - the path loops, so
+	// times past the last keyframe wrap around to the start
+	KEYFRAME Sample(float time) const;
+	// time of the last keyframe
+	float GetDuration() const;
+
+private:
+	std::vector<KEYFRAME> m_keyframes;
+};
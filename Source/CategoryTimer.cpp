@@ -0,0 +1,273 @@
+///////////////////////////////////////////////////////////////////////////////
+// categorytimer.cpp
+// ============
+// measure the GPU time spent drawing each category of scene object
+///////////////////////////////////////////////////////////////////////////////
+
+#include "CategoryTimer.h"
+
+#include <cstring>
+
+// declaration of global variables
+namespace
+{
+	const char* g_CategoryNames[CategoryTimer::CATEGORY_COUNT] =
+	{
+		"planes",
+		"pyramid_trees",
+		"spherical_trees",
+		"mountains",
+		"clouds"
+	};
+}
+
+/***********************************************************
+ *  Instance()
+ *
+ *  This method is used for getting the single timer that
+ *  all of the categories are timed into.
+ ***********************************************************/
+CategoryTimer& CategoryTimer::Instance()
+{
+	static CategoryTimer timer;
+	return(timer);
+}
+
+/***********************************************************
+ *  CategoryTimer()
+ *
+ *  The constructor for the class
+ ***********************************************************/
+CategoryTimer::CategoryTimer()
+{
+	m_bEnabled = false;
+	m_frameNumber = 0;
+	m_resolvedFrames = 0;
+	memset(m_frames, 0, sizeof(m_frames));
+	memset(m_totals, 0, sizeof(m_totals));
+}
+
+/***********************************************************
+ *  Enable()
+ *
+ *  This method is used for creating the query pool of every
+ *  in-flight frame.
+ ***********************************************************/
+void CategoryTimer::Enable()
+{
+	if (m_bEnabled)
+	{
+		return;
+	}
+
+	for (int i = 0; i < QUERY_LATENCY; i++)
+	{
+		m_frames[i].bPending = false;
+		m_frames[i].scopeCount = 0;
+		glGenQueries(MAX_SCOPES_PER_FRAME * 2, &m_frames[i].queries[0][0]);
+	}
+
+	m_frameNumber = 0;
+	ResetTotals();
+	m_bEnabled = true;
+}
+
+/***********************************************************
+ *  Disable()
+ *
+ *  This method is used for freeing the query pool.
+ ***********************************************************/
+void CategoryTimer::Disable()
+{
+	if (!m_bEnabled)
+	{
+		return;
+	}
+
+	for (int i = 0; i < QUERY_LATENCY; i++)
+	{
+		glDeleteQueries(MAX_SCOPES_PER_FRAME * 2, &m_frames[i].queries[0][0]);
+	}
+	m_bEnabled = false;
+}
+
+/***********************************************************
+ *  BeginFrame()
+ *
+ *  This method is used for reading back the frame that last
+ *  used this frame's queries and starting a new frame.
+ ***********************************************************/
+void CategoryTimer::BeginFrame()
+{
+	if (!m_bEnabled)
+	{
+		return;
+	}
+
+	FRAME_QUERIES& frame = m_frames[m_frameNumber % QUERY_LATENCY];
+	if (frame.bPending)
+	{
+		ResolveFrame(frame);
+	}
+	frame.scopeCount = 0;
+}
+
+/***********************************************************
+ *  EndFrame()
+ *
+ *  This method is used for leaving the results of the frame
+ *  to be read back later.
+ ***********************************************************/
+void CategoryTimer::EndFrame()
+{
+	if (!m_bEnabled)
+	{
+		return;
+	}
+
+	m_frames[m_frameNumber % QUERY_LATENCY].bPending = true;
+	m_frameNumber++;
+}
+
+/***********************************************************
+ *  BeginScope()
+ *
+ *  This method is used for starting to time a run of
+ *  objects.  The returned index is passed to EndScope(),
+ *  and is -1 when the timer is off or the pool is used up.
+ ***********************************************************/
+int CategoryTimer::BeginScope(CATEGORY category)
+{
+	if (!m_bEnabled)
+	{
+		return(-1);
+	}
+
+	FRAME_QUERIES& frame = m_frames[m_frameNumber % QUERY_LATENCY];
+	if (frame.scopeCount == MAX_SCOPES_PER_FRAME)
+	{
+		return(-1);
+	}
+
+	int scope = frame.scopeCount;
+	frame.categories[scope] = category;
+	frame.objects[scope] = 0;
+	glQueryCounter(frame.queries[scope][0], GL_TIMESTAMP);
+	frame.scopeCount++;
+
+	return(scope);
+}
+
+/***********************************************************
+ *  EndScope()
+ *
+ *  This method is used for finishing the timing of a run of
+ *  objects.
+ ***********************************************************/
+void CategoryTimer::EndScope(int scopeIndex)
+{
+	if (!m_bEnabled || (scopeIndex < 0))
+	{
+		return;
+	}
+
+	FRAME_QUERIES& frame = m_frames[m_frameNumber % QUERY_LATENCY];
+	glQueryCounter(frame.queries[scopeIndex][1], GL_TIMESTAMP);
+}
+
+/***********************************************************
+ *  CountObject()
+ *
+ *  This method is used for counting one object drawn in the
+ *  timed run.
+ ***********************************************************/
+void CategoryTimer::CountObject(int scopeIndex)
+{
+	if (!m_bEnabled || (scopeIndex < 0))
+	{
+		return;
+	}
+
+	m_frames[m_frameNumber % QUERY_LATENCY].objects[scopeIndex]++;
+}
+
+/***********************************************************
+ *  Flush()
+ *
+ *  This method is used for waiting on the results of every
+ *  pending frame so that the totals cover all of the frames
+ *  that were rendered.
+ ***********************************************************/
+void CategoryTimer::Flush()
+{
+	if (!m_bEnabled)
+	{
+		return;
+	}
+
+	for (uint64_t i = 0; i < QUERY_LATENCY; i++)
+	{
+		FRAME_QUERIES& frame = m_frames[(m_frameNumber + i) % QUERY_LATENCY];
+		if (frame.bPending)
+		{
+			ResolveFrame(frame);
+		}
+	}
+}
+
+/***********************************************************
+ *  ResetTotals()
+ *
+ *  This method is used for clearing the totals.  Frames that
+ *  are still pending are dropped too, so that the totals
+ *  only hold frames rendered after the reset.
+ ***********************************************************/
+void CategoryTimer::ResetTotals()
+{
+	for (int i = 0; i < QUERY_LATENCY; i++)
+	{
+		m_frames[i].bPending = false;
+	}
+	memset(m_totals, 0, sizeof(m_totals));
+	m_resolvedFrames = 0;
+}
+
+/***********************************************************
+ *  ResolveFrame()
+ *
+ *  This method is used for adding the GPU time and objects
+ *  of every timed run of a frame into its category total.
+ ***********************************************************/
+void CategoryTimer::ResolveFrame(FRAME_QUERIES& frame)
+{
+	for (int scope = 0; scope < frame.scopeCount; scope++)
+	{
+		GLuint64 beginTime = 0;
+		GLuint64 endTime = 0;
+		glGetQueryObjectui64v(frame.queries[scope][0], GL_QUERY_RESULT, &beginTime);
+		glGetQueryObjectui64v(frame.queries[scope][1], GL_QUERY_RESULT, &endTime);
+
+		CATEGORY_TOTAL& total = m_totals[frame.categories[scope]];
+		total.gpuNs += (endTime > beginTime) ? (endTime - beginTime) : 0;
+		total.runs++;
+		total.objects += frame.objects[scope];
+	}
+
+	m_resolvedFrames++;
+	frame.bPending = false;
+}
+
+/***********************************************************
+ *  GetCategoryName()
+ *
+ *  This method is used for getting the report name of a
+ *  category.
+ ***********************************************************/
+const char* CategoryTimer::GetCategoryName(int category)
+{
+	if ((category < 0) || (category >= CATEGORY_COUNT))
+	{
+		return("");
+	}
+	return(g_CategoryNames[category]);
+}
@@ -0,0 +1,132 @@
+///////////////////////////////////////////////////////////////////////////////
+// categorytimer.h
+// ============
+// measure the GPU time spent drawing each category of scene object
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <GL/glew.h>
+
+#include <cstdint>
+
+/***********************************************************
+ *  CategoryTimer
+ *
+ *  This class wraps every run of scene objects of the same
+ *  category, which are drawn one after the other, in a pair
+ *  of GL_TIMESTAMP queries and adds the measured GPU time up
+ *  by object category.  The objects drawn in each run are
+ *  counted too, for the cost of one object.  The queries are
+ *  taken from a pool that is reused every few frames, so the
+ *  results are read back long after the GPU has finished
+ *  with them.  While the timer is not enabled every call
+ *  returns immediately.
+ ***********************************************************/
+class CategoryTimer
+{
+public:
+	enum CATEGORY
+	{
+		CATEGORY_PLANES = 0,
+		CATEGORY_PYRAMID_TREES,
+		CATEGORY_SPHERICAL_TREES,
+		CATEGORY_MOUNTAINS,
+		CATEGORY_CLOUDS,
+		CATEGORY_COUNT
+	};
+
+	struct CATEGORY_TOTAL
+	{
+		// GPU time of all resolved runs
+		uint64_t gpuNs;
+		uint64_t runs;
+		// objects drawn in those runs
+		uint64_t objects;
+	};
+
+	// get the single timer instance
+	static CategoryTimer& Instance();
+
+	// start timing - needs a current OpenGL context
+	void Enable();
+	// stop timing and free the queries
+	void Disable();
+	bool IsEnabled() const { return(m_bEnabled); }
+
+	// mark the frame boundaries
+	void BeginFrame();
+	void EndFrame();
+
+	// time one run of objects of a category
+	int BeginScope(CATEGORY category);
+	void EndScope(int scopeIndex);
+	// count one object drawn in the run
+	void CountObject(int scopeIndex);
+
+	// wait for the results of every frame that is still pending
+	void Flush();
+	// forget the totals, e.g. after the warmup frames
+	void ResetTotals();
+	const CATEGORY_TOTAL& GetTotal(int category) const { return(m_totals[category]); }
+	// number of frames that were added into the totals
+	uint64_t GetResolvedFrames() const { return(m_resolvedFrames); }
+
+	// name used in the reports
+	static const char* GetCategoryName(int category);
+
+private:
+	// constructor
+	CategoryTimer();
+
+	// number of frames the queries may lag behind
+	static const int QUERY_LATENCY = 4;
+	// most timed runs in one frame
+	static const int MAX_SCOPES_PER_FRAME = 64;
+
+	struct FRAME_QUERIES
+	{
+		bool bPending;
+		int scopeCount;
+		int categories[MAX_SCOPES_PER_FRAME];
+		uint32_t objects[MAX_SCOPES_PER_FRAME];
+		// begin and end timestamp of every scope
+		GLuint queries[MAX_SCOPES_PER_FRAME][2];
+	};
+
+	bool m_bEnabled;
+	uint64_t m_frameNumber;
+	FRAME_QUERIES m_frames[QUERY_LATENCY];
+	CATEGORY_TOTAL m_totals[CATEGORY_COUNT];
+	uint64_t m_resolvedFrames;
+
+	// add the results of one frame into the totals
+	void ResolveFrame(FRAME_QUERIES& frame);
+};
+
+/***********************************************************
+ *  CategoryScope
+ *
+ *  This class times the rest of the enclosing scope under
+ *  the passed in category.
+ ***********************************************************/
+class CategoryScope
+{
+public:
+	explicit CategoryScope(CategoryTimer::CATEGORY category)
+	{
+		m_scopeIndex = CategoryTimer::Instance().BeginScope(category);
+	}
+	~CategoryScope()
+	{
+		CategoryTimer::Instance().EndScope(m_scopeIndex);
+	}
+
+private:
+	int m_scopeIndex;
+};
+
+#define GPU_CATEGORY_CONCAT2(a, b) a##b
+#define GPU_CATEGORY_CONCAT(a, b) GPU_CATEGORY_CONCAT2(a, b)
+// time the GPU work of the rest of the enclosing scope
+#define GPU_CATEGORY(category) CategoryScope GPU_CATEGORY_CONCAT(categoryScope, __LINE__)(CategoryTimer::category)
@@ -0,0 +1,431 @@
+///////////////////////////////////////////////////////////////////////////////
+// compiledscene.cpp
+// ============
+// write a scene as a binary file and map it back for use in place
+///////////////////////////////////////////////////////////////////////////////
+
+#include "CompiledScene.h"
+#include "SceneManager.h"
+#include "Logger.h"
+
+#include <cstring>
+#include <fstream>
+#include <map>
+#include <vector>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+// declaration of global variables and helper functions
+namespace
+{
+	const char g_Magic[8] = { 'C', 'S', '3', '3', '0', 'S', 'C', 'N' };
+	const uint32_t BYTE_ORDER_MARK = 0x01020304;
+
+	static_assert(sizeof(CompiledScene::HEADER) == 112, "the compiled scene header layout changed");
+	static_assert(sizeof(TransformStore::AFFINE_3X4) == 48, "the compiled scene matrix layout changed");
+
+	/***********************************************************
+	 *  AlignOffset()
+	 *
+	 *  This function is used for rounding a file offset up to
+	 *  the start of the next section.
+	 ***********************************************************/
+	uint64_t AlignOffset(uint64_t offset)
+	{
+		uint64_t alignment = CompiledScene::SECTION_ALIGNMENT;
+		return((offset + alignment - 1) / alignment * alignment);
+	}
+
+	/***********************************************************
+	 *  AddTag()
+	 *
+	 *  This function is used for getting the ID of a tag in a
+	 *  tag table, adding the tag if it is new.  Empty tags have
+	 *  no ID.
+	 ***********************************************************/
+	int32_t AddTag(const std::string& tag, std::map<std::string, int32_t>& ids, std::vector<std::string>& table)
+	{
+		if (tag.empty())
+		{
+			return(-1);
+		}
+
+		std::map<std::string, int32_t>::const_iterator found = ids.find(tag);
+		if (found != ids.end())
+		{
+			return(found->second);
+		}
+
+		int32_t id = (int32_t)table.size();
+		ids[tag] = id;
+		table.push_back(tag);
+		return(id);
+	}
+
+	/***********************************************************
+	 *  CopySection()
+	 *
+	 *  This function is used for copying an array into the file
+	 *  image at its section offset.
+	 ***********************************************************/
+	void CopySection(std::vector<uint8_t>& image, uint64_t offset, const void* pData, size_t bytes)
+	{
+		if (bytes > 0)
+		{
+			memcpy(&image[(size_t)offset], pData, bytes);
+		}
+	}
+
+	/***********************************************************
+	 *  SectionFits()
+	 *
+	 *  This function is used for checking that an array lies
+	 *  inside the file and starts on a section boundary.
+	 ***********************************************************/
+	bool SectionFits(uint64_t offset, uint64_t count, uint64_t elementBytes, uint64_t fileBytes)
+	{
+		return(((offset % CompiledScene::SECTION_ALIGNMENT) == 0) &&
+			(offset <= fileBytes) &&
+			(count <= (fileBytes - offset) / elementBytes));
+	}
+}
+
+/***********************************************************
+ *  CompiledScene()
+ *
+ *  The constructor for the class
+ ***********************************************************/
+CompiledScene::CompiledScene()
+{
+	m_pData = NULL;
+	m_mappedBytes = 0;
+	m_pHeader = NULL;
+	m_pFileHandle = NULL;
+	m_pMappingHandle = NULL;
+}
+
+/***********************************************************
+ *  ~CompiledScene()
+ *
+ *  The destructor for the class
+ ***********************************************************/
+CompiledScene::~CompiledScene()
+{
+	Close();
+}
+
+/***********************************************************
+ *  Write()
+ *
+ *  This method is used for building the whole file image in
+ *  memory and writing it out in one go.  The transforms must
+ *  have been composed.
+ ***********************************************************/
+bool CompiledScene::Write(const SceneDescription& scene, const TransformStore& transforms, const std::string& filename)
+{
+	uint32_t count = (uint32_t)scene.GetCount();
+	const std::vector<std::string>& textureTags = scene.GetTextureTags();
+	const std::vector<std::string>& materialTags = scene.GetMaterialTags();
+
+	std::map<std::string, int32_t> textureIds;
+	std::map<std::string, int32_t> materialIds;
+	std::vector<std::string> textureTable;
+	std::vector<std::string> materialTable;
+	std::vector<int32_t> objectTextureIds(count);
+	std::vector<int32_t> objectMaterialIds(count);
+	std::vector<TransformStore::AFFINE_3X4> models(count);
+	std::vector<BOUNDS> bounds(count);
+
+	for (uint32_t i = 0; i < count; i++)
+	{
+		objectTextureIds[i] = AddTag(textureTags[i], textureIds, textureTable);
+		objectMaterialIds[i] = AddTag(materialTags[i], materialIds, materialTable);
+		models[i] = transforms.GetAffine(i);
+		bounds[i] = TransformStore::ComputeBounds(models[i]);
+	}
+
+	for (size_t i = 0; i < textureTable.size(); i++)
+	{
+		if (textureTable[i].size() >= TAG_BYTES)
+		{
+			LOG_ERROR("Texture tag too long for a compiled scene:%s", textureTable[i].c_str());
+			return(false);
+		}
+	}
+	for (size_t i = 0; i < materialTable.size(); i++)
+	{
+		if (materialTable[i].size() >= TAG_BYTES)
+		{
+			LOG_ERROR("Material tag too long for a compiled scene:%s", materialTable[i].c_str());
+			return(false);
+		}
+	}
+
+	HEADER header;
+	memset(&header, 0, sizeof(header));
+	memcpy(header.magic, g_Magic, sizeof(header.magic));
+	header.version = VERSION;
+	header.byteOrder = BYTE_ORDER_MARK;
+	header.objectCount = count;
+	header.textureTagCount = (uint32_t)textureTable.size();
+	header.materialTagCount = (uint32_t)materialTable.size();
+
+	uint64_t offset = sizeof(HEADER);
+	header.kindsOffset = offset = AlignOffset(offset);
+	offset += count * sizeof(int32_t);
+	header.meshesOffset = offset = AlignOffset(offset);
+	offset += count * sizeof(int32_t);
+	header.colorsOffset = offset = AlignOffset(offset);
+	offset += count * 4 * sizeof(float);
+	header.modelsOffset = offset = AlignOffset(offset);
+	offset += count * sizeof(TransformStore::AFFINE_3X4);
+	header.boundsOffset = offset = AlignOffset(offset);
+	offset += count * sizeof(BOUNDS);
+	header.textureIdsOffset = offset = AlignOffset(offset);
+	offset += count * sizeof(int32_t);
+	header.materialIdsOffset = offset = AlignOffset(offset);
+	offset += count * sizeof(int32_t);
+	header.textureTagsOffset = offset = AlignOffset(offset);
+	offset += textureTable.size() * TAG_BYTES;
+	header.materialTagsOffset = offset = AlignOffset(offset);
+	offset += materialTable.size() * TAG_BYTES;
+	header.fileBytes = AlignOffset(offset);
+
+	std::vector<int32_t> kinds(scene.GetKinds().begin(), scene.GetKinds().end());
+	std::vector<int32_t> meshes(scene.GetMeshes().begin(), scene.GetMeshes().end());
+	std::vector<float> colors(count * 4);
+	for (uint32_t i = 0; i < count; i++)
+	{
+		const glm::vec4& color = scene.GetColors()[i];
+		colors[i * 4 + 0] = color.r;
+		colors[i * 4 + 1] = color.g;
+		colors[i * 4 + 2] = color.b;
+		colors[i * 4 + 3] = color.a;
+	}
+
+	// the image starts zeroed, so the padding and the unused
+	// bytes of every tag are zero
+	std::vector<uint8_t> image((size_t)header.fileBytes, 0);
+	CopySection(image, 0, &header, sizeof(header));
+	CopySection(image, header.kindsOffset, kinds.data(), count * sizeof(int32_t));
+	CopySection(image, header.meshesOffset, meshes.data(), count * sizeof(int32_t));
+	CopySection(image, header.colorsOffset, colors.data(), count * 4 * sizeof(float));
+	CopySection(image, header.modelsOffset, models.data(), count * sizeof(TransformStore::AFFINE_3X4));
+	CopySection(image, header.boundsOffset, bounds.data(), count * sizeof(BOUNDS));
+	CopySection(image, header.textureIdsOffset, objectTextureIds.data(), count * sizeof(int32_t));
+	CopySection(image, header.materialIdsOffset, objectMaterialIds.data(), count * sizeof(int32_t));
+	for (size_t i = 0; i < textureTable.size(); i++)
+	{
+		CopySection(image, header.textureTagsOffset + i * TAG_BYTES, textureTable[i].c_str(), textureTable[i].size());
+	}
+	for (size_t i = 0; i < materialTable.size(); i++)
+	{
+		CopySection(image, header.materialTagsOffset + i * TAG_BYTES, materialTable[i].c_str(), materialTable[i].size());
+	}
+
+	std::ofstream file(filename.c_str(), std::ios::binary);
+	if (!file.is_open())
+	{
+		LOG_ERROR("Could not open compiled scene file:%s", filename.c_str());
+		return(false);
+	}
+	file.write(reinterpret_cast<const char*>(image.data()), (std::streamsize)image.size());
+	if (!file.good())
+	{
+		LOG_ERROR("Could not write compiled scene file:%s", filename.c_str());
+		return(false);
+	}
+
+	LOG_INFO("Compiled %u objects into %s", count, filename.c_str());
+	return(true);
+}
+
+/***********************************************************
+ *  Open()
+ *
+ *  This method is used for mapping a compiled scene file
+ *  read-only.  Nothing is read from it here apart from the
+ *  header and the IDs, which are checked so a damaged file
+ *  cannot make the renderer index out of its tables.
+ ***********************************************************/
+bool CompiledScene::Open(const std::string& filename)
+{
+	Close();
+
+#ifdef _WIN32
+	HANDLE file = CreateFileA(filename.c_str(), GENERIC_READ, FILE_SHARE_READ, NULL,
+		OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+	if (file == INVALID_HANDLE_VALUE)
+	{
+		LOG_ERROR("Could not open compiled scene file:%s", filename.c_str());
+		return(false);
+	}
+
+	LARGE_INTEGER size;
+	HANDLE mapping = NULL;
+	const void* pView = NULL;
+	if ((GetFileSizeEx(file, &size) != 0) && (size.QuadPart > 0))
+	{
+		mapping = CreateFileMappingA(file, NULL, PAGE_READONLY, 0, 0, NULL);
+	}
+	if (NULL != mapping)
+	{
+		pView = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+	}
+	if (NULL == pView)
+	{
+		LOG_ERROR("Could not map compiled scene file:%s", filename.c_str());
+		if (NULL != mapping)
+		{
+			CloseHandle(mapping);
+		}
+		CloseHandle(file);
+		return(false);
+	}
+
+	m_pFileHandle = file;
+	m_pMappingHandle = mapping;
+	m_pData = static_cast<const uint8_t*>(pView);
+	m_mappedBytes = (uint64_t)size.QuadPart;
+#else
+	int fd = open(filename.c_str(), O_RDONLY);
+	if (fd < 0)
+	{
+		LOG_ERROR("Could not open compiled scene file:%s", filename.c_str());
+		return(false);
+	}
+
+	struct stat status;
+	void* pView = MAP_FAILED;
+	if ((fstat(fd, &status) == 0) && (status.st_size > 0))
+	{
+		pView = mmap(NULL, (size_t)status.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+	}
+	// the mapping stays valid after the file is closed
+	close(fd);
+	if (pView == MAP_FAILED)
+	{
+		LOG_ERROR("Could not map compiled scene file:%s", filename.c_str());
+		return(false);
+	}
+
+	m_pData = static_cast<const uint8_t*>(pView);
+	m_mappedBytes = (uint64_t)status.st_size;
+#endif
+
+	m_pHeader = reinterpret_cast<const HEADER*>(m_pData);
+	if (Validate() == false)
+	{
+		LOG_ERROR("Not a valid version %u compiled scene file:%s", VERSION, filename.c_str());
+		Close();
+		return(false);
+	}
+
+	return(true);
+}
+
+/***********************************************************
+ *  Close()
+ *
+ *  This method is used for unmapping the file.
+ ***********************************************************/
+void CompiledScene::Close()
+{
+	if (NULL == m_pData)
+	{
+		return;
+	}
+
+#ifdef _WIN32
+	UnmapViewOfFile(m_pData);
+	CloseHandle(static_cast<HANDLE>(m_pMappingHandle));
+	CloseHandle(static_cast<HANDLE>(m_pFileHandle));
+#else
+	munmap(const_cast<uint8_t*>(m_pData), (size_t)m_mappedBytes);
+#endif
+
+	m_pData = NULL;
+	m_mappedBytes = 0;
+	m_pHeader = NULL;
+	m_pFileHandle = NULL;
+	m_pMappingHandle = NULL;
+}
+
+/***********************************************************
+ *  Validate()
+ *
+ *  This method is used for checking the header of the mapped
+ *  file, that every array fits inside it, that every tag is
+ *  terminated and that every kind, mesh and ID is in range.
+ ***********************************************************/
+bool CompiledScene::Validate() const
+{
+	if (m_mappedBytes < sizeof(HEADER))
+	{
+		return(false);
+	}
+
+	const HEADER& header = *m_pHeader;
+	uint64_t count = header.objectCount;
+	if ((memcmp(header.magic, g_Magic, sizeof(g_Magic)) != 0) ||
+		(header.version != VERSION) ||
+		(header.byteOrder != BYTE_ORDER_MARK) ||
+		(header.fileBytes != m_mappedBytes))
+	{
+		return(false);
+	}
+
+	if (!SectionFits(header.kindsOffset, count, sizeof(int32_t), m_mappedBytes) ||
+		!SectionFits(header.meshesOffset, count, sizeof(int32_t), m_mappedBytes) ||
+		!SectionFits(header.colorsOffset, count, 4 * sizeof(float), m_mappedBytes) ||
+		!SectionFits(header.modelsOffset, count, sizeof(TransformStore::AFFINE_3X4), m_mappedBytes) ||
+		!SectionFits(header.boundsOffset, count, sizeof(BOUNDS), m_mappedBytes) ||
+		!SectionFits(header.textureIdsOffset, count, sizeof(int32_t), m_mappedBytes) ||
+		!SectionFits(header.materialIdsOffset, count, sizeof(int32_t), m_mappedBytes) ||
+		!SectionFits(header.textureTagsOffset, header.textureTagCount, TAG_BYTES, m_mappedBytes) ||
+		!SectionFits(header.materialTagsOffset, header.materialTagCount, TAG_BYTES, m_mappedBytes))
+	{
+		return(false);
+	}
+
+	for (uint32_t i = 0; i < header.textureTagCount; i++)
+	{
+		if (GetTextureTag(i)[TAG_BYTES - 1] != '\0')
+		{
+			return(false);
+		}
+	}
+	for (uint32_t i = 0; i < header.materialTagCount; i++)
+	{
+		if (GetMaterialTag(i)[TAG_BYTES - 1] != '\0')
+		{
+			return(false);
+		}
+	}
+
+	const int32_t* kinds = GetKinds();
+	const int32_t* meshes = GetMeshes();
+	const int32_t* textureIds = GetTextureIds();
+	const int32_t* materialIds = GetMaterialIds();
+	for (uint32_t i = 0; i < header.objectCount; i++)
+	{
+		if ((kinds[i] < 0) || (kinds[i] >= SceneDescription::KIND_COUNT) ||
+			(meshes[i] < 0) || (meshes[i] >= SceneManager::MESH_TYPE_COUNT) ||
+			(textureIds[i] < -1) || (textureIds[i] >= (int32_t)header.textureTagCount) ||
+			(materialIds[i] < -1) || (materialIds[i] >= (int32_t)header.materialTagCount))
+		{
+			return(false);
+		}
+	}
+
+	return(true);
+}
@@ -0,0 +1,116 @@
+///////////////////////////////////////////////////////////////////////////////
+// compiledscene.h
+// ============
+// write a scene as a binary file and map it back for use in place
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include "SceneDescription.h"
+#include "TransformStore.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+/***********************************************************
+ *  CompiledScene
+ *
+ *  This class writes the objects of a loaded scene, with
+ *  their model matrices already composed, into one binary
+ *  file, and maps such a file read-only so the renderer can
+ *  walk its arrays in place.  Opening a compiled scene does
+ *  not parse text or allocate anything per object; the cost
+ *  is the page faults of the arrays the first time they are
+ *  read.  The file starts with a HEADER followed by the
+ *  arrays, each starting on a SECTION_ALIGNMENT boundary.
+ *  Texture and material IDs index the fixed-size tag tables
+ *  at the end of the file, -1 for none.
+ ***********************************************************/
+class CompiledScene
+{
+public:
+	// version of the file layout, bumped whenever it changes
+	static const uint32_t VERSION = 1;
+	// alignment of every array from the start of the file
+	static const uint32_t SECTION_ALIGNMENT = 64;
+	// bytes of one tag table entry, including the terminator
+	static const uint32_t TAG_BYTES = 32;
+
+	struct HEADER
+	{
+		char magic[8];
+		uint32_t version;
+		// written as 0x01020304 so a file from a machine of the
+		// other byte order is rejected
+		uint32_t byteOrder;
+		uint32_t objectCount;
+		uint32_t textureTagCount;
+		uint32_t materialTagCount;
+		uint32_t reserved;
+		uint64_t fileBytes;
+		// offsets of the arrays from the start of the file
+		uint64_t kindsOffset;
+		uint64_t meshesOffset;
+		uint64_t colorsOffset;
+		uint64_t modelsOffset;
+		uint64_t boundsOffset;
+		uint64_t textureIdsOffset;
+		uint64_t materialIdsOffset;
+		uint64_t textureTagsOffset;
+		uint64_t materialTagsOffset;
+	};
+
+	// world space box around an object
+	typedef TransformStore::BOUNDS BOUNDS;
+
+	// constructor
+	CompiledScene();
+	// destructor
+	~CompiledScene();
+
+	// write the objects of a scene and their composed matrices
+	// to a compiled scene file
+	static bool Write(const SceneDescription& scene, const TransformStore& transforms, const std::string& filename);
+
+	// map a compiled scene file and check that it is complete
+	bool Open(const std::string& filename);
+	// unmap the file
+	void Close();
+	bool IsOpen() const { return(NULL != m_pHeader); }
+
+	// per-object arrays, all GetCount() long, valid while the
+	// file is open
+	uint32_t GetCount() const { return(m_pHeader->objectCount); }
+	const int32_t* GetKinds() const { return(Section<int32_t>(m_pHeader->kindsOffset)); }
+	const int32_t* GetMeshes() const { return(Section<int32_t>(m_pHeader->meshesOffset)); }
+	// RGBA, four floats per object
+	const float* GetColors() const { return(Section<float>(m_pHeader->colorsOffset)); }
+	const TransformStore::AFFINE_3X4* GetModels() const { return(Section<TransformStore::AFFINE_3X4>(m_pHeader->modelsOffset)); }
+	const BOUNDS* GetBounds() const { return(Section<BOUNDS>(m_pHeader->boundsOffset)); }
+	const int32_t* GetTextureIds() const { return(Section<int32_t>(m_pHeader->textureIdsOffset)); }
+	const int32_t* GetMaterialIds() const { return(Section<int32_t>(m_pHeader->materialIdsOffset)); }
+
+	// tag tables the IDs index
+	uint32_t GetTextureTagCount() const { return(m_pHeader->textureTagCount); }
+	const char* GetTextureTag(uint32_t id) const { return(Section<char>(m_pHeader->textureTagsOffset) + id * TAG_BYTES); }
+	uint32_t GetMaterialTagCount() const { return(m_pHeader->materialTagCount); }
+	const char* GetMaterialTag(uint32_t id) const { return(Section<char>(m_pHeader->materialTagsOffset) + id * TAG_BYTES); }
+
+	// bytes of the mapped file
+	uint64_t GetMappedBytes() const { return(m_mappedBytes); }
+
+private:
+	const uint8_t* m_pData;
+	uint64_t m_mappedBytes;
+	const HEADER* m_pHeader;
+	// platform handles of the open file and its mapping
+	void* m_pFileHandle;
+	void* m_pMappingHandle;
+
+	template <typename T>
+	const T* Section(uint64_t offset) const { return(reinterpret_cast<const T*>(m_pData + offset)); }
+
+	// check the header, the array bounds and every ID
+	bool Validate() const;
+};
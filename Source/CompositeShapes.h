@@ -0,0 +1,211 @@
+///////////////////////////////////////////////////////////////////////////////
+// compositeshapes.h
+// ============
+// the parts of the composite scene shapes, shared by the loaded and baked scenes
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include "SceneManager.h"
+
+#include <cstddef>
+
+// composite shapes a scene places with one line or call
+enum COMPOSITE_TYPE
+{
+	COMPOSITE_PLANES = 0,
+	COMPOSITE_PYRAMID_TREE,
+	COMPOSITE_SPHERICAL_TREE,
+	COMPOSITE_MOUNTAIN,
+	COMPOSITE_CLOUD,
+	COMPOSITE_TYPE_COUNT
+};
+
+/***********************************************************
+ *  COMPOSITE_PART
+ *
+ *  This structure holds one mesh of a composite shape.  The
+ *  offset is added to the position the shape is placed at,
+ *  and the scale is multiplied by the shape's scale when the
+ *  part is marked as scaled.
+ ***********************************************************/
+struct COMPOSITE_PART
+{
+	// a SceneDescription::OBJECT_KIND
+	int kind;
+	// a SceneManager::MESH_TYPE
+	int mesh;
+	float scale[3];
+	bool bScaled;
+	// X, Y and Z rotations in degrees
+	float rotation[3];
+	float offset[3];
+	float color[4];
+	// empty for an untextured part
+	const char* textureTag;
+	const char* materialTag;
+};
+
+struct COMPOSITE_SHAPE
+{
+	const COMPOSITE_PART* pParts;
+	size_t partCount;
+};
+
+// the part tables are constant expressions, so both the scene
+// file loader and the baked scene build their objects from them
+constexpr COMPOSITE_PART g_PlanesParts[] =
+{
+	{ SceneDescription::KIND_GROUND, SceneManager::MESH_PLANE, { 200.0f, 1.0f, 200.0f }, false,
+		{ 0.0f, 0.0f, 0.0f }, { 0.0f, 0.0f, 0.0f }, { 0.0f, 0.502f, 0.0f, 1.0f }, "", "greenery" },
+	{ SceneDescription::KIND_SKY, SceneManager::MESH_PLANE, { 300.0f, 1.0f, 300.0f }, false,
+		{ 90.0f, 0.0f, 0.0f }, { 0.0f, 15.0f, -50.0f }, { 0.416f, 0.835f, 0.851f, 1.0f }, "", "sky" }
+};
+
+// the pyramid tree stands 12 units to the right of the
+// position it is placed at
+constexpr COMPOSITE_PART g_PyramidTreeParts[] =
+{
+	{ SceneDescription::KIND_PYRAMID_TREE, SceneManager::MESH_CYLINDER, { 1.0f, 8.0f, 1.0f }, false,
+		{ 0.0f, 0.0f, 0.0f }, { 12.0f, 0.0f, 0.0f }, { 0.235f, 0.702f, 0.443f, 1.0f }, "log", "wood" },
+	{ SceneDescription::KIND_PYRAMID_TREE, SceneManager::MESH_PYRAMID3, { 9.0f, 9.0f, 9.0f }, false,
+		{ 0.0f, 0.0f, 0.0f }, { 12.0f, 10.5f, -0.5f }, { 0.065f, 0.532f, 0.273f, 1.0f }, "pineleaves", "greenery" },
+	{ SceneDescription::KIND_PYRAMID_TREE, SceneManager::MESH_PYRAMID3, { 7.0f, 7.0f, 7.0f }, false,
+		{ 0.0f, 0.0f, 0.0f }, { 12.0f, 15.0f, -0.5f }, { 0.065f, 0.532f, 0.273f, 1.0f }, "pineleaves", "greenery" },
+	{ SceneDescription::KIND_PYRAMID_TREE, SceneManager::MESH_PYRAMID3, { 5.0f, 5.0f, 5.0f }, false,
+		{ 0.0f, 0.0f, 0.0f }, { 12.0f, 19.0f, -0.5f }, { 0.065f, 0.532f, 0.273f, 1.0f }, "pineleaves", "greenery" }
+};
+
+constexpr COMPOSITE_PART g_SphericalTreeParts[] =
+{
+	{ SceneDescription::KIND_SPHERICAL_TREE, SceneManager::MESH_CYLINDER, { 1.0f, 8.0f, 1.0f }, false,
+		{ 0.0f, 0.0f, 0.0f }, { 0.0f, 0.0f, 0.0f }, { 0.235f, 0.702f, 0.443f, 1.0f }, "log", "wood" },
+	{ SceneDescription::KIND_SPHERICAL_TREE, SceneManager::MESH_SPHERE, { 2.0f, 2.0f, 2.0f }, false,
+		{ 0.0f, 0.0f, 0.0f }, { 0.0f, 8.0f, 0.0f }, { 0.235f, 0.702f, 0.443f, 1.0f }, "", "greenery" },
+	{ SceneDescription::KIND_SPHERICAL_TREE, SceneManager::MESH_SPHERE, { 4.0f, 4.0f, 4.0f }, false,
+		{ 0.0f, 0.0f, 0.0f }, { 0.0f, 10.0f, 0.0f }, { 0.065f, 0.532f, 0.273f, 1.0f }, "leaves", "greenery" }
+};
+
+constexpr COMPOSITE_PART g_MountainParts[] =
+{
+	{ SceneDescription::KIND_MOUNTAIN, SceneManager::MESH_PYRAMID3, { 1.0f, 1.0f, 1.0f }, true,
+		{ 0.0f, 180.0f, 0.0f }, { 0.0f, 0.0f, 0.0f }, { 0.5f, 0.5f, 0.5f, 1.0f }, "stone", "wood" }
+};
+
+// the cloud's scale sizes its spheres but not the distances
+// between them
+constexpr COMPOSITE_PART g_CloudParts[] =
+{
+	{ SceneDescription::KIND_CLOUD, SceneManager::MESH_SPHERE, { 1.5f, 1.0f, 1.5f }, true,
+		{ 0.0f, 0.0f, 0.0f }, { 0.0f, 1.5f, 0.0f }, { 0.9f, 0.9f, 0.9f, 1.0f }, "", "wood" },
+	{ SceneDescription::KIND_CLOUD, SceneManager::MESH_SPHERE, { 3.0f, 2.0f, 3.0f }, true,
+		{ 0.0f, 0.0f, 0.0f }, { -3.5f, 0.0f, 0.5f }, { 0.9f, 0.9f, 0.9f, 1.0f }, "", "wood" },
+	{ SceneDescription::KIND_CLOUD, SceneManager::MESH_SPHERE, { 3.0f, 2.0f, 3.0f }, true,
+		{ 0.0f, 0.0f, 0.0f }, { 3.25f, 0.0f, -0.5f }, { 0.9f, 0.9f, 0.9f, 1.0f }, "", "wood" },
+	{ SceneDescription::KIND_CLOUD, SceneManager::MESH_SPHERE, { 4.0f, 3.0f, 4.0f }, true,
+		{ 0.0f, 0.0f, 0.0f }, { 0.5f, -1.0f, 2.0f }, { 0.9f, 0.9f, 0.9f, 1.0f }, "", "wood" },
+	{ SceneDescription::KIND_CLOUD, SceneManager::MESH_SPHERE, { 3.0f, 2.0f, 3.0f }, true,
+		{ 0.0f, 0.0f, 0.0f }, { -5.0f, -0.5f, 1.0f }, { 0.9f, 0.9f, 0.9f, 1.0f }, "", "wood" },
+	{ SceneDescription::KIND_CLOUD, SceneManager::MESH_SPHERE, { 4.0f, 2.0f, 4.0f }, true,
+		{ 0.0f, 0.0f, 0.0f }, { 5.5f, 0.0f, -1.25f }, { 0.9f, 0.9f, 0.9f, 1.0f }, "", "wood" }
+};
+
+// indexed by COMPOSITE_TYPE
+constexpr COMPOSITE_SHAPE g_CompositeShapes[COMPOSITE_TYPE_COUNT] =
+{
+	{ g_PlanesParts, sizeof(g_PlanesParts) / sizeof(g_PlanesParts[0]) },
+	{ g_PyramidTreeParts, sizeof(g_PyramidTreeParts) / sizeof(g_PyramidTreeParts[0]) },
+	{ g_SphericalTreeParts, sizeof(g_SphericalTreeParts) / sizeof(g_SphericalTreeParts[0]) },
+	{ g_MountainParts, sizeof(g_MountainParts) / sizeof(g_MountainParts[0]) },
+	{ g_CloudParts, sizeof(g_CloudParts) / sizeof(g_CloudParts[0]) }
+};
+
+constexpr double COMPOSITE_PI = 3.14159265358979323846;
+
+/***********************************************************
+ *  SinRadians()
+ *
+ *  This function is used for getting the sine of an angle
+ *  from its Taylor series, so it can run at compile time.
+ ***********************************************************/
+constexpr double SinRadians(double x)
+{
+	while (x > COMPOSITE_PI)
+	{
+		x -= 2.0 * COMPOSITE_PI;
+	}
+	while (x < -COMPOSITE_PI)
+	{
+		x += 2.0 * COMPOSITE_PI;
+	}
+
+	double term = x;
+	double sum = x;
+	for (int n = 1; n <= 10; n++)
+	{
+		term *= -x * x / ((2.0 * n) * (2.0 * n + 1.0));
+		sum += term;
+	}
+	return(sum);
+}
+
+/***********************************************************
+ *  CosRadians()
+ *
+ *  This function is used for getting the cosine of an angle
+ *  from its Taylor series, so it can run at compile time.
+ ***********************************************************/
+constexpr double CosRadians(double x)
+{
+	while (x > COMPOSITE_PI)
+	{
+		x -= 2.0 * COMPOSITE_PI;
+	}
+	while (x < -COMPOSITE_PI)
+	{
+		x += 2.0 * COMPOSITE_PI;
+	}
+
+	double term = 1.0;
+	double sum = 1.0;
+	for (int n = 1; n <= 10; n++)
+	{
+		term *= -x * x / ((2.0 * n - 1.0) * (2.0 * n));
+		sum += term;
+	}
+	return(sum);
+}
+
+/***********************************************************
+ *  ComposeAffine()
+ *
+ *  This function is used for composing T * Rz * Ry * Rx * S
+ *  into the upper three rows of a model matrix, laid out
+ *  the same way as the transform store composes them, at
+ *  compile time.
+ ***********************************************************/
+constexpr void ComposeAffine(const float* scale, const float* rotationDeg, const float* position, float* m)
+{
+	double x = rotationDeg[0] * COMPOSITE_PI / 180.0;
+	double y = rotationDeg[1] * COMPOSITE_PI / 180.0;
+	double z = rotationDeg[2] * COMPOSITE_PI / 180.0;
+	double sx = SinRadians(x);
+	double cx = CosRadians(x);
+	double sy = SinRadians(y);
+	double cy = CosRadians(y);
+	double sz = SinRadians(z);
+	double cz = CosRadians(z);
+
+	m[0] = (float)(cy * cz * scale[0]);
+	m[1] = (float)((sx * sy * cz - cx * sz) * scale[1]);
+	m[2] = (float)((cx * sy * cz + sx * sz) * scale[2]);
+	m[3] = position[0];
+	m[4] = (float)(cy * sz * scale[0]);
+	m[5] = (float)((sx * sy * sz + cx * cz) * scale[1]);
+	m[6] = (float)((cx * sy * sz - sx * cz) * scale[2]);
+	m[7] = position[1];
+	m[8] = (float)(-sy * scale[0]);
+	m[9] = (float)(sx * cy * scale[1]);
+	m[10] = (float)(cx * cy * scale[2]);
+	m[11] = position[2];
+}
@@ -0,0 +1,499 @@
+///////////////////////////////////////////////////////////////////////////////
+// drawstream.cpp
+// ============
+// record the uniform writes and mesh draws of the scene into a binary file
+// and replay them against an OpenGL context
+///////////////////////////////////////////////////////////////////////////////
+
+#include "DrawStream.h"
+#include "SceneManager.h"
+#include "Logger.h"
+
+#include <cstring>
+#include <fstream>
+
+// declaration of the helper functions
+namespace
+{
+	/***********************************************************
+	 *  STREAM_READER
+	 *
+	 *  This structure walks the bytes of a loaded stream file
+	 *  and remembers when a read ran past the end.
+	 ***********************************************************/
+	struct STREAM_READER
+	{
+		const unsigned char* data;
+		size_t size;
+		size_t offset;
+		bool bOverrun;
+
+		bool Read(void* value, size_t count)
+		{
+			if (offset + count > size)
+			{
+				bOverrun = true;
+				return(false);
+			}
+			memcpy(value, data + offset, count);
+			offset += count;
+			return(true);
+		}
+	};
+
+	/***********************************************************
+	 *  UniformValueCount()
+	 *
+	 *  This function is used for getting the number of floats
+	 *  that a uniform command carries.
+	 ***********************************************************/
+	int UniformValueCount(uint8_t op)
+	{
+		switch (op)
+		{
+		case DrawStream::OP_INT:
+		case DrawStream::OP_FLOAT:
+			return(1);
+		case DrawStream::OP_VEC2:
+			return(2);
+		case DrawStream::OP_VEC3:
+			return(3);
+		case DrawStream::OP_VEC4:
+			return(4);
+		case DrawStream::OP_MAT4:
+			return(16);
+		default:
+			return(0);
+		}
+	}
+}
+
+/***********************************************************
+ *  DrawStreamRecorder()
+ *
+ *  The constructor for the class
+ ***********************************************************/
+DrawStreamRecorder::DrawStreamRecorder()
+{
+	m_frameCount = 0;
+	Write(&DrawStream::FILE_MAGIC, sizeof(DrawStream::FILE_MAGIC));
+	Write(&DrawStream::FILE_VERSION, sizeof(DrawStream::FILE_VERSION));
+}
+
+/***********************************************************
+ *  Write()
+ *
+ *  This method is used for appending raw bytes to the
+ *  stream.  The stream is written in the byte order of the
+ *  host, which is little-endian on every supported target.
+ ***********************************************************/
+void DrawStreamRecorder::Write(const void* data, size_t size)
+{
+	const unsigned char* bytes = (const unsigned char*)data;
+	m_stream.insert(m_stream.end(), bytes, bytes + size);
+}
+
+/***********************************************************
+ *  NameID()
+ *
+ *  This method is used for getting the id of a uniform name.
+ *  A NAME command is written the first time a name is used.
+ ***********************************************************/
+uint16_t DrawStreamRecorder::NameID(const char* name)
+{
+	for (size_t i = 0; i < m_names.size(); i++)
+	{
+		if (m_names[i].compare(name) == 0)
+		{
+			return((uint16_t)i);
+		}
+	}
+
+	uint16_t id = (uint16_t)m_names.size();
+	uint8_t length = (uint8_t)strlen(name);
+	uint8_t op = DrawStream::OP_NAME;
+	Write(&op, sizeof(op));
+	Write(&id, sizeof(id));
+	Write(&length, sizeof(length));
+	Write(name, length);
+	m_names.push_back(std::string(name, length));
+
+	return(id);
+}
+
+/***********************************************************
+ *  BeginFrame()
+ *
+ *  This method is used for marking the start of a frame.
+ ***********************************************************/
+void DrawStreamRecorder::BeginFrame()
+{
+	uint8_t op = DrawStream::OP_FRAME;
+	Write(&op, sizeof(op));
+	m_frameCount++;
+}
+
+/***********************************************************
+ *  RecordTexture()
+ *
+ *  This method is used for recording the size and format of
+ *  a texture so the replay can create a matching one.
+ ***********************************************************/
+void DrawStreamRecorder::RecordTexture(int unit, int width, int height, int channels)
+{
+	uint8_t op = DrawStream::OP_TEXTURE;
+	uint8_t textureUnit = (uint8_t)unit;
+	uint16_t textureWidth = (uint16_t)width;
+	uint16_t textureHeight = (uint16_t)height;
+	uint8_t textureChannels = (uint8_t)channels;
+	Write(&op, sizeof(op));
+	Write(&textureUnit, sizeof(textureUnit));
+	Write(&textureWidth, sizeof(textureWidth));
+	Write(&textureHeight, sizeof(textureHeight));
+	Write(&textureChannels, sizeof(textureChannels));
+}
+
+/***********************************************************
+ *  WriteUniform()
+ *
+ *  This method is used for writing a uniform command with
+ *  its name id and values.
+ ***********************************************************/
+void DrawStreamRecorder::WriteUniform(DrawStream::OPCODE op, const char* name, const float* values, int count)
+{
+	// the name command has to come before the uniform command
+	uint16_t id = NameID(name);
+	uint8_t opcode = (uint8_t)op;
+	Write(&opcode, sizeof(opcode));
+	Write(&id, sizeof(id));
+	Write(values, count * sizeof(float));
+}
+
+/***********************************************************
+ *  RecordInt()
+ *
+ *  These methods are used for recording a uniform write.
+ ***********************************************************/
+void DrawStreamRecorder::RecordInt(const char* name, int value)
+{
+	float bits = 0.0f;
+	memcpy(&bits, &value, sizeof(bits));
+	WriteUniform(DrawStream::OP_INT, name, &bits, 1);
+}
+
+void DrawStreamRecorder::RecordFloat(const char* name, float value)
+{
+	WriteUniform(DrawStream::OP_FLOAT, name, &value, 1);
+}
+
+void DrawStreamRecorder::RecordVec2(const char* name, const glm::vec2& value)
+{
+	WriteUniform(DrawStream::OP_VEC2, name, &value.x, 2);
+}
+
+void DrawStreamRecorder::RecordVec3(const char* name, const glm::vec3& value)
+{
+	WriteUniform(DrawStream::OP_VEC3, name, &value.x, 3);
+}
+
+void DrawStreamRecorder::RecordVec4(const char* name, const glm::vec4& value)
+{
+	WriteUniform(DrawStream::OP_VEC4, name, &value.x, 4);
+}
+
+void DrawStreamRecorder::RecordMat4(const char* name, const glm::mat4& value)
+{
+	WriteUniform(DrawStream::OP_MAT4, name, &value[0].x, 16);
+}
+
+/***********************************************************
+ *  RecordDraw()
+ *
+ *  This method is used for recording a draw of one of the
+ *  basic meshes.
+ ***********************************************************/
+void DrawStreamRecorder::RecordDraw(int meshType)
+{
+	uint8_t op = DrawStream::OP_DRAW;
+	uint8_t mesh = (uint8_t)meshType;
+	Write(&op, sizeof(op));
+	Write(&mesh, sizeof(mesh));
+}
+
+/***********************************************************
+ *  Save()
+ *
+ *  This method is used for writing the recorded stream into
+ *  the passed in file.
+ ***********************************************************/
+bool DrawStreamRecorder::Save(const std::string& filename) const
+{
+	std::ofstream file(filename.c_str(), std::ios::binary);
+	if (!file.is_open())
+	{
+		LOG_ERROR("Could not write draw stream:%s", filename.c_str());
+		return(false);
+	}
+
+	file.write((const char*)m_stream.data(), m_stream.size());
+
+	LOG_INFO("Wrote draw stream:%s, frames:%d, bytes:%llu", filename.c_str(), m_frameCount,
+		(unsigned long long)m_stream.size());
+
+	return(file.good());
+}
+
+/***********************************************************
+ *  DrawStreamPlayer()
+ *
+ *  The constructor for the class
+ ***********************************************************/
+DrawStreamPlayer::DrawStreamPlayer()
+{
+	m_pMeshes = new ShapeMeshes();
+	m_nextFrame = 0;
+}
+
+/***********************************************************
+ *  ~DrawStreamPlayer()
+ *
+ *  The destructor for the class
+ ***********************************************************/
+DrawStreamPlayer::~DrawStreamPlayer()
+{
+	if (!m_textures.empty())
+	{
+		glDeleteTextures((GLsizei)m_textures.size(), m_textures.data());
+	}
+	delete m_pMeshes;
+	m_pMeshes = NULL;
+}
+
+/***********************************************************
+ *  Load()
+ *
+ *  This method is used for loading a recorded stream.  The
+ *  uniform names are resolved against the shader program that
+ *  is currently in use, the recorded textures are recreated
+ *  with the same size and format, and the basic meshes are
+ *  loaded for the DRAW commands.
+ ***********************************************************/
+bool DrawStreamPlayer::Load(const std::string& filename)
+{
+	std::ifstream file(filename.c_str(), std::ios::binary);
+	if (!file.is_open())
+	{
+		LOG_ERROR("Could not open draw stream:%s", filename.c_str());
+		return(false);
+	}
+	std::vector<unsigned char> bytes(
+		(std::istreambuf_iterator<char>(file)),
+		std::istreambuf_iterator<char>());
+
+	STREAM_READER reader = { bytes.data(), bytes.size(), 0, false };
+
+	uint32_t magic = 0;
+	uint16_t version = 0;
+	reader.Read(&magic, sizeof(magic));
+	reader.Read(&version, sizeof(version));
+	if ((magic != DrawStream::FILE_MAGIC) || (version != DrawStream::FILE_VERSION))
+	{
+		LOG_ERROR("Not a supported draw stream:%s", filename.c_str());
+		return(false);
+	}
+
+	GLint program = 0;
+	glGetIntegerv(GL_CURRENT_PROGRAM, &program);
+
+	std::vector<GLint> locations;
+	uint8_t op = 0;
+	while ((reader.offset < reader.size) && reader.Read(&op, sizeof(op)))
+	{
+		COMMAND command;
+		command.op = op;
+		command.mesh = 0;
+		command.location = -1;
+		command.valueIndex = (uint32_t)m_values.size();
+
+		if (op == DrawStream::OP_NAME)
+		{
+			uint16_t id = 0;
+			uint8_t length = 0;
+			char name[256];
+			reader.Read(&id, sizeof(id));
+			reader.Read(&length, sizeof(length));
+			if (reader.Read(name, length))
+			{
+				name[length] = '\0';
+				locations.resize(id + 1, -1);
+				locations[id] = glGetUniformLocation(program, name);
+			}
+			continue;
+		}
+		else if (op == DrawStream::OP_TEXTURE)
+		{
+			uint8_t unit = 0;
+			uint16_t width = 0;
+			uint16_t height = 0;
+			uint8_t channels = 0;
+			reader.Read(&unit, sizeof(unit));
+			reader.Read(&width, sizeof(width));
+			reader.Read(&height, sizeof(height));
+			reader.Read(&channels, sizeof(channels));
+			command.mesh = unit;
+			m_values.push_back((float)width);
+			m_values.push_back((float)height);
+			m_values.push_back((float)channels);
+		}
+		else if (op == DrawStream::OP_FRAME)
+		{
+			m_frameStarts.push_back(m_commands.size());
+			continue;
+		}
+		else if (op == DrawStream::OP_DRAW)
+		{
+			reader.Read(&command.mesh, sizeof(command.mesh));
+		}
+		else if (UniformValueCount(op) > 0)
+		{
+			uint16_t id = 0;
+			float values[16];
+			int count = UniformValueCount(op);
+			reader.Read(&id, sizeof(id));
+			reader.Read(values, count * sizeof(float));
+			command.location = (id < locations.size()) ? locations[id] : -1;
+			m_values.insert(m_values.end(), values, values + count);
+		}
+		else
+		{
+			LOG_ERROR("Unknown draw stream command:%d", (int)op);
+			return(false);
+		}
+
+		m_commands.push_back(command);
+	}
+
+	if (reader.bOverrun || m_frameStarts.empty())
+	{
+		LOG_ERROR("Draw stream is truncated or has no frames:%s", filename.c_str());
+		return(false);
+	}
+
+	m_pMeshes->LoadPlaneMesh();
+	m_pMeshes->LoadCylinderMesh();
+	m_pMeshes->LoadSphereMesh();
+	m_pMeshes->LoadPyramid3Mesh();
+
+	return(true);
+}
+
+/***********************************************************
+ *  Execute()
+ *
+ *  This method is used for issuing the decoded commands in
+ *  the passed in range straight to OpenGL.
+ ***********************************************************/
+void DrawStreamPlayer::Execute(size_t first, size_t last)
+{
+	for (size_t i = first; i < last; i++)
+	{
+		const COMMAND& command = m_commands[i];
+		const float* values = m_values.data() + command.valueIndex;
+
+		switch (command.op)
+		{
+		case DrawStream::OP_TEXTURE:
+		{
+			// the texel data is not recorded, only its size matters
+			GLuint texture = 0;
+			GLsizei width = (GLsizei)values[0];
+			GLsizei height = (GLsizei)values[1];
+			bool bAlpha = (values[2] == 4.0f);
+			glGenTextures(1, &texture);
+			glActiveTexture(GL_TEXTURE0 + command.mesh);
+			glBindTexture(GL_TEXTURE_2D, texture);
+			glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
+			glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
+			glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+			glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+			glTexImage2D(GL_TEXTURE_2D, 0, bAlpha ? GL_RGBA8 : GL_RGB8, width, height, 0,
+				bAlpha ? GL_RGBA : GL_RGB, GL_UNSIGNED_BYTE, NULL);
+			glGenerateMipmap(GL_TEXTURE_2D);
+			m_textures.push_back(texture);
+			break;
+		}
+		case DrawStream::OP_INT:
+		{
+			int value = 0;
+			memcpy(&value, values, sizeof(value));
+			glUniform1i(command.location, value);
+			break;
+		}
+		case DrawStream::OP_FLOAT:
+			glUniform1f(command.location, values[0]);
+			break;
+		case DrawStream::OP_VEC2:
+			glUniform2fv(command.location, 1, values);
+			break;
+		case DrawStream::OP_VEC3:
+			glUniform3fv(command.location, 1, values);
+			break;
+		case DrawStream::OP_VEC4:
+			glUniform4fv(command.location, 1, values);
+			break;
+		case DrawStream::OP_MAT4:
+			glUniformMatrix4fv(command.location, 1, GL_FALSE, values);
+			break;
+		case DrawStream::OP_DRAW:
+			switch (command.mesh)
+			{
+			case SceneManager::MESH_PLANE:
+				m_pMeshes->DrawPlaneMesh();
+				break;
+			case SceneManager::MESH_CYLINDER:
+				m_pMeshes->DrawCylinderMesh();
+				break;
+			case SceneManager::MESH_SPHERE:
+				m_pMeshes->DrawSphereMesh();
+				break;
+			case SceneManager::MESH_PYRAMID3:
+				m_pMeshes->DrawPyramid3Mesh();
+				break;
+			default:
+				break;
+			}
+			break;
+		default:
+			break;
+		}
+	}
+}
+
+/***********************************************************
+ *  ExecuteSetup()
+ *
+ *  This method is used for issuing the commands that were
+ *  recorded before the first frame.
+ ***********************************************************/
+void DrawStreamPlayer::ExecuteSetup()
+{
+	Execute(0, m_frameStarts[0]);
+}
+
+/***********************************************************
+ *  ExecuteFrame()
+ *
+ *  This method is used for issuing the commands of the next
+ *  recorded frame.  After the last frame the replay starts
+ *  over with the first one.
+ ***********************************************************/
+void DrawStreamPlayer::ExecuteFrame()
+{
+	size_t first = m_frameStarts[m_nextFrame];
+	size_t last = ((m_nextFrame + 1) < m_frameStarts.size()) ?
+		m_frameStarts[m_nextFrame + 1] : m_commands.size();
+
+	Execute(first, last);
+
+	m_nextFrame = (m_nextFrame + 1) % m_frameStarts.size();
+}
@@ -0,0 +1,150 @@
+///////////////////////////////////////////////////////////////////////////////
+// drawstream.h
+// ============
+// record the uniform writes and mesh draws of the scene into a binary file
+// and replay them against an OpenGL context
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include "ShapeMeshes.h"
+
+#include <glm/glm.hpp>
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/***********************************************************
+ *  Draw stream file layout
+ *
+ *  The file starts with the four bytes "DSTR" and a 16-bit
+ *  version, followed by a list of commands.  Each command is
+ *  a one byte opcode and its operands, all little-endian:
+ *
+ *    NAME     u16 id, u8 length, characters
+ *    TEXTURE  u8 unit, u16 width, u16 height, u8 channels
+ *    FRAME    (no operands) - starts the next frame
+ *    INT      u16 name id, i32 value
+ *    FLOAT    u16 name id, f32 value
+ *    VEC2/3/4 u16 name id, 2/3/4 x f32
+ *    MAT4     u16 name id, 16 x f32 column-major
+ *    DRAW     u8 mesh type
+ *
+ *  Commands before the first FRAME are the scene setup, such
+ *  as the light uniforms and the texture loads.
+ ***********************************************************/
+namespace DrawStream
+{
+	const uint32_t FILE_MAGIC = 0x52545344; // "DSTR"
+	const uint16_t FILE_VERSION = 1;
+
+	enum OPCODE
+	{
+		OP_NAME = 0,
+		OP_TEXTURE,
+		OP_FRAME,
+		OP_INT,
+		OP_FLOAT,
+		OP_VEC2,
+		OP_VEC3,
+		OP_VEC4,
+		OP_MAT4,
+		OP_DRAW
+	};
+}
+
+/***********************************************************
+ *  DrawStreamRecorder
+ *
+ *  This class collects the commands in memory while the
+ *  scene is prepared and rendered, and saves them to a file.
+ ***********************************************************/
+class DrawStreamRecorder
+{
+public:
+	// constructor
+	DrawStreamRecorder();
+
+	// start the next frame of the stream
+	void BeginFrame();
+	// record a texture that was loaded into a texture unit
+	void RecordTexture(int unit, int width, int height, int channels);
+	// record a uniform write
+	void RecordInt(const char* name, int value);
+	void RecordFloat(const char* name, float value);
+	void RecordVec2(const char* name, const glm::vec2& value);
+	void RecordVec3(const char* name, const glm::vec3& value);
+	void RecordVec4(const char* name, const glm::vec4& value);
+	void RecordMat4(const char* name, const glm::mat4& value);
+	// record a draw of one of the basic meshes
+	void RecordDraw(int meshType);
+
+	// write the recorded stream to a file
+	bool Save(const std::string& filename) const;
+	int GetFrameCount() const { return(m_frameCount); }
+
+private:
+	// encoded commands
+	std::vector<unsigned char> m_stream;
+	// uniform names in the order their ids were given out
+	std::vector<std::string> m_names;
+	int m_frameCount;
+
+	// get the id of a uniform name, writing a NAME command the
+	// first time the name is seen
+	uint16_t NameID(const char* name);
+	// append raw bytes to the stream
+	void Write(const void* data, size_t size);
+	void WriteUniform(DrawStream::OPCODE op, const char* name, const float* values, int count);
+};
+
+/***********************************************************
+ *  DrawStreamPlayer
+ *
+ *  This class loads a recorded stream and issues its
+ *  commands straight to OpenGL.  The commands are decoded
+ *  once at load time with the uniform locations resolved, so
+ *  replaying a frame only walks a flat command array.
+ ***********************************************************/
+class DrawStreamPlayer
+{
+public:
+	// constructor
+	DrawStreamPlayer();
+	// destructor
+	~DrawStreamPlayer();
+
+	// load a stream - the replay shader program must be in use
+	bool Load(const std::string& filename);
+	// issue the setup commands once before the first frame
+	void ExecuteSetup();
+	// issue the next recorded frame, wrapping around at the end
+	void ExecuteFrame();
+	int GetFrameCount() const { return((int)m_frameStarts.size()); }
+
+private:
+	struct COMMAND
+	{
+		uint8_t op;
+		uint8_t mesh;
+		GLint location;
+		// index of the first value in the value array
+		uint32_t valueIndex;
+	};
+
+	// basic meshes drawn by the DRAW commands
+	ShapeMeshes* m_pMeshes;
+	// decoded commands and their values
+	std::vector<COMMAND> m_commands;
+	std::vector<float> m_values;
+	// index of the first command of each frame
+	std::vector<size_t> m_frameStarts;
+	// textures created for the TEXTURE commands
+	std::vector<GLuint> m_textures;
+	// frame that is replayed next
+	size_t m_nextFrame;
+
+	// issue the commands in the passed in range
+	void Execute(size_t first, size_t last);
+};
@@ -0,0 +1,274 @@
+///////////////////////////////////////////////////////////////////////////////
+// framepacing.cpp
+// ============
+// collect the frame-to-frame times and report how evenly frames are paced
+///////////////////////////////////////////////////////////////////////////////
+
+#include "FramePacing.h"
+
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <iostream>
+
+// declaration of global variables and helper functions
+namespace
+{
+	// how often the telemetry thread empties the ring
+	const int DRAIN_INTERVAL_MS = 50;
+
+	// width and number of the histogram bins, slower frames
+	// go into the overflow count
+	const double HISTOGRAM_BIN_MS = 1.0;
+	const int HISTOGRAM_BINS = 100;
+
+	// frames in each rolling 1% low window and the frames
+	// between the starts of two windows
+	const size_t ROLLING_WINDOW_FRAMES = 1000;
+	const size_t ROLLING_STEP_FRAMES = 100;
+
+	/***********************************************************
+	 *  OnePercentLowFps()
+	 *
+	 *  This function is used for getting the frame rate of the
+	 *  slowest 1% of the passed in frame times, at least one
+	 *  frame.  The values are partially sorted in place.
+	 ***********************************************************/
+	double OnePercentLowFps(std::vector<float>& frameMs)
+	{
+		if (frameMs.empty())
+		{
+			return(0.0);
+		}
+
+		size_t count = std::max<size_t>(frameMs.size() / 100, 1);
+		std::nth_element(frameMs.begin(), frameMs.begin() + (count - 1), frameMs.end(),
+			[](float a, float b) { return(a > b); });
+
+		double total = 0.0;
+		for (size_t i = 0; i < count; i++)
+		{
+			total += frameMs[i];
+		}
+		double meanMs = total / count;
+
+		return((meanMs > 0.0) ? 1000.0 / meanMs : 0.0);
+	}
+}
+
+/***********************************************************
+ *  FramePacing()
+ *
+ *  The constructor for the class
+ ***********************************************************/
+FramePacing::FramePacing()
+	: m_writeIndex(0), m_readIndex(0), m_droppedFrames(0), m_bRunning(false)
+{
+}
+
+/***********************************************************
+ *  ~FramePacing()
+ *
+ *  The destructor for the class
+ ***********************************************************/
+FramePacing::~FramePacing()
+{
+	Stop();
+}
+
+/***********************************************************
+ *  Start()
+ *
+ *  This method is used for starting the telemetry thread.
+ ***********************************************************/
+void FramePacing::Start()
+{
+	if (m_bRunning)
+	{
+		return;
+	}
+
+	m_bRunning = true;
+	m_thread = std::thread(&FramePacing::ThreadMain, this);
+}
+
+/***********************************************************
+ *  Stop()
+ *
+ *  This method is used for stopping the telemetry thread
+ *  after it has drained the last frame times.
+ ***********************************************************/
+void FramePacing::Stop()
+{
+	if (!m_bRunning)
+	{
+		return;
+	}
+
+	m_bRunning = false;
+	m_thread.join();
+}
+
+/***********************************************************
+ *  RecordFrame()
+ *
+ *  This method is used for adding one frame time to the
+ *  ring.  Only the render thread moves the write index, and
+ *  the release store publishes the value before the index.
+ ***********************************************************/
+void FramePacing::RecordFrame(float deltaSeconds)
+{
+	uint32_t writeIndex = m_writeIndex.load(std::memory_order_relaxed);
+	uint32_t readIndex = m_readIndex.load(std::memory_order_acquire);
+
+	if (writeIndex - readIndex == RING_SIZE)
+	{
+		m_droppedFrames.fetch_add(1, std::memory_order_relaxed);
+		return;
+	}
+
+	m_ring[writeIndex & (RING_SIZE - 1)] = deltaSeconds * 1000.0f;
+	m_writeIndex.store(writeIndex + 1, std::memory_order_release);
+}
+
+/***********************************************************
+ *  Drain()
+ *
+ *  This method is used for moving the frame times from the
+ *  ring into the sample list.  Only the telemetry thread
+ *  moves the read index.
+ ***********************************************************/
+void FramePacing::Drain()
+{
+	uint32_t readIndex = m_readIndex.load(std::memory_order_relaxed);
+	uint32_t writeIndex = m_writeIndex.load(std::memory_order_acquire);
+
+	while (readIndex != writeIndex)
+	{
+		m_samples.push_back(m_ring[readIndex & (RING_SIZE - 1)]);
+		readIndex++;
+	}
+
+	m_readIndex.store(readIndex, std::memory_order_release);
+}
+
+/***********************************************************
+ *  ThreadMain()
+ *
+ *  This method is used for draining the ring a few times a
+ *  second until the thread is stopped.
+ ***********************************************************/
+void FramePacing::ThreadMain()
+{
+	while (m_bRunning)
+	{
+		Drain();
+		std::this_thread::sleep_for(std::chrono::milliseconds(DRAIN_INTERVAL_MS));
+	}
+	Drain();
+}
+
+/***********************************************************
+ *  WriteReport()
+ *
+ *  This method is used for writing the pacing report to the
+ *  passed in file path, or to stdout if the path is a single
+ *  dash.
+ ***********************************************************/
+bool FramePacing::WriteReport(const std::string& reportPath) const
+{
+	if (reportPath == "-")
+	{
+		WriteReportJSON(std::cout);
+		return(true);
+	}
+
+	std::ofstream file(reportPath.c_str());
+	if (!file.is_open())
+	{
+		std::cerr << "Could not open frame pacing report file:" << reportPath << std::endl;
+		return(false);
+	}
+
+	WriteReportJSON(file);
+	return(file.good());
+}
+
+/***********************************************************
+ *  WriteReportJSON()
+ *
+ *  This method is used for writing the pacing statistics of
+ *  the drained frame times as a JSON document.
+ ***********************************************************/
+void FramePacing::WriteReportJSON(std::ostream& out) const
+{
+	std::vector<float> sorted = m_samples;
+	std::sort(sorted.begin(), sorted.end());
+
+	double total = 0.0;
+	for (size_t i = 0; i < sorted.size(); i++)
+	{
+		total += sorted[i];
+	}
+	double meanMs = sorted.empty() ? 0.0 : total / sorted.size();
+	double medianMs = sorted.empty() ? 0.0 : sorted[sorted.size() / 2];
+	double p99Ms = sorted.empty() ? 0.0 : sorted[std::min(sorted.size() - 1, sorted.size() * 99 / 100)];
+
+	// a stutter is a frame that takes more than twice the median
+	double stutterMs = medianMs * 2.0;
+	size_t stutters = 0;
+	std::vector<uint32_t> histogram(HISTOGRAM_BINS, 0);
+	uint32_t overflow = 0;
+	for (size_t i = 0; i < m_samples.size(); i++)
+	{
+		if (m_samples[i] > stutterMs)
+		{
+			stutters++;
+		}
+
+		int bin = (int)(m_samples[i] / HISTOGRAM_BIN_MS);
+		if (bin < HISTOGRAM_BINS)
+		{
+			histogram[bin]++;
+		}
+		else
+		{
+			overflow++;
+		}
+	}
+
+	std::vector<float> window;
+	std::vector<double> rolling;
+	for (size_t start = 0; start + ROLLING_WINDOW_FRAMES <= m_samples.size(); start += ROLLING_STEP_FRAMES)
+	{
+		window.assign(m_samples.begin() + start, m_samples.begin() + start + ROLLING_WINDOW_FRAMES);
+		rolling.push_back(OnePercentLowFps(window));
+	}
+	std::vector<float> all = m_samples;
+
+	out << "{\n";
+	out << "  \"frames\": " << m_samples.size() << ",\n";
+	out << "  \"dropped_frames\": " << m_droppedFrames.load() << ",\n";
+	out << "  \"mean_ms\": " << meanMs << ",\n";
+	out << "  \"median_ms\": " << medianMs << ",\n";
+	out << "  \"p99_ms\": " << p99Ms << ",\n";
+	out << "  \"one_percent_low_fps\": " << OnePercentLowFps(all) << ",\n";
+	out << "  \"stutter_threshold_ms\": " << stutterMs << ",\n";
+	out << "  \"stutters\": " << stutters << ",\n";
+	out << "  \"histogram\": { \"bin_ms\": " << HISTOGRAM_BIN_MS << ", \"overflow\": " << overflow << ", \"counts\": [";
+	for (int i = 0; i < HISTOGRAM_BINS; i++)
+	{
+		out << ((i > 0) ? ", " : "") << histogram[i];
+	}
+	out << "] },\n";
+	out << "  \"rolling_one_percent_low_fps\": { \"window_frames\": " << ROLLING_WINDOW_FRAMES
+		<< ", \"step_frames\": " << ROLLING_STEP_FRAMES
+		<< ", \"min\": " << (rolling.empty() ? 0.0 : *std::min_element(rolling.begin(), rolling.end()))
+		<< ", \"values\": [";
+	for (size_t i = 0; i < rolling.size(); i++)
+	{
+		out << ((i > 0) ? ", " : "") << rolling[i];
+	}
+	out << "] }\n";
+	out << "}" << std::endl;
+}
@@ -0,0 +1,68 @@
+///////////////////////////////////////////////////////////////////////////////
+// framepacing.h
+// ============
+// collect the frame-to-frame times and report how evenly frames are paced
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+/***********************************************************
+ *  FramePacing
+ *
+ *  This class receives the time between frames from the
+ *  render thread through a fixed size lock-free ring buffer.
+ *  A telemetry thread drains the ring into the sample list,
+ *  so the render thread never waits or allocates.  The report
+ *  holds a frame time histogram, the stutters (frames taking
+ *  more than twice the median) and the 1% low frame rate
+ *  over the whole run and over a rolling window.
+ ***********************************************************/
+class FramePacing
+{
+public:
+	// constructor
+	FramePacing();
+	// destructor
+	~FramePacing();
+
+	// start and stop the telemetry thread
+	void Start();
+	void Stop();
+
+	// add one frame time - called on the render thread only
+	void RecordFrame(float deltaSeconds);
+
+	// write the JSON pacing report - the thread must be stopped
+	bool WriteReport(const std::string& reportPath) const;
+
+private:
+	// number of frame times the ring holds, a power of two
+	static const uint32_t RING_SIZE = 4096;
+
+	// ring buffer written by the render thread and read by the
+	// telemetry thread, each index only moves forward
+	float m_ring[RING_SIZE];
+	std::atomic<uint32_t> m_writeIndex;
+	std::atomic<uint32_t> m_readIndex;
+	// frame times that did not fit into a full ring
+	std::atomic<uint32_t> m_droppedFrames;
+
+	std::thread m_thread;
+	std::atomic<bool> m_bRunning;
+	// drained frame times in milliseconds
+	std::vector<float> m_samples;
+
+	// move everything in the ring into the sample list
+	void Drain();
+	// telemetry thread body
+	void ThreadMain();
+	// write the JSON report into the passed in stream
+	void WriteReportJSON(std::ostream& out) const;
+};
@@ -0,0 +1,334 @@
+///////////////////////////////////////////////////////////////////////////////
+// frameprofiler.cpp
+// ============
+// record CPU and GPU timings of named code zones and export a Chrome trace
+///////////////////////////////////////////////////////////////////////////////
+
+#include "FrameProfiler.h"
+#include "Logger.h"
+
+#include <chrono>
+#include <fstream>
+
+// declaration of global variables
+namespace
+{
+	// number of frames the GPU queries may lag behind the CPU
+	const int FRAME_LATENCY = 4;
+	// most zones recorded in a single frame
+	const int MAX_ZONES_PER_FRAME = 256;
+}
+
+/***********************************************************
+ *  Instance()
+ *
+ *  This method is used for getting the single profiler
+ *  object that all of the zones are recorded into.
+ ***********************************************************/
+FrameProfiler& FrameProfiler::Instance()
+{
+	static FrameProfiler profiler;
+	return(profiler);
+}
+
+/***********************************************************
+ *  FrameProfiler()
+ *
+ *  The constructor for the class
+ ***********************************************************/
+FrameProfiler::FrameProfiler()
+{
+	m_bEnabled = false;
+	m_bDumpRequested = false;
+	m_depth = 0;
+	m_frameNumber = 0;
+	m_startNs = 0;
+	m_gpuToCpuNs = 0;
+	m_droppedZones = 0;
+	m_writtenZones = 0;
+}
+
+/***********************************************************
+ *  ~FrameProfiler()
+ *
+ *  The destructor for the class
+ ***********************************************************/
+FrameProfiler::~FrameProfiler()
+{
+	m_bEnabled = false;
+}
+
+/***********************************************************
+ *  CpuNowNs()
+ *
+ *  This method is used for getting the current CPU time in
+ *  nanoseconds.
+ ***********************************************************/
+int64_t FrameProfiler::CpuNowNs()
+{
+	return(std::chrono::duration_cast<std::chrono::nanoseconds>(
+		std::chrono::steady_clock::now().time_since_epoch()).count());
+}
+
+/***********************************************************
+ *  Enable()
+ *
+ *  This method is used for opening the trace file, creating
+ *  the zone ring and the GPU query pool, and measuring the
+ *  offset between the GPU and CPU clocks.  The trace uses
+ *  the JSON array format, which the trace viewers also read
+ *  when it is cut off before its closing bracket.
+ ***********************************************************/
+bool FrameProfiler::Enable(const std::string& traceFile)
+{
+	if (m_bEnabled)
+	{
+		return(true);
+	}
+
+	m_traceFile.open(traceFile.c_str());
+	if (!m_traceFile.is_open())
+	{
+		LOG_ERROR("Could not write profiler trace:%s", traceFile.c_str());
+		return(false);
+	}
+	m_traceFilename = traceFile;
+	m_traceFile.setf(std::ios::fixed);
+	m_traceFile.precision(3);
+	m_traceFile << "[\n";
+	m_traceFile << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":1,\"args\":{\"name\":\"CPU\"}},\n";
+	m_traceFile << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":2,\"args\":{\"name\":\"GPU\"}}";
+
+	m_frames.resize(FRAME_LATENCY);
+	for (int i = 0; i < FRAME_LATENCY; i++)
+	{
+		m_frames[i].zoneCount = 0;
+		m_frames[i].zones.resize(MAX_ZONES_PER_FRAME);
+		m_frames[i].ended.assign(MAX_ZONES_PER_FRAME, 0);
+		m_frames[i].queries.resize(MAX_ZONES_PER_FRAME * 2);
+		glGenQueries(MAX_ZONES_PER_FRAME * 2, m_frames[i].queries.data());
+	}
+
+	// both clocks are sampled back to back to line up the GPU
+	// zones with the CPU zones in the trace
+	GLint64 gpuNow = 0;
+	glGetInteger64v(GL_TIMESTAMP, &gpuNow);
+	m_startNs = CpuNowNs();
+	m_gpuToCpuNs = m_startNs - gpuNow;
+
+	m_depth = 0;
+	m_frameNumber = 0;
+	m_droppedZones = 0;
+	m_writtenZones = 0;
+	m_bEnabled = true;
+
+	return(true);
+}
+
+/***********************************************************
+ *  Disable()
+ *
+ *  This method is used for writing the pending frames,
+ *  closing the trace file and freeing the GPU query pool
+ *  and the zone ring.
+ ***********************************************************/
+void FrameProfiler::Disable()
+{
+	if (!m_bEnabled)
+	{
+		return;
+	}
+
+	FlushTrace();
+	m_traceFile << "\n]\n";
+	m_traceFile.close();
+
+	for (size_t i = 0; i < m_frames.size(); i++)
+	{
+		glDeleteQueries((GLsizei)m_frames[i].queries.size(), m_frames[i].queries.data());
+	}
+	m_frames.clear();
+	m_bEnabled = false;
+}
+
+/***********************************************************
+ *  ResolveFrame()
+ *
+ *  This method is used for copying the GPU timestamps of a
+ *  finished frame into its zones and appending the zones to
+ *  the trace file.  Unless waiting is asked for, the GPU
+ *  timings are only read when every query that was issued
+ *  for the frame has its result, and are left out of the
+ *  trace otherwise.  A zone that was still open has no end
+ *  query and no GPU timing.
+ ***********************************************************/
+void FrameProfiler::ResolveFrame(FRAME_QUERIES& frame, bool bWait)
+{
+	if (frame.zoneCount == 0)
+	{
+		return;
+	}
+
+	bool bAvailable = true;
+	for (int i = 0; (i < frame.zoneCount) && !bWait && bAvailable; i++)
+	{
+		GLuint available = GL_FALSE;
+		glGetQueryObjectuiv(frame.queries[i * 2], GL_QUERY_RESULT_AVAILABLE, &available);
+		if ((available == GL_TRUE) && (frame.ended[i] != 0))
+		{
+			glGetQueryObjectuiv(frame.queries[i * 2 + 1], GL_QUERY_RESULT_AVAILABLE, &available);
+		}
+		bAvailable = (available == GL_TRUE);
+	}
+
+	for (int i = 0; i < frame.zoneCount; i++)
+	{
+		ZONE_EVENT& zone = frame.zones[i];
+		if (bAvailable && (frame.ended[i] != 0))
+		{
+			GLuint64 beginTime = 0;
+			GLuint64 endTime = 0;
+			glGetQueryObjectui64v(frame.queries[i * 2], GL_QUERY_RESULT, &beginTime);
+			glGetQueryObjectui64v(frame.queries[i * 2 + 1], GL_QUERY_RESULT, &endTime);
+			zone.gpuBeginNs = (int64_t)beginTime + m_gpuToCpuNs;
+			zone.gpuEndNs = (int64_t)endTime + m_gpuToCpuNs;
+			zone.bGpuValid = true;
+		}
+
+		m_traceFile << ",\n{\"name\":\"" << zone.name << "\",\"ph\":\"X\",\"pid\":1,\"tid\":1"
+			<< ",\"ts\":" << (zone.cpuBeginNs - m_startNs) / 1000.0
+			<< ",\"dur\":" << (zone.cpuEndNs - zone.cpuBeginNs) / 1000.0 << "}";
+
+		if (zone.bGpuValid)
+		{
+			m_traceFile << ",\n{\"name\":\"" << zone.name << "\",\"ph\":\"X\",\"pid\":1,\"tid\":2"
+				<< ",\"ts\":" << (zone.gpuBeginNs - m_startNs) / 1000.0
+				<< ",\"dur\":" << (zone.gpuEndNs - zone.gpuBeginNs) / 1000.0 << "}";
+		}
+		frame.ended[i] = 0;
+	}
+
+	m_writtenZones += frame.zoneCount;
+	frame.zoneCount = 0;
+}
+
+/***********************************************************
+ *  BeginFrame()
+ *
+ *  This method is used for starting a new frame.  The ring
+ *  region of the frame that was recorded FRAME_LATENCY
+ *  frames ago is written out and then reused.
+ ***********************************************************/
+void FrameProfiler::BeginFrame()
+{
+	if (!m_bEnabled)
+	{
+		return;
+	}
+
+	ResolveFrame(m_frames[m_frameNumber % FRAME_LATENCY], false);
+}
+
+/***********************************************************
+ *  EndFrame()
+ *
+ *  This method is used for finishing the current frame.
+ ***********************************************************/
+void FrameProfiler::EndFrame()
+{
+	if (!m_bEnabled)
+	{
+		return;
+	}
+
+	m_frameNumber++;
+}
+
+/***********************************************************
+ *  BeginZone()
+ *
+ *  This method is used for opening a named zone in the
+ *  current frame's region and issuing its begin query.  The
+ *  index of the zone in the ring is returned, or -1 when the
+ *  profiler is off or the region is full.
+ ***********************************************************/
+int FrameProfiler::BeginZone(const char* name)
+{
+	if (!m_bEnabled)
+	{
+		return(-1);
+	}
+
+	int frameIndex = (int)(m_frameNumber % FRAME_LATENCY);
+	FRAME_QUERIES& frame = m_frames[frameIndex];
+	if (frame.zoneCount == MAX_ZONES_PER_FRAME)
+	{
+		m_droppedZones++;
+		return(-1);
+	}
+
+	int frameZone = frame.zoneCount++;
+	ZONE_EVENT& zone = frame.zones[frameZone];
+	zone.name = name;
+	zone.depth = m_depth;
+	zone.cpuBeginNs = CpuNowNs();
+	zone.cpuEndNs = zone.cpuBeginNs;
+	zone.gpuBeginNs = 0;
+	zone.gpuEndNs = 0;
+	zone.bGpuValid = false;
+	m_depth++;
+
+	glQueryCounter(frame.queries[frameZone * 2], GL_TIMESTAMP);
+
+	return(frameIndex * MAX_ZONES_PER_FRAME + frameZone);
+}
+
+/***********************************************************
+ *  EndZone()
+ *
+ *  This method is used for closing the zone that was opened
+ *  with the passed in index and issuing its end query.
+ ***********************************************************/
+void FrameProfiler::EndZone(int zoneIndex)
+{
+	if ((!m_bEnabled) || (zoneIndex < 0))
+	{
+		return;
+	}
+
+	FRAME_QUERIES& frame = m_frames[zoneIndex / MAX_ZONES_PER_FRAME];
+	int frameZone = zoneIndex % MAX_ZONES_PER_FRAME;
+	frame.zones[frameZone].cpuEndNs = CpuNowNs();
+	m_depth--;
+
+	glQueryCounter(frame.queries[frameZone * 2 + 1], GL_TIMESTAMP);
+	frame.ended[frameZone] = 1;
+}
+
+/***********************************************************
+ *  FlushTrace()
+ *
+ *  This method is used for waiting on the frames whose zones
+ *  are not written yet, oldest first, and writing them, so
+ *  that the trace file is complete up to now.
+ ***********************************************************/
+bool FrameProfiler::FlushTrace()
+{
+	m_bDumpRequested = false;
+
+	if (!m_bEnabled)
+	{
+		return(false);
+	}
+
+	for (int i = 0; i < FRAME_LATENCY; i++)
+	{
+		ResolveFrame(m_frames[(m_frameNumber + i) % FRAME_LATENCY], true);
+	}
+	m_traceFile.flush();
+
+	LOG_INFO("Wrote profiler trace:%s, zones:%llu, dropped:%llu", m_traceFilename.c_str(),
+		(unsigned long long)m_writtenZones, (unsigned long long)m_droppedZones);
+
+	return(m_traceFile.good());
+}
@@ -0,0 +1,138 @@
+///////////////////////////////////////////////////////////////////////////////
+// frameprofiler.h
+// ============
+// record CPU and GPU timings of named code zones and export a Chrome trace
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <GL/glew.h>
+
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <vector>
+
+/***********************************************************
+ *  FrameProfiler
+ *
+ *  This class records the CPU time and, through GL_TIMESTAMP
+ *  queries, the GPU time of named zones.  The zones of the
+ *  last few frames are kept in a fixed ring, one region per
+ *  frame, and when a frame's region is reused its zones are
+ *  appended to a chrome://tracing / Perfetto JSON trace
+ *  file, with the GPU timings only when every query of the
+ *  frame has finished, so the GPU is never waited on.  While
+ *  the profiler is not enabled every call returns
+ *  immediately.
+ ***********************************************************/
+class FrameProfiler
+{
+public:
+	// get the single profiler instance
+	static FrameProfiler& Instance();
+
+	// enable the profiler and start the trace file - needs a
+	// current OpenGL context
+	bool Enable(const std::string& traceFile);
+	// write the pending frames, finish the trace file and free
+	// the GPU queries
+	void Disable();
+	bool IsEnabled() const { return(m_bEnabled); }
+
+	// mark the frame boundaries so that older queries get resolved
+	void BeginFrame();
+	void EndFrame();
+
+	// open and close a named zone - the name must be a literal
+	int BeginZone(const char* name);
+	void EndZone(int zoneIndex);
+
+	// ask the main loop to flush the trace at the end of the frame
+	void RequestDump() { m_bDumpRequested = true; }
+	bool IsDumpRequested() const { return(m_bDumpRequested); }
+
+	// wait for the frames that are still pending and write them
+	// to the trace file, so that it holds every frame so far
+	bool FlushTrace();
+
+private:
+	// constructor
+	FrameProfiler();
+	// destructor
+	~FrameProfiler();
+
+	struct ZONE_EVENT
+	{
+		const char* name;
+		int depth;
+		int64_t cpuBeginNs;
+		int64_t cpuEndNs;
+		int64_t gpuBeginNs;
+		int64_t gpuEndNs;
+		bool bGpuValid;
+	};
+
+	// the zones of one frame and their queries - zone i has the
+	// begin and end queries i * 2 and i * 2 + 1
+	struct FRAME_QUERIES
+	{
+		int zoneCount;
+		std::vector<ZONE_EVENT> zones;
+		std::vector<GLuint> queries;
+		// the end query of the zone was issued
+		std::vector<unsigned char> ended;
+	};
+
+	bool m_bEnabled;
+	bool m_bDumpRequested;
+	// current nesting depth of the open zones
+	int m_depth;
+	// number of the frame that is being recorded
+	uint64_t m_frameNumber;
+	// CPU time that the trace timestamps are relative to
+	int64_t m_startNs;
+	// offset that converts GPU timestamps into CPU time
+	int64_t m_gpuToCpuNs;
+	// the frames whose zones are not written yet
+	std::vector<FRAME_QUERIES> m_frames;
+	// zones left out because their frame's region was full
+	uint64_t m_droppedZones;
+	std::ofstream m_traceFile;
+	std::string m_traceFilename;
+	uint64_t m_writtenZones;
+
+	// get the current CPU time in nanoseconds
+	static int64_t CpuNowNs();
+	// read back the GPU timings of one frame, if every one of its
+	// queries has finished or waiting is asked for, and write its
+	// zones to the trace file
+	void ResolveFrame(FRAME_QUERIES& frame, bool bWait);
+};
+
+/***********************************************************
+ *  ProfileZone
+ *
+ *  This class opens a profiler zone when it is constructed
+ *  and closes it again when it goes out of scope.
+ ***********************************************************/
+class ProfileZone
+{
+public:
+	explicit ProfileZone(const char* name)
+	{
+		m_zoneIndex = FrameProfiler::Instance().BeginZone(name);
+	}
+	~ProfileZone()
+	{
+		FrameProfiler::Instance().EndZone(m_zoneIndex);
+	}
+
+private:
+	int m_zoneIndex;
+};
+
+#define PROFILE_ZONE_CONCAT2(a, b) a##b
+#define PROFILE_ZONE_CONCAT(a, b) PROFILE_ZONE_CONCAT2(a, b)
+// profile the rest of the enclosing scope under the passed in name
+#define PROFILE_ZONE(name) ProfileZone PROFILE_ZONE_CONCAT(profileZone, __LINE__)(name)
@@ -0,0 +1,233 @@
+///////////////////////////////////////////////////////////////////////////////
+// headlesscontext.cpp
+// ============
+// create an offscreen OpenGL context that needs no GPU or display
+///////////////////////////////////////////////////////////////////////////////
+
+#include "HeadlessContext.h"
+
+#include <iostream>
+#include <cstring>
+
+#ifdef __linux__
+#include <EGL/eglext.h>
+#endif
+
+/***********************************************************
+ *  HeadlessContext()
+ *
+ *  The constructor for the class
+ ***********************************************************/
+HeadlessContext::HeadlessContext()
+{
+	m_width = 0;
+	m_height = 0;
+	m_framebuffer = 0;
+	m_colorBuffer = 0;
+	m_depthBuffer = 0;
+#ifdef __linux__
+	m_display = EGL_NO_DISPLAY;
+	m_context = EGL_NO_CONTEXT;
+	m_surface = EGL_NO_SURFACE;
+#else
+	m_pWindow = NULL;
+#endif
+}
+
+/***********************************************************
+ *  ~HeadlessContext()
+ *
+ *  The destructor for the class
+ ***********************************************************/
+HeadlessContext::~HeadlessContext()
+{
+	Destroy();
+}
+
+#ifdef __linux__
+/***********************************************************
+ *  Create()
+ *
+ *  This method is used for creating a surfaceless EGL
+ *  context.  The Mesa surfaceless platform is preferred so
+ *  that no display server is needed, and a small pbuffer is
+ *  used when the driver lacks surfaceless context support.
+ ***********************************************************/
+bool HeadlessContext::Create(int width, int height)
+{
+	m_width = width;
+	m_height = height;
+
+	// prefer the Mesa surfaceless platform when it is available
+	PFNEGLGETPLATFORMDISPLAYEXTPROC getPlatformDisplay =
+		(PFNEGLGETPLATFORMDISPLAYEXTPROC)eglGetProcAddress("eglGetPlatformDisplayEXT");
+	if (NULL != getPlatformDisplay)
+	{
+		m_display = getPlatformDisplay(EGL_PLATFORM_SURFACELESS_MESA, EGL_DEFAULT_DISPLAY, NULL);
+	}
+	if (EGL_NO_DISPLAY == m_display)
+	{
+		m_display = eglGetDisplay(EGL_DEFAULT_DISPLAY);
+	}
+	if ((EGL_NO_DISPLAY == m_display) || (eglInitialize(m_display, NULL, NULL) == EGL_FALSE))
+	{
+		std::cerr << "Failed to initialize the EGL display" << std::endl;
+		return(false);
+	}
+
+	const EGLint configAttributes[] = {
+		EGL_SURFACE_TYPE, EGL_PBUFFER_BIT,
+		EGL_RENDERABLE_TYPE, EGL_OPENGL_BIT,
+		EGL_RED_SIZE, 8,
+		EGL_GREEN_SIZE, 8,
+		EGL_BLUE_SIZE, 8,
+		EGL_DEPTH_SIZE, 24,
+		EGL_NONE };
+	EGLConfig config = NULL;
+	EGLint configCount = 0;
+	if ((eglChooseConfig(m_display, configAttributes, &config, 1, &configCount) == EGL_FALSE) ||
+		(configCount == 0))
+	{
+		std::cerr << "Failed to find a suitable EGL config" << std::endl;
+		return(false);
+	}
+
+	eglBindAPI(EGL_OPENGL_API);
+
+	// the shaders are written for GLSL 3.30 core
+	const EGLint contextAttributes[] = {
+		EGL_CONTEXT_MAJOR_VERSION, 3,
+		EGL_CONTEXT_MINOR_VERSION, 3,
+		EGL_CONTEXT_OPENGL_PROFILE_MASK, EGL_CONTEXT_OPENGL_CORE_PROFILE_BIT,
+		EGL_NONE };
+	m_context = eglCreateContext(m_display, config, EGL_NO_CONTEXT, contextAttributes);
+	if (EGL_NO_CONTEXT == m_context)
+	{
+		std::cerr << "Failed to create the EGL context" << std::endl;
+		return(false);
+	}
+
+	// rendering goes to a framebuffer object, so the surface is
+	// only needed for drivers without surfaceless contexts
+	const char* extensions = eglQueryString(m_display, EGL_EXTENSIONS);
+	if ((NULL == extensions) || (strstr(extensions, "EGL_KHR_surfaceless_context") == NULL))
+	{
+		const EGLint surfaceAttributes[] = { EGL_WIDTH, 1, EGL_HEIGHT, 1, EGL_NONE };
+		m_surface = eglCreatePbufferSurface(m_display, config, surfaceAttributes);
+	}
+
+	if (eglMakeCurrent(m_display, m_surface, m_surface, m_context) == EGL_FALSE)
+	{
+		std::cerr << "Failed to make the EGL context current" << std::endl;
+		return(false);
+	}
+
+	return(true);
+}
+#else
+/***********************************************************
+ *  Create()
+ *
+ *  This method is used for creating a hidden GLFW window
+ *  that provides the OpenGL context.  GLFW must already be
+ *  initialized.
+ ***********************************************************/
+bool HeadlessContext::Create(int width, int height)
+{
+	m_width = width;
+	m_height = height;
+
+	glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
+	m_pWindow = glfwCreateWindow(width, height, "headless", NULL, NULL);
+	if (m_pWindow == NULL)
+	{
+		std::cerr << "Failed to create hidden GLFW window" << std::endl;
+		return(false);
+	}
+	glfwMakeContextCurrent(m_pWindow);
+
+	return(true);
+}
+#endif
+
+/***********************************************************
+ *  CreateFramebuffer()
+ *
+ *  This method is used for creating the offscreen color and
+ *  depth render targets and binding them for drawing.  The
+ *  same global state as CreateDisplayWindow() is enabled so
+ *  that the render output matches the interactive loop.
+ ***********************************************************/
+bool HeadlessContext::CreateFramebuffer()
+{
+	glGenRenderbuffers(1, &m_colorBuffer);
+	glBindRenderbuffer(GL_RENDERBUFFER, m_colorBuffer);
+	glRenderbufferStorage(GL_RENDERBUFFER, GL_RGBA8, m_width, m_height);
+
+	glGenRenderbuffers(1, &m_depthBuffer);
+	glBindRenderbuffer(GL_RENDERBUFFER, m_depthBuffer);
+	glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH_COMPONENT24, m_width, m_height);
+
+	glGenFramebuffers(1, &m_framebuffer);
+	glBindFramebuffer(GL_FRAMEBUFFER, m_framebuffer);
+	glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, m_colorBuffer);
+	glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_RENDERBUFFER, m_depthBuffer);
+
+	if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE)
+	{
+		std::cerr << "Offscreen framebuffer is incomplete" << std::endl;
+		return(false);
+	}
+
+	glViewport(0, 0, m_width, m_height);
+
+	// enable blending for supporting tranparent rendering
+	glEnable(GL_BLEND);
+	glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+
+	return(true);
+}
+
+/***********************************************************
+ *  Destroy()
+ *
+ *  This method is used for freeing the offscreen render
+ *  targets and the OpenGL context.
+ ***********************************************************/
+void HeadlessContext::Destroy()
+{
+	if (0 != m_framebuffer)
+	{
+		glDeleteFramebuffers(1, &m_framebuffer);
+		glDeleteRenderbuffers(1, &m_colorBuffer);
+		glDeleteRenderbuffers(1, &m_depthBuffer);
+		m_framebuffer = 0;
+		m_colorBuffer = 0;
+		m_depthBuffer = 0;
+	}
+
+#ifdef __linux__
+	if (EGL_NO_DISPLAY != m_display)
+	{
+		eglMakeCurrent(m_display, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
+		if (EGL_NO_SURFACE != m_surface)
+		{
+			eglDestroySurface(m_display, m_surface);
+		}
+		if (EGL_NO_CONTEXT != m_context)
+		{
+			eglDestroyContext(m_display, m_context);
+		}
+		eglTerminate(m_display);
+		m_display = EGL_NO_DISPLAY;
+		m_context = EGL_NO_CONTEXT;
+		m_surface = EGL_NO_SURFACE;
+	}
+#else
+	if (NULL != m_pWindow)
+	{
+		glfwDestroyWindow(m_pWindow);
+		m_pWindow = NULL;
+	}
+#endif
+}
@@ -0,0 +1,61 @@
+///////////////////////////////////////////////////////////////////////////////
+// headlesscontext.h
+// ============
+// create an offscreen OpenGL context that needs no GPU or display
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <GL/glew.h>
+
+#ifdef __linux__
+#include <EGL/egl.h>
+#else
+#include "GLFW/glfw3.h"
+#endif
+
+/***********************************************************
+ *  HeadlessContext
+ *
+ *  This class creates an OpenGL 3.3 core context without a
+ *  visible window.  On Linux a surfaceless EGL context is
+ *  used so that the render path runs on Mesa llvmpipe with
+ *  no GPU or display server.  On other platforms a hidden
+ *  GLFW window provides the context.  Rendering targets an
+ *  offscreen framebuffer object of the requested size.
+ ***********************************************************/
+class HeadlessContext
+{
+public:
+	// constructor
+	HeadlessContext();
+	// destructor
+	~HeadlessContext();
+
+	// create the context and make it current on this thread
+	bool Create(int width, int height);
+	// create the offscreen framebuffer - needs GLEW initialized
+	bool CreateFramebuffer();
+	// free the framebuffer and the context
+	void Destroy();
+
+	int GetWidth() const { return(m_width); }
+	int GetHeight() const { return(m_height); }
+
+private:
+	// size of the offscreen framebuffer
+	int m_width;
+	int m_height;
+	// offscreen render target objects
+	GLuint m_framebuffer;
+	GLuint m_colorBuffer;
+	GLuint m_depthBuffer;
+
+#ifdef __linux__
+	EGLDisplay m_display;
+	EGLContext m_context;
+	EGLSurface m_surface;
+#else
+	GLFWwindow* m_pWindow;
+#endif
+};
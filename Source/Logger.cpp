@@ -0,0 +1,279 @@
+///////////////////////////////////////////////////////////////////////////////
+// logger.cpp
+// ============
+// format log messages into a lock-free ring that a background thread writes out
+///////////////////////////////////////////////////////////////////////////////
+
+#include "Logger.h"
+
+#include <cstdarg>
+#include <cstdio>
+
+/***********************************************************
+ *  Instance()
+ *
+ *  This method is used for getting the single logger that
+ *  all of the messages are queued into.
+ ***********************************************************/
+Logger& Logger::Instance()
+{
+	static Logger logger;
+	return(logger);
+}
+
+/***********************************************************
+ *  Logger()
+ *
+ *  The constructor for the class
+ ***********************************************************/
+Logger::Logger()
+	: m_enqueueIndex(0), m_dequeueIndex(0), m_droppedMessages(0), m_bRunning(false),
+	m_activeWriters(0), m_bWriterWaiting(false)
+{
+	// every slot starts out free for the turn that matches its index
+	for (uint32_t i = 0; i < RING_SIZE; i++)
+	{
+		m_ring[i].sequence.store(i, std::memory_order_relaxed);
+	}
+}
+
+/***********************************************************
+ *  ~Logger()
+ *
+ *  The destructor for the class - runs at exit, so messages
+ *  queued just before the application ends are written out.
+ ***********************************************************/
+Logger::~Logger()
+{
+	Stop();
+}
+
+/***********************************************************
+ *  Start()
+ *
+ *  This method is used for starting the writer thread.
+ ***********************************************************/
+void Logger::Start()
+{
+	if (m_bRunning)
+	{
+		return;
+	}
+
+	m_bRunning = true;
+	m_thread = std::thread(&Logger::ThreadMain, this);
+}
+
+/***********************************************************
+ *  Stop()
+ *
+ *  This method is used for stopping the writer thread once
+ *  it has written out the queued messages.  A producer that
+ *  saw the thread running may still be writing its message
+ *  into the ring, so the ring is drained once more after the
+ *  thread has ended, until every producer has left Write().
+ ***********************************************************/
+void Logger::Stop()
+{
+	if (!m_bRunning)
+	{
+		return;
+	}
+
+	{
+		std::lock_guard<std::mutex> lock(m_wakeMutex);
+		m_bRunning = false;
+	}
+	m_wake.notify_one();
+	m_thread.join();
+
+	while ((m_activeWriters.load() > 0) || HasMessage())
+	{
+		if (Drain() == false)
+		{
+			std::this_thread::yield();
+		}
+	}
+}
+
+/***********************************************************
+ *  Write()
+ *
+ *  This method is used for formatting a message into the
+ *  next free slot of the ring.  A producer claims a slot by
+ *  moving the enqueue index on with a compare-and-swap, and
+ *  publishes the message by advancing the slot's sequence.
+ *  The producer is counted as active from before it checks
+ *  that the writer thread is running until it is done, so
+ *  Stop() can wait for its message.
+ ***********************************************************/
+void Logger::Write(LEVEL level, const char* format, ...)
+{
+	va_list args;
+
+	m_activeWriters.fetch_add(1);
+
+	// without the writer thread the message goes straight out
+	if (!m_bRunning)
+	{
+		char text[MAX_MESSAGE_LENGTH];
+		va_start(args, format);
+		vsnprintf(text, sizeof(text), format, args);
+		va_end(args);
+		Output(level, text);
+		m_activeWriters.fetch_sub(1);
+		return;
+	}
+
+	SLOT* pSlot = NULL;
+	uint32_t index = m_enqueueIndex.load(std::memory_order_relaxed);
+	while (NULL == pSlot)
+	{
+		SLOT& slot = m_ring[index & (RING_SIZE - 1)];
+		uint32_t sequence = slot.sequence.load(std::memory_order_acquire);
+		int32_t difference = (int32_t)(sequence - index);
+
+		if (difference == 0)
+		{
+			// the slot is free for this turn, try to claim it
+			if (m_enqueueIndex.compare_exchange_weak(index, index + 1, std::memory_order_relaxed))
+			{
+				pSlot = &slot;
+			}
+		}
+		else if (difference < 0)
+		{
+			// the slot still holds a message from the last lap
+			m_droppedMessages.fetch_add(1, std::memory_order_relaxed);
+			m_activeWriters.fetch_sub(1);
+			return;
+		}
+		else
+		{
+			// another producer claimed it first
+			index = m_enqueueIndex.load(std::memory_order_relaxed);
+		}
+	}
+
+	pSlot->level = level;
+	va_start(args, format);
+	vsnprintf(pSlot->text, sizeof(pSlot->text), format, args);
+	va_end(args);
+
+	pSlot->sequence.store(index + 1, std::memory_order_release);
+	WakeWriter();
+	m_activeWriters.fetch_sub(1);
+}
+
+/***********************************************************
+ *  WakeWriter()
+ *
+ *  This method is used for waking the writer thread after a
+ *  message was published.  The fence pairs with the one in
+ *  ThreadMain(): either the writer sees the message before
+ *  it waits, or the producer sees it waiting and notifies
+ *  it under the mutex, so a wakeup cannot be lost.  While the
+ *  writer is busy the mutex is not touched.
+ ***********************************************************/
+void Logger::WakeWriter()
+{
+	std::atomic_thread_fence(std::memory_order_seq_cst);
+	if (m_bWriterWaiting.load(std::memory_order_relaxed))
+	{
+		std::lock_guard<std::mutex> lock(m_wakeMutex);
+		m_wake.notify_one();
+	}
+}
+
+/***********************************************************
+ *  HasMessage()
+ *
+ *  This method is used for checking whether the message at
+ *  the dequeue index has been published.
+ ***********************************************************/
+bool Logger::HasMessage() const
+{
+	uint32_t index = m_dequeueIndex.load(std::memory_order_relaxed);
+	uint32_t sequence = m_ring[index & (RING_SIZE - 1)].sequence.load(std::memory_order_acquire);
+	return((int32_t)(sequence - (index + 1)) >= 0);
+}
+
+/***********************************************************
+ *  Drain()
+ *
+ *  This method is used for writing out the queued messages
+ *  in order, with one flush after the batch.  Only the writer
+ *  thread reads the ring, and Stop() once it has ended.
+ ***********************************************************/
+bool Logger::Drain()
+{
+	bool bWritten = false;
+
+	for (;;)
+	{
+		uint32_t index = m_dequeueIndex.load(std::memory_order_relaxed);
+		SLOT& slot = m_ring[index & (RING_SIZE - 1)];
+		uint32_t sequence = slot.sequence.load(std::memory_order_acquire);
+
+		// the next message has not been published yet
+		if ((int32_t)(sequence - (index + 1)) < 0)
+		{
+			break;
+		}
+
+		Output(slot.level, slot.text);
+		bWritten = true;
+
+		m_dequeueIndex.store(index + 1, std::memory_order_relaxed);
+		// free the slot for the producers of the next lap
+		slot.sequence.store(index + RING_SIZE, std::memory_order_release);
+	}
+
+	if (bWritten)
+	{
+		fflush(stdout);
+		fflush(stderr);
+	}
+	return(bWritten);
+}
+
+/***********************************************************
+ *  ThreadMain()
+ *
+ *  This method is used for writing out messages until the
+ *  thread is stopped, waiting on the condition variable
+ *  whenever the ring is empty.
+ ***********************************************************/
+void Logger::ThreadMain()
+{
+	while (m_bRunning)
+	{
+		if (Drain() == true)
+		{
+			continue;
+		}
+
+		std::unique_lock<std::mutex> lock(m_wakeMutex);
+		m_bWriterWaiting.store(true, std::memory_order_relaxed);
+		std::atomic_thread_fence(std::memory_order_seq_cst);
+		while (m_bRunning && (HasMessage() == false))
+		{
+			m_wake.wait(lock);
+		}
+		m_bWriterWaiting.store(false, std::memory_order_relaxed);
+	}
+	Drain();
+}
+
+/***********************************************************
+ *  Output()
+ *
+ *  This method is used for writing one message and its line
+ *  ending to the stream of its level.
+ ***********************************************************/
+void Logger::Output(LEVEL level, const char* text)
+{
+	FILE* pStream = (level == LEVEL_ERROR) ? stderr : stdout;
+	fputs(text, pStream);
+	fputc('\n', pStream);
+}
@@ -0,0 +1,104 @@
+///////////////////////////////////////////////////////////////////////////////
+// logger.h
+// ============
+// format log messages into a lock-free ring that a background thread writes out
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+
+/***********************************************************
+ *  Logger
+ *
+ *  This class formats each message straight into a slot of
+ *  a preallocated ring buffer, so logging never allocates or
+ *  flushes on the calling thread, and only takes a lock to
+ *  wake the writer.  Any thread may log; a background thread
+ *  writes the messages out in order and flushes once per
+ *  batch, and sleeps on a condition variable while the ring
+ *  is empty.  Before the thread is started, and after it is
+ *  stopped, messages are written out directly.  When the
+ *  ring is full a message is dropped and counted instead of
+ *  making the caller wait.
+ ***********************************************************/
+class Logger
+{
+public:
+	enum LEVEL
+	{
+		LEVEL_INFO = 0,
+		LEVEL_ERROR
+	};
+
+	// get the single logger instance
+	static Logger& Instance();
+
+	// start and stop the writer thread - stopping writes out
+	// every message that is still in the ring
+	void Start();
+	void Stop();
+
+	// format a message with printf rules and queue it - a new
+	// line is added at the end
+	void Write(LEVEL level, const char* format, ...);
+
+	// number of messages lost because the ring was full
+	uint32_t GetDroppedMessages() const { return(m_droppedMessages.load()); }
+
+private:
+	// constructor
+	Logger();
+	// destructor
+	~Logger();
+
+	// number of ring slots, a power of two
+	static const uint32_t RING_SIZE = 1024;
+	// longest message, longer ones are cut off
+	static const size_t MAX_MESSAGE_LENGTH = 256;
+
+	struct SLOT
+	{
+		// turn counter that tells producers and the consumer
+		// whether the slot is free or holds a message
+		std::atomic<uint32_t> sequence;
+		LEVEL level;
+		char text[MAX_MESSAGE_LENGTH];
+	};
+
+	SLOT m_ring[RING_SIZE];
+	std::atomic<uint32_t> m_enqueueIndex;
+	std::atomic<uint32_t> m_dequeueIndex;
+	std::atomic<uint32_t> m_droppedMessages;
+
+	std::thread m_thread;
+	std::atomic<bool> m_bRunning;
+	// producers inside Write(), which Stop() waits for
+	std::atomic<uint32_t> m_activeWriters;
+	// the writer thread sleeps on the condition while it is
+	// waiting for a message
+	std::mutex m_wakeMutex;
+	std::condition_variable m_wake;
+	std::atomic<bool> m_bWriterWaiting;
+
+	// write out every queued message, returns false when there
+	// were none
+	bool Drain();
+	// check whether the next message has been published
+	bool HasMessage() const;
+	// wake the writer thread when it is waiting
+	void WakeWriter();
+	// writer thread body
+	void ThreadMain();
+	// write one message to stdout or stderr
+	static void Output(LEVEL level, const char* text);
+};
+
+// queue an informational or an error message
+#define LOG_INFO(...) Logger::Instance().Write(Logger::LEVEL_INFO, __VA_ARGS__)
+#define LOG_ERROR(...) Logger::Instance().Write(Logger::LEVEL_ERROR, __VA_ARGS__)
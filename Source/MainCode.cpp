@@ -22,6 +22,20 @@
 #include "ViewManager.h"
 #include "ShapeMeshes.h"
 #include "ShaderManager.h"
+#include "AppOptions.h"
+#include "HeadlessContext.h"
+#include "BenchmarkRunner.h"
+#include "SceneHelperBenchmark.h"
+#include "TransformBenchmark.h"
+#include "CameraPath.h"
+#include "StartupTimer.h"
+#include "StartupBenchmark.h"
+#include "Logger.h"
+#include "FrameProfiler.h"
+#include "RenderStats.h"
+#include "PipelineStats.h"
+#include "CategoryTimer.h"
+#include "StressScene.h"
 
 // Namespace for declaring global variables
 namespace
@@ -29,6 +43,10 @@ namespace
 	// Macro for window title
 	const char* const WINDOW_TITLE = "7-1 FinalProject and Milestones"; 
 
+	// size of the offscreen benchmark framebuffer
+	const int BENCHMARK_WIDTH = 1000;
+	const int BENCHMARK_HEIGHT = 800;
+
 	// Main GLFW window
 	GLFWwindow* g_Window = nullptr;
 
@@ -44,6 +62,10 @@ namespace
 // need to be pre-declared at the beginning of the source code.
 bool InitializeGLFW();
 bool InitializeGLEW();
+int RunBenchmark(const APP_OPTIONS& options);
+int RunStartupBenchmark(const APP_OPTIONS& options);
+bool TimeHeadlessStartup();
+void SelectScene(const APP_OPTIONS& options, SceneManager& sceneManager, StressScene& stressScene);
 
 
 /***********************************************************
@@ -54,6 +76,55 @@ bool InitializeGLEW();
  ***********************************************************/
 int main(int argc, char* argv[])
 {
+	APP_OPTIONS options;
+
+	// the startup phases are timed from here to the first frame
+	StartupTimer::Instance().Reset();
+	// messages are written out by the logger thread from now on
+	Logger::Instance().Start();
+
+	// if the command line cannot be parsed, then terminate the application
+	if (ParseCommandLine(argc, argv, options) == false)
+	{
+		PrintUsage(argv[0]);
+		return(EXIT_FAILURE);
+	}
+
+	// the helper microbenchmarks need no OpenGL context at all
+	if (options.bMicrobench)
+	{
+		SceneHelperBenchmark microbench;
+		microbench.Run();
+		return(microbench.WriteReport(options.reportPath) ? EXIT_SUCCESS : EXIT_FAILURE);
+	}
+	if (options.bTransformBenchmark)
+	{
+		TransformBenchmark transformBench;
+		transformBench.Run();
+		return(transformBench.WriteReport(options.reportPath) ? EXIT_SUCCESS : EXIT_FAILURE);
+	}
+
+	// the scene compiler only loads the scene objects
+	if (!options.compileScenePath.empty())
+	{
+		SceneManager sceneManager(NULL);
+		StressScene stressScene;
+		SelectScene(options, sceneManager, stressScene);
+		return(sceneManager.CompileScene(options.compileScenePath) ? EXIT_SUCCESS : EXIT_FAILURE);
+	}
+
+	// the startup benchmark creates its own offscreen contexts
+	if (options.bStartupBenchmark)
+	{
+		return(RunStartupBenchmark(options));
+	}
+
+	// the benchmark renders offscreen and needs no display window
+	if (options.bBenchmark)
+	{
+		return(RunBenchmark(options));
+	}
+
 	// if GLFW fails initialization, then terminate the application
 	if (InitializeGLFW() == false)
 	{
@@ -66,6 +137,8 @@ int main(int argc, char* argv[])
 	g_ViewManager = new ViewManager(
 		g_ShaderManager);
 
+	g_ViewManager->SetDebugView((ViewManager::DEBUG_VIEW)options.debugView);
+
 	// try to create the main display window
 	g_Window = g_ViewManager->CreateDisplayWindow(WINDOW_TITLE);
 
@@ -76,38 +149,124 @@ int main(int argc, char* argv[])
 	}
 
 	// load the shader code from the external GLSL files
-	g_ShaderManager->LoadShaders(
-		"shaders/vertexShader.glsl",
-		"shaders/fragmentShader.glsl");
-	g_ShaderManager->use();
+	{
+		STARTUP_PHASE("LoadShaders");
+		g_ShaderManager->LoadShaders(
+			"shaders/vertexShader.glsl",
+			"shaders/fragmentShader.glsl");
+		g_ShaderManager->use();
+	}
 
 	// try to create a new scene manager object and prepare the 3D scene
 	g_SceneManager = new SceneManager(g_ShaderManager);
+
+	// pick the objects the scene is prepared with
+	StressScene stressScene;
+	SelectScene(options, *g_SceneManager, stressScene);
 	g_SceneManager->PrepareScene();
 
+	// fly the camera along the scripted path if one was asked for
+	CameraPath cameraPath;
+	if (!options.cameraPathFile.empty())
+	{
+		if (cameraPath.Load(options.cameraPathFile) == false)
+		{
+			return(EXIT_FAILURE);
+		}
+		g_ViewManager->SetCameraPath(&cameraPath, options.cameraTimeStep);
+	}
+
+	// start recording the profiler zones if a trace was asked for
+	if (!options.profileTracePath.empty())
+	{
+		FrameProfiler::Instance().Enable(options.profileTracePath);
+	}
+	// collect the frame times if the pacing report was asked for
+	FramePacing framePacing;
+	if (!options.pacingReportPath.empty())
+	{
+		g_ViewManager->SetFramePacing(&framePacing);
+		framePacing.Start();
+	}
+
+	// count the GL calls of every frame if the stats were asked for
+	if (options.bLogStats)
+	{
+		RenderStats::Instance().Enable(true);
+	}
+
 	// loop will keep running until the application is closed 
 	// or until an error has occurred
 	while (!glfwWindowShouldClose(g_Window))
 	{
-		// Enable z-depth
-		glEnable(GL_DEPTH_TEST);
+		FrameProfiler::Instance().BeginFrame();
+		RenderStats::Instance().BeginFrame();
+		{
+			PROFILE_ZONE("Frame");
+			{
+				PROFILE_ZONE("Clear");
+
+				// Enable z-depth
+				glEnable(GL_DEPTH_TEST);
+
+				// Clear the frame and z buffers
+				glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
+				glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+			}
+			{
+				PROFILE_ZONE("PrepareSceneView");
+
+				// convert from 3D object space to 2D view
+				g_ViewManager->PrepareSceneView();
+				g_SceneManager->SetView(g_ViewManager->GetViewProjection(), g_ViewManager->GetCameraPosition());
+			}
+			{
+				PROFILE_ZONE("RenderScene");
+
+				// refresh the 3D scene
+				g_SceneManager->RenderScene();
+			}
+			{
+				PROFILE_ZONE("SwapBuffers");
 
-		// Clear the frame and z buffers
-		glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
-		glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+				// Flips the the back buffer with the front buffer every frame.
+				glfwSwapBuffers(g_Window);
+			}
+			{
+				PROFILE_ZONE("PollEvents");
 
-		// convert from 3D object space to 2D view
-		g_ViewManager->PrepareSceneView();
+				// query the latest GLFW events
+				glfwPollEvents();
+			}
+		}
+		RenderStats::Instance().EndFrame();
+		FrameProfiler::Instance().EndFrame();
 
-		// refresh the 3D scene
-		g_SceneManager->RenderScene();
+		// the first swapped frame ends the startup
+		if (StartupTimer::Instance().GetFirstFrameMs() < 0.0)
+		{
+			StartupTimer::Instance().MarkFirstFrame();
+			if (!options.startupReportPath.empty())
+			{
+				StartupTimer::Instance().WriteReport(options.startupReportPath);
+			}
+		}
 
+		// the F12 key asks for the trace to be completed right away
+		if (FrameProfiler::Instance().IsDumpRequested())
+		{
+			FrameProfiler::Instance().FlushTrace();
+		}
+	}
 
-		// Flips the the back buffer with the front buffer every frame.
-		glfwSwapBuffers(g_Window);
+	// finish the profiler trace before the context goes away
+	FrameProfiler::Instance().Disable();
+	RenderStats::Instance().Disable();
 
-		// query the latest GLFW events
-		glfwPollEvents();
+	if (!options.pacingReportPath.empty())
+	{
+		framePacing.Stop();
+		framePacing.WriteReport(options.pacingReportPath);
 	}
 
 	// clear the allocated manager objects from memory
@@ -127,10 +286,307 @@ int main(int argc, char* argv[])
 		g_ShaderManager = NULL;
 	}
 
+	// write out the last queued messages
+	Logger::Instance().Stop();
+
 	// Terminates the program successfully
 	exit(EXIT_SUCCESS); 
 }
 
+/***********************************************************
+ *	RunBenchmark()
+ *
+ *  This function is used to render the scene offscreen for
+ *  a fixed number of frames and write the timing report.
+ ***********************************************************/
+int RunBenchmark(const APP_OPTIONS& options)
+{
+#ifndef __linux__
+	// the hidden benchmark window is created through GLFW
+	if (InitializeGLFW() == false)
+	{
+		return(EXIT_FAILURE);
+	}
+#endif
+
+	HeadlessContext context;
+	if (context.Create(BENCHMARK_WIDTH, BENCHMARK_HEIGHT) == false)
+	{
+		return(EXIT_FAILURE);
+	}
+
+	// if GLEW fails initialization, then terminate the application
+	if ((InitializeGLEW() == false) || (context.CreateFramebuffer() == false))
+	{
+		return(EXIT_FAILURE);
+	}
+
+	// the camera follows the scripted path when one is given,
+	// so that every run sees the same camera motion
+	CameraPath cameraPath;
+	if (!options.cameraPathFile.empty() && (cameraPath.Load(options.cameraPathFile) == false))
+	{
+		return(EXIT_FAILURE);
+	}
+
+	// the managers are set up the same way as the display loop,
+	// and the view manager keeps its default fixed camera unless
+	// a camera path was loaded
+	ShaderManager shaderManager;
+	shaderManager.LoadShaders(
+		"shaders/vertexShader.glsl",
+		"shaders/fragmentShader.glsl");
+	shaderManager.use();
+
+	if (!options.profileTracePath.empty())
+	{
+		FrameProfiler::Instance().Enable(options.profileTracePath);
+	}
+
+	// the GL call counters always go into the benchmark report
+	RenderStats::Instance().Enable(options.bLogStats);
+	// the benchmark still runs when the driver cannot count the
+	// shader invocations, the report just leaves them out
+	if (options.bPipelineStats)
+	{
+		PipelineStats::Instance().Enable();
+	}
+	if (options.bCategoryTimes)
+	{
+		CategoryTimer::Instance().Enable();
+	}
+
+	bool bReturn = false;
+	if (!options.replayPath.empty())
+	{
+		// re-issue a recorded draw stream instead of the scene code
+		DrawStreamPlayer player;
+		bReturn = player.Load(options.replayPath);
+		if (bReturn == true)
+		{
+			player.ExecuteSetup();
+
+			BenchmarkRunner benchmark(&player);
+			bReturn = benchmark.Run(options.benchmarkFrames, options.warmupFrames);
+			if (bReturn == true)
+			{
+				bReturn = benchmark.WriteReport(options.reportPath);
+			}
+		}
+	}
+	else
+	{
+		ViewManager viewManager(&shaderManager);
+		SceneManager sceneManager(&shaderManager);
+		BenchmarkRunner benchmark(&viewManager, &sceneManager);
+
+		if (!options.cameraPathFile.empty())
+		{
+			viewManager.SetCameraPath(&cameraPath, options.cameraTimeStep);
+		}
+		viewManager.SetDebugView((ViewManager::DEBUG_VIEW)options.debugView);
+
+		// the recorder is attached before the scene is prepared so
+		// that the light setup and texture loads are captured too
+		DrawStreamRecorder recorder;
+		bool bCapture = !options.capturePath.empty();
+		if (bCapture)
+		{
+			viewManager.SetDrawStreamRecorder(&recorder);
+			sceneManager.SetDrawStreamRecorder(&recorder);
+			benchmark.SetDrawStreamRecorder(&recorder);
+		}
+
+		StressScene stressScene;
+		SelectScene(options, sceneManager, stressScene);
+
+		sceneManager.PrepareScene();
+
+		if (bCapture)
+		{
+			// every captured frame is recorded, so there is no warmup
+			bReturn = benchmark.Run(options.benchmarkFrames, 0);
+			if (bReturn == true)
+			{
+				bReturn = recorder.Save(options.capturePath);
+			}
+		}
+		else if (options.bCheckAllocations)
+		{
+			// a settled frame must not allocate, so a single
+			// allocation fails the check
+			uint64_t allocations = benchmark.CountFrameAllocations(options.allocationCheckFrames, options.warmupFrames);
+			bReturn = (allocations == 0);
+			if (bReturn == true)
+			{
+				LOG_INFO("No heap allocations in %d frames", options.allocationCheckFrames);
+			}
+			else
+			{
+				LOG_ERROR("Heap allocations in %d frames:%llu", options.allocationCheckFrames, (unsigned long long)allocations);
+			}
+		}
+		else if (options.bCheckEdits)
+		{
+			// the check logs every failure it finds
+			bReturn = benchmark.CheckObjectEdits(options.editCheckObjects, options.warmupFrames);
+			if (bReturn == true)
+			{
+				LOG_INFO("Object edits of %d objects passed", options.editCheckObjects);
+			}
+		}
+		else
+		{
+			bReturn = benchmark.Run(options.benchmarkFrames, options.warmupFrames);
+			if (bReturn == true)
+			{
+				bReturn = benchmark.WriteReport(options.reportPath);
+			}
+		}
+	}
+
+	FrameProfiler::Instance().Disable();
+	CategoryTimer::Instance().Disable();
+	PipelineStats::Instance().Disable();
+	RenderStats::Instance().Disable();
+
+	return(bReturn ? EXIT_SUCCESS : EXIT_FAILURE);
+}
+
+/***********************************************************
+ *	RunStartupBenchmark()
+ *
+ *  This function is used to time repeated headless startups
+ *  up to the first rendered frame.  Each cold startup runs
+ *  right after the texture and shader files were dropped from
+ *  the file cache, and is followed by a warm startup that
+ *  reads the same files from the cache.
+ ***********************************************************/
+int RunStartupBenchmark(const APP_OPTIONS& options)
+{
+#ifndef __linux__
+	// the hidden startup windows are created through GLFW
+	if (InitializeGLFW() == false)
+	{
+		return(EXIT_FAILURE);
+	}
+#endif
+
+	StartupBenchmark startupBenchmark;
+	for (int run = 0; run < options.startupRuns; run++)
+	{
+		for (int pass = 0; pass < 2; pass++)
+		{
+			bool bCold = (pass == 0);
+			bool bEvicted = bCold && StartupBenchmark::EvictFileCache();
+
+			StartupTimer::Instance().Reset();
+			if (TimeHeadlessStartup() == false)
+			{
+				return(EXIT_FAILURE);
+			}
+			startupBenchmark.AddRun(bCold, bEvicted);
+		}
+	}
+
+	return(startupBenchmark.WriteReport(options.reportPath) ? EXIT_SUCCESS : EXIT_FAILURE);
+}
+
+/***********************************************************
+ *	TimeHeadlessStartup()
+ *
+ *  This function is used to run one offscreen startup the
+ *  same way as the display loop, render the first frame and
+ *  wait for it to finish, and then tear everything down.
+ ***********************************************************/
+bool TimeHeadlessStartup()
+{
+	HeadlessContext context;
+	{
+		STARTUP_PHASE("CreateContext");
+		if (context.Create(BENCHMARK_WIDTH, BENCHMARK_HEIGHT) == false)
+		{
+			return(false);
+		}
+	}
+
+	if ((InitializeGLEW() == false) || (context.CreateFramebuffer() == false))
+	{
+		return(false);
+	}
+
+	// the managers free their GL objects before the context goes
+	{
+		ShaderManager shaderManager;
+		{
+			STARTUP_PHASE("LoadShaders");
+			shaderManager.LoadShaders(
+				"shaders/vertexShader.glsl",
+				"shaders/fragmentShader.glsl");
+			shaderManager.use();
+		}
+
+		ViewManager viewManager(&shaderManager);
+		SceneManager sceneManager(&shaderManager);
+		sceneManager.PrepareScene();
+
+		{
+			STARTUP_PHASE("FirstFrame");
+
+			glEnable(GL_DEPTH_TEST);
+			glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
+			glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+			viewManager.PrepareSceneView();
+			sceneManager.SetView(viewManager.GetViewProjection(), viewManager.GetCameraPosition());
+			sceneManager.RenderScene();
+
+			// the texture uploads and mipmaps are only finished once
+			// the first frame is
+			glFinish();
+		}
+		StartupTimer::Instance().MarkFirstFrame();
+	}
+
+	context.Destroy();
+	return(true);
+}
+
+/***********************************************************
+ *  SelectScene()
+ *
+ *  This function is used for telling the scene manager which
+ *  objects to prepare the scene with - a generated stress
+ *  scene, a compiled scene file, the baked default scene or
+ *  a scene file, in that order of preference.  The stress
+ *  scene must live until the scene has been prepared.
+ ***********************************************************/
+void SelectScene(const APP_OPTIONS& options, SceneManager& sceneManager, StressScene& stressScene)
+{
+	sceneManager.SetSystemThreads(options.systemThreads);
+
+	if (options.stressObjects > 0)
+	{
+		stressScene.Generate((uint32_t)options.stressObjects, (uint32_t)options.stressSeed);
+		sceneManager.SetStressScene(&stressScene);
+	}
+	else if (!options.compiledSceneFile.empty())
+	{
+		sceneManager.SetCompiledSceneFile(options.compiledSceneFile);
+		sceneManager.SetStreaming(options.streamCellSize, options.streamRadius,
+			(uint64_t)options.streamBudgetMB * 1024 * 1024);
+	}
+	else if (options.bBakedScene)
+	{
+		sceneManager.SetBakedScene(true);
+	}
+
+	// also the fallback when a compiled scene cannot be mapped
+	if (!options.sceneFile.empty())
+	{
+		sceneManager.SetSceneFile(options.sceneFile);
+	}
+}
+
 /***********************************************************
  *	InitializeGLFW()
  * 
@@ -138,6 +594,8 @@ int main(int argc, char* argv[])
  ***********************************************************/
 bool InitializeGLFW()
 {
+	STARTUP_PHASE("InitializeGLFW");
+
 	// GLFW: initialize and configure library
 	// --------------------------------------
 	glfwInit();
@@ -165,22 +623,27 @@ bool InitializeGLFW()
  ***********************************************************/
 bool InitializeGLEW()
 {
+	STARTUP_PHASE("InitializeGLEW");
+
 	// GLEW: initialize
 	// -----------------------------------------
 	GLenum GLEWInitResult = GLEW_OK;
 
+	// load every entry point of the core profile context
+	glewExperimental = GL_TRUE;
+
 	// try to initialize the GLEW library
 	GLEWInitResult = glewInit();
 	if (GLEW_OK != GLEWInitResult)
 	{
-		std::cerr << glewGetErrorString(GLEWInitResult) << std::endl;
+		LOG_ERROR("%s", (const char*)glewGetErrorString(GLEWInitResult));
 		return false;
 	}
 	// GLEW: end -------------------------------
 
 	// Displays a successful OpenGL initialization message
-	std::cout << "INFO: OpenGL Successfully Initialized\n";
-	std::cout << "INFO: OpenGL Version: " << glGetString(GL_VERSION) << "\n" << std::endl;
+	LOG_INFO("INFO: OpenGL Successfully Initialized");
+	LOG_INFO("INFO: OpenGL Version: %s\n", (const char*)glGetString(GL_VERSION));
 
 	return(true);
 }
\ No newline at end of file
@@ -0,0 +1,253 @@
+///////////////////////////////////////////////////////////////////////////////
+// memorystats.cpp
+// ============
+// account for the CPU and GPU memory held by the scene resources
+///////////////////////////////////////////////////////////////////////////////
+
+#include "MemoryStats.h"
+
+#include <cstring>
+
+// declaration of global variables
+namespace
+{
+	// most vertex attributes whose buffers are measured
+	const GLint MAX_MEASURED_ATTRIBUTES = 16;
+
+	const char* g_CategoryNames[MemoryStats::CATEGORY_COUNT] =
+	{
+		"gpu_textures",
+		"gpu_mesh_buffers",
+		"gpu_object_buffer",
+		"cpu_materials",
+		"cpu_texture_table",
+		"cpu_scene_objects",
+		"cpu_streamed_cells"
+	};
+}
+
+/***********************************************************
+ *  Instance()
+ *
+ *  This method is used for getting the single accounting
+ *  object that all of the memory is counted into.
+ ***********************************************************/
+MemoryStats& MemoryStats::Instance()
+{
+	static MemoryStats stats;
+	return(stats);
+}
+
+/***********************************************************
+ *  MemoryStats()
+ *
+ *  The constructor for the class
+ ***********************************************************/
+MemoryStats::MemoryStats()
+{
+	memset(m_bytes, 0, sizeof(m_bytes));
+	memset(m_objects, 0, sizeof(m_objects));
+}
+
+/***********************************************************
+ *  Add()
+ *
+ *  This method is used for counting the memory of newly
+ *  created objects.
+ ***********************************************************/
+void MemoryStats::Add(CATEGORY category, uint64_t bytes, uint32_t objects)
+{
+	m_bytes[category] += bytes;
+	m_objects[category] += objects;
+}
+
+/***********************************************************
+ *  Remove()
+ *
+ *  This method is used for taking the memory of freed
+ *  objects back out of the totals.
+ ***********************************************************/
+void MemoryStats::Remove(CATEGORY category, uint64_t bytes, uint32_t objects)
+{
+	m_bytes[category] -= (bytes < m_bytes[category]) ? bytes : m_bytes[category];
+	m_objects[category] -= (objects < m_objects[category]) ? objects : m_objects[category];
+}
+
+/***********************************************************
+ *  GetGpuBytes()
+ *
+ *  This method is used for getting the total of the GPU
+ *  categories.
+ ***********************************************************/
+uint64_t MemoryStats::GetGpuBytes() const
+{
+	uint64_t total = 0;
+	for (int i = 0; i < CATEGORY_COUNT; i++)
+	{
+		if (IsGpuCategory(i))
+		{
+			total += m_bytes[i];
+		}
+	}
+	return(total);
+}
+
+/***********************************************************
+ *  GetCpuBytes()
+ *
+ *  This method is used for getting the total of the CPU
+ *  categories.
+ ***********************************************************/
+uint64_t MemoryStats::GetCpuBytes() const
+{
+	uint64_t total = 0;
+	for (int i = 0; i < CATEGORY_COUNT; i++)
+	{
+		if (!IsGpuCategory(i))
+		{
+			total += m_bytes[i];
+		}
+	}
+	return(total);
+}
+
+/***********************************************************
+ *  WriteJSON()
+ *
+ *  This method is used for writing the GPU and CPU totals
+ *  followed by the bytes and objects of each category.
+ ***********************************************************/
+void MemoryStats::WriteJSON(std::ostream& out, const char* indent) const
+{
+	out << "{\n";
+	out << indent << "  \"gpu_bytes\": " << GetGpuBytes() << ",\n";
+	out << indent << "  \"cpu_bytes\": " << GetCpuBytes() << ",\n";
+	out << indent << "  \"categories\": {\n";
+	for (int i = 0; i < CATEGORY_COUNT; i++)
+	{
+		out << indent << "    \"" << g_CategoryNames[i] << "\": { "
+			<< "\"bytes\": " << m_bytes[i]
+			<< ", \"objects\": " << m_objects[i] << " }"
+			<< ((i + 1 < CATEGORY_COUNT) ? ",\n" : "\n");
+	}
+	out << indent << "  }\n";
+	out << indent << "}";
+}
+
+/***********************************************************
+ *  GetCategoryName()
+ *
+ *  This method is used for getting the report name of a
+ *  category.
+ ***********************************************************/
+const char* MemoryStats::GetCategoryName(int category)
+{
+	if ((category < 0) || (category >= CATEGORY_COUNT))
+	{
+		return("");
+	}
+	return(g_CategoryNames[category]);
+}
+
+/***********************************************************
+ *  TextureBytes()
+ *
+ *  This method is used for adding up the bytes of every
+ *  level of a mipmapped texture, down to the 1x1 level.
+ ***********************************************************/
+uint64_t MemoryStats::TextureBytes(int width, int height, int bytesPerTexel)
+{
+	uint64_t total = 0;
+	uint64_t levelWidth = (width > 0) ? width : 0;
+	uint64_t levelHeight = (height > 0) ? height : 0;
+
+	while ((levelWidth > 0) && (levelHeight > 0))
+	{
+		total += levelWidth * levelHeight * bytesPerTexel;
+		if ((levelWidth == 1) && (levelHeight == 1))
+		{
+			break;
+		}
+		levelWidth = (levelWidth > 1) ? levelWidth / 2 : 1;
+		levelHeight = (levelHeight > 1) ? levelHeight / 2 : 1;
+	}
+	return(total);
+}
+
+/***********************************************************
+ *  VertexArrayBytes()
+ *
+ *  This method is used for adding up the sizes of the
+ *  buffers that the bound vertex array draws from - its
+ *  index buffer and the buffer of each enabled attribute.
+ *  The basic meshes are created by ShapeMeshes, which does
+ *  not report its buffers but leaves the vertex array of
+ *  the mesh it just loaded bound, so they are measured
+ *  right after each mesh is loaded.  The sizes are read
+ *  through the copy read binding point, which no vertex
+ *  array or draw call depends on.
+ ***********************************************************/
+uint64_t MemoryStats::VertexArrayBytes(uint32_t& bufferCount)
+{
+	bufferCount = 0;
+
+	GLint vertexArray = 0;
+	glGetIntegerv(GL_VERTEX_ARRAY_BINDING, &vertexArray);
+	if (0 == vertexArray)
+	{
+		return(0);
+	}
+
+	// the index buffer first, then the attribute buffers, each
+	// buffer only once
+	GLuint buffers[MAX_MEASURED_ATTRIBUTES + 1];
+	GLint elementBuffer = 0;
+	glGetIntegerv(GL_ELEMENT_ARRAY_BUFFER_BINDING, &elementBuffer);
+	if (0 != elementBuffer)
+	{
+		buffers[bufferCount++] = (GLuint)elementBuffer;
+	}
+
+	GLint attributes = 0;
+	glGetIntegerv(GL_MAX_VERTEX_ATTRIBS, &attributes);
+	if (attributes > MAX_MEASURED_ATTRIBUTES)
+	{
+		attributes = MAX_MEASURED_ATTRIBUTES;
+	}
+	for (GLint i = 0; i < attributes; i++)
+	{
+		GLint enabled = 0;
+		GLint buffer = 0;
+		glGetVertexAttribiv(i, GL_VERTEX_ATTRIB_ARRAY_ENABLED, &enabled);
+		glGetVertexAttribiv(i, GL_VERTEX_ATTRIB_ARRAY_BUFFER_BINDING, &buffer);
+		if ((0 == enabled) || (0 == buffer))
+		{
+			continue;
+		}
+
+		bool bCounted = false;
+		for (uint32_t j = 0; (j < bufferCount) && !bCounted; j++)
+		{
+			bCounted = (buffers[j] == (GLuint)buffer);
+		}
+		if (!bCounted)
+		{
+			buffers[bufferCount++] = (GLuint)buffer;
+		}
+	}
+
+	GLint previousBinding = 0;
+	glGetIntegerv(GL_COPY_READ_BUFFER_BINDING, &previousBinding);
+
+	uint64_t total = 0;
+	for (uint32_t i = 0; i < bufferCount; i++)
+	{
+		GLint64 size = 0;
+		glBindBuffer(GL_COPY_READ_BUFFER, buffers[i]);
+		glGetBufferParameteri64v(GL_COPY_READ_BUFFER, GL_BUFFER_SIZE, &size);
+		total += (size > 0) ? (uint64_t)size : 0;
+	}
+
+	glBindBuffer(GL_COPY_READ_BUFFER, (GLuint)previousBinding);
+	return(total);
+}
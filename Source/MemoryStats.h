@@ -0,0 +1,78 @@
+///////////////////////////////////////////////////////////////////////////////
+// memorystats.h
+// ============
+// account for the CPU and GPU memory held by the scene resources
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <GL/glew.h>
+
+#include <cstdint>
+#include <ostream>
+
+/***********************************************************
+ *  MemoryStats
+ *
+ *  This class keeps running totals of the bytes and the
+ *  number of objects held in each memory category.  The
+ *  owners of the resources add their bytes when they create
+ *  them and remove the same bytes when they free them.  GPU
+ *  sizes are the nominal sizes of the data that was handed
+ *  to OpenGL; drivers may pad or compress it.
+ ***********************************************************/
+class MemoryStats
+{
+public:
+	enum CATEGORY
+	{
+		// texture images including their full mip chain
+		GPU_TEXTURES = 0,
+		// vertex and index buffers of the basic meshes
+		GPU_MESH_BUFFERS,
+		// model matrices of the scene objects
+		GPU_OBJECT_BUFFER,
+		// material definitions of the scene
+		CPU_MATERIALS,
+		// texture tag and ID table of the scene
+		CPU_TEXTURE_TABLE,
+		// per-object arrays of the scene description
+		CPU_SCENE_OBJECTS,
+		// resident objects of the streamed cells, at the bytes
+		// each one is counted as against the streaming budget
+		CPU_STREAMED_CELLS,
+		CATEGORY_COUNT
+	};
+
+	// get the single accounting instance
+	static MemoryStats& Instance();
+
+	// add and remove the memory of objects in a category
+	void Add(CATEGORY category, uint64_t bytes, uint32_t objects);
+	void Remove(CATEGORY category, uint64_t bytes, uint32_t objects);
+
+	uint64_t GetBytes(int category) const { return(m_bytes[category]); }
+	uint32_t GetObjects(int category) const { return(m_objects[category]); }
+	// totals of all GPU or all CPU categories
+	uint64_t GetGpuBytes() const;
+	uint64_t GetCpuBytes() const;
+
+	// write the totals as a JSON object, each line indented
+	void WriteJSON(std::ostream& out, const char* indent) const;
+
+	static const char* GetCategoryName(int category);
+	static bool IsGpuCategory(int category) { return(category <= GPU_OBJECT_BUFFER); }
+
+	// bytes of a texture image and all of its mipmap levels
+	static uint64_t TextureBytes(int width, int height, int bytesPerTexel);
+	// total size and number of the vertex and index buffers of
+	// the bound vertex array
+	static uint64_t VertexArrayBytes(uint32_t& bufferCount);
+
+private:
+	// constructor
+	MemoryStats();
+
+	uint64_t m_bytes[CATEGORY_COUNT];
+	uint32_t m_objects[CATEGORY_COUNT];
+};
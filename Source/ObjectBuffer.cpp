@@ -0,0 +1,143 @@
+///////////////////////////////////////////////////////////////////////////////
+// objectbuffer.cpp
+// ============
+// keep the model matrix of every scene object in one GPU buffer
+///////////////////////////////////////////////////////////////////////////////
+
+#include "ObjectBuffer.h"
+#include "Logger.h"
+
+#include <algorithm>
+
+/***********************************************************
+ *  ObjectBuffer()
+ *
+ *  The constructor for the class
+ ***********************************************************/
+ObjectBuffer::ObjectBuffer()
+{
+	m_buffer = 0;
+	m_texture = 0;
+	m_capacity = 0;
+	m_maxSlots = 0;
+	m_bOverLimitLogged = false;
+	m_lastUploadBytes = 0;
+}
+
+/***********************************************************
+ *  Create()
+ *
+ *  This method is used for reading how many slots a buffer
+ *  texture can hold, and creating the buffer with room for
+ *  the first slots and the buffer texture that reads it as
+ *  RGBA float texels.
+ ***********************************************************/
+void ObjectBuffer::Create()
+{
+	Destroy();
+
+	GLint maxTexels = 0;
+	glGetIntegerv(GL_MAX_TEXTURE_BUFFER_SIZE, &maxTexels);
+	m_maxSlots = (maxTexels > 0) ? (uint32_t)maxTexels / TEXELS_PER_SLOT : 0;
+	m_bOverLimitLogged = false;
+
+	m_capacity = (m_maxSlots < INITIAL_CAPACITY) ? m_maxSlots : INITIAL_CAPACITY;
+	glGenBuffers(1, &m_buffer);
+	glBindBuffer(GL_TEXTURE_BUFFER, m_buffer);
+	glBufferData(GL_TEXTURE_BUFFER, GetBufferBytes(), NULL, GL_DYNAMIC_DRAW);
+
+	glGenTextures(1, &m_texture);
+	glBindTexture(GL_TEXTURE_BUFFER, m_texture);
+	glTexBuffer(GL_TEXTURE_BUFFER, GL_RGBA32F, m_buffer);
+	glBindTexture(GL_TEXTURE_BUFFER, 0);
+	glBindBuffer(GL_TEXTURE_BUFFER, 0);
+}
+
+/***********************************************************
+ *  Destroy()
+ *
+ *  This method is used for freeing the buffer and its
+ *  texture, when they were created.
+ ***********************************************************/
+void ObjectBuffer::Destroy()
+{
+	if (m_texture != 0)
+	{
+		glDeleteTextures(1, &m_texture);
+		m_texture = 0;
+	}
+	if (m_buffer != 0)
+	{
+		glDeleteBuffers(1, &m_buffer);
+		m_buffer = 0;
+	}
+	m_capacity = 0;
+	m_maxSlots = 0;
+	m_lastUploadBytes = 0;
+}
+
+/***********************************************************
+ *  Update()
+ *
+ *  This method is used for copying the slot matrices that
+ *  changed into the buffer, one sub-data call per range.
+ *  When there are more slots than the buffer holds, it is
+ *  given at least twice the room, up to what the buffer
+ *  texture can read, and every slot is copied, which the
+ *  buffer texture picks up as it is.  Slots past that limit
+ *  are logged once and nothing is copied.
+ ***********************************************************/
+void ObjectBuffer::Update(const TransformStore::AFFINE_3X4* pModels, uint32_t slotCount,
+	const SceneWorld::SLOT_RANGE* pRanges, uint32_t rangeCount)
+{
+	m_lastUploadBytes = 0;
+	if ((IsCreated() == false) || (slotCount == 0))
+	{
+		return;
+	}
+	if (slotCount > m_maxSlots)
+	{
+		if (m_bOverLimitLogged == false)
+		{
+			LOG_ERROR("The object buffer holds at most %u objects, drawing %u with the model uniform",
+				m_maxSlots, slotCount);
+			m_bOverLimitLogged = true;
+		}
+		return;
+	}
+
+	const GLsizeiptr slotBytes = sizeof(TransformStore::AFFINE_3X4);
+	glBindBuffer(GL_TEXTURE_BUFFER, m_buffer);
+
+	if (slotCount > m_capacity)
+	{
+		m_capacity = std::min(std::max(slotCount, m_capacity * 2), m_maxSlots);
+		glBufferData(GL_TEXTURE_BUFFER, GetBufferBytes(), NULL, GL_DYNAMIC_DRAW);
+		glBufferSubData(GL_TEXTURE_BUFFER, 0, slotCount * slotBytes, pModels);
+		m_lastUploadBytes = slotCount * slotBytes;
+	}
+	else
+	{
+		for (uint32_t i = 0; i < rangeCount; i++)
+		{
+			glBufferSubData(GL_TEXTURE_BUFFER, pRanges[i].first * slotBytes,
+				pRanges[i].count * slotBytes, pModels + pRanges[i].first);
+			m_lastUploadBytes += pRanges[i].count * slotBytes;
+		}
+	}
+
+	glBindBuffer(GL_TEXTURE_BUFFER, 0);
+}
+
+/***********************************************************
+ *  Bind()
+ *
+ *  This method is used for binding the buffer texture to a
+ *  texture unit, where it stays for every frame.
+ ***********************************************************/
+void ObjectBuffer::Bind(int textureUnit) const
+{
+	glActiveTexture(GL_TEXTURE0 + textureUnit);
+	glBindTexture(GL_TEXTURE_BUFFER, m_texture);
+	glActiveTexture(GL_TEXTURE0);
+}
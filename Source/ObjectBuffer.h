@@ -0,0 +1,73 @@
+///////////////////////////////////////////////////////////////////////////////
+// objectbuffer.h
+// ============
+// keep the model matrix of every scene object in one GPU buffer
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include "TransformStore.h"
+#include "SceneWorld.h"
+
+#include <GL/glew.h>
+
+#include <cstdint>
+
+/***********************************************************
+ *  ObjectBuffer
+ *
+ *  This class keeps the model matrices of the scene objects
+ *  on the GPU, three RGBA float texels per object in a
+ *  buffer texture that the vertex shader reads with the
+ *  object's slot.  Only the ranges of slots whose matrices
+ *  changed are copied each frame - the whole buffer is only
+ *  uploaded again when it has to grow.  A buffer texture
+ *  holds a limited number of texels, only 65536 being
+ *  guaranteed, so a world with more slots than fit is not
+ *  uploaded and its objects keep using the model uniform.
+ ***********************************************************/
+class ObjectBuffer
+{
+public:
+	// constructor
+	ObjectBuffer();
+
+	// create the buffer and its texture - needs a current
+	// OpenGL context
+	void Create();
+	// free the buffer and its texture
+	void Destroy();
+	bool IsCreated() const { return(m_buffer != 0); }
+	// check that the buffer texture can hold the passed in
+	// number of slots
+	bool CanHold(uint32_t slotCount) const { return(IsCreated() && (slotCount <= m_maxSlots)); }
+
+	// copy the changed ranges of the slot matrices, or every
+	// slot when the buffer has to grow to hold them - nothing
+	// is copied when there are more slots than it can hold
+	void Update(const TransformStore::AFFINE_3X4* pModels, uint32_t slotCount,
+		const SceneWorld::SLOT_RANGE* pRanges, uint32_t rangeCount);
+	// bind the buffer texture to a texture unit
+	void Bind(int textureUnit) const;
+
+	// bytes copied by the last update
+	uint64_t GetLastUploadBytes() const { return(m_lastUploadBytes); }
+	// bytes of the buffer on the GPU
+	uint64_t GetBufferBytes() const { return((uint64_t)m_capacity * sizeof(TransformStore::AFFINE_3X4)); }
+
+private:
+	// slots the buffer holds when it is created
+	static const uint32_t INITIAL_CAPACITY = 256;
+	// RGBA float texels of one slot's matrix
+	static const uint32_t TEXELS_PER_SLOT = 3;
+
+	GLuint m_buffer;
+	GLuint m_texture;
+	// number of slots the buffer holds
+	uint32_t m_capacity;
+	// most slots the buffer texture can read
+	uint32_t m_maxSlots;
+	// going over the limit was logged
+	bool m_bOverLimitLogged;
+	uint64_t m_lastUploadBytes;
+};
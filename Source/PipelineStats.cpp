@@ -0,0 +1,295 @@
+///////////////////////////////////////////////////////////////////////////////
+// pipelinestats.cpp
+// ============
+// collect shader invocation counts for each group of scene objects
+///////////////////////////////////////////////////////////////////////////////
+
+#include "PipelineStats.h"
+#include "Logger.h"
+
+#include <cstring>
+
+// declaration of global variables
+namespace
+{
+	// query targets in the order of the STATISTIC enum
+	const GLenum g_StatisticTargets[PipelineStats::STAT_COUNT] =
+	{
+		GL_VERTEX_SHADER_INVOCATIONS_ARB,
+		GL_CLIPPING_INPUT_PRIMITIVES_ARB,
+		GL_CLIPPING_OUTPUT_PRIMITIVES_ARB,
+		GL_FRAGMENT_SHADER_INVOCATIONS_ARB
+	};
+
+	const char* g_StatisticNames[PipelineStats::STAT_COUNT] =
+	{
+		"vertex_shader_invocations",
+		"clipping_input_primitives",
+		"clipping_output_primitives",
+		"fragment_shader_invocations"
+	};
+
+	const char* g_GroupNames[PipelineStats::GROUP_COUNT] =
+	{
+		"ground",
+		"sky",
+		"trees",
+		"mountains",
+		"clouds"
+	};
+}
+
+/***********************************************************
+ *  Instance()
+ *
+ *  This method is used for getting the single statistics
+ *  object that all of the groups are counted into.
+ ***********************************************************/
+PipelineStats& PipelineStats::Instance()
+{
+	static PipelineStats stats;
+	return(stats);
+}
+
+/***********************************************************
+ *  PipelineStats()
+ *
+ *  The constructor for the class
+ ***********************************************************/
+PipelineStats::PipelineStats()
+{
+	m_bEnabled = false;
+	m_frameNumber = 0;
+	m_activeGroup = -1;
+	memset(m_frames, 0, sizeof(m_frames));
+}
+
+/***********************************************************
+ *  Enable()
+ *
+ *  This method is used for creating the queries of every
+ *  in-flight frame.  It fails when the driver does not
+ *  support pipeline statistics queries.
+ ***********************************************************/
+bool PipelineStats::Enable()
+{
+	if (m_bEnabled)
+	{
+		return(true);
+	}
+
+	if (!GLEW_ARB_pipeline_statistics_query)
+	{
+		LOG_ERROR("GL_ARB_pipeline_statistics_query is not supported");
+		return(false);
+	}
+
+	for (int i = 0; i < QUERY_LATENCY; i++)
+	{
+		m_frames[i].bPending = false;
+		m_frames[i].scopeCount = 0;
+		glGenQueries(MAX_SCOPES_PER_FRAME * STAT_COUNT, &m_frames[i].queries[0][0]);
+	}
+
+	m_frameNumber = 0;
+	m_activeGroup = -1;
+	m_history.clear();
+	m_bEnabled = true;
+	return(true);
+}
+
+/***********************************************************
+ *  Disable()
+ *
+ *  This method is used for freeing the queries.
+ ***********************************************************/
+void PipelineStats::Disable()
+{
+	if (!m_bEnabled)
+	{
+		return;
+	}
+
+	EndGroup();
+	for (int i = 0; i < QUERY_LATENCY; i++)
+	{
+		glDeleteQueries(MAX_SCOPES_PER_FRAME * STAT_COUNT, &m_frames[i].queries[0][0]);
+	}
+	m_bEnabled = false;
+}
+
+/***********************************************************
+ *  BeginFrame()
+ *
+ *  This method is used for reading back the frame that last
+ *  used this frame's queries and starting a new frame.
+ ***********************************************************/
+void PipelineStats::BeginFrame()
+{
+	if (!m_bEnabled)
+	{
+		return;
+	}
+
+	FRAME_QUERIES& frame = m_frames[m_frameNumber % QUERY_LATENCY];
+	if (frame.bPending)
+	{
+		ResolveFrame(frame);
+	}
+	frame.scopeCount = 0;
+}
+
+/***********************************************************
+ *  EndFrame()
+ *
+ *  This method is used for ending the last group of the
+ *  frame and leaving its results to be read back later.
+ ***********************************************************/
+void PipelineStats::EndFrame()
+{
+	if (!m_bEnabled)
+	{
+		return;
+	}
+
+	EndGroup();
+	m_frames[m_frameNumber % QUERY_LATENCY].bPending = true;
+	m_frameNumber++;
+}
+
+/***********************************************************
+ *  BeginGroup()
+ *
+ *  This method is used for counting the following draws
+ *  into the passed in group.  Asking for the group that is
+ *  already being counted keeps its queries running, so
+ *  objects of the same group that are drawn one after the
+ *  other share a single set of queries.
+ ***********************************************************/
+void PipelineStats::BeginGroup(RENDER_GROUP group)
+{
+	if (!m_bEnabled || (m_activeGroup == (int)group))
+	{
+		return;
+	}
+
+	EndGroup();
+
+	FRAME_QUERIES& frame = m_frames[m_frameNumber % QUERY_LATENCY];
+	if (frame.scopeCount == MAX_SCOPES_PER_FRAME)
+	{
+		return;
+	}
+
+	int scope = frame.scopeCount;
+	frame.groups[scope] = group;
+	for (int i = 0; i < STAT_COUNT; i++)
+	{
+		glBeginQuery(g_StatisticTargets[i], frame.queries[scope][i]);
+	}
+	m_activeGroup = group;
+}
+
+/***********************************************************
+ *  EndGroup()
+ *
+ *  This method is used for ending the queries of the group
+ *  that is being counted.
+ ***********************************************************/
+void PipelineStats::EndGroup()
+{
+	if (!m_bEnabled || (m_activeGroup < 0))
+	{
+		return;
+	}
+
+	for (int i = 0; i < STAT_COUNT; i++)
+	{
+		glEndQuery(g_StatisticTargets[i]);
+	}
+	m_frames[m_frameNumber % QUERY_LATENCY].scopeCount++;
+	m_activeGroup = -1;
+}
+
+/***********************************************************
+ *  Flush()
+ *
+ *  This method is used for waiting on the results of every
+ *  pending frame, oldest first, so that the history covers
+ *  all of the frames that were rendered.
+ ***********************************************************/
+void PipelineStats::Flush()
+{
+	if (!m_bEnabled)
+	{
+		return;
+	}
+
+	for (uint64_t i = 0; i < QUERY_LATENCY; i++)
+	{
+		FRAME_QUERIES& frame = m_frames[(m_frameNumber + i) % QUERY_LATENCY];
+		if (frame.bPending)
+		{
+			ResolveFrame(frame);
+		}
+	}
+}
+
+/***********************************************************
+ *  ResolveFrame()
+ *
+ *  This method is used for adding up the query results of
+ *  each group of a frame and storing them in the history,
+ *  when the reserved room is not used up.
+ ***********************************************************/
+void PipelineStats::ResolveFrame(FRAME_QUERIES& frame)
+{
+	FRAME_RESULT result;
+	memset(&result, 0, sizeof(result));
+
+	for (int scope = 0; scope < frame.scopeCount; scope++)
+	{
+		for (int i = 0; i < STAT_COUNT; i++)
+		{
+			GLuint64 value = 0;
+			glGetQueryObjectui64v(frame.queries[scope][i], GL_QUERY_RESULT, &value);
+			result.values[frame.groups[scope]][i] += value;
+		}
+	}
+
+	if (m_history.size() < m_history.capacity())
+	{
+		m_history.push_back(result);
+	}
+	frame.bPending = false;
+}
+
+/***********************************************************
+ *  GetGroupName()
+ *
+ *  This method is used for getting the report name of a
+ *  group.
+ ***********************************************************/
+const char* PipelineStats::GetGroupName(int group)
+{
+	if ((group < 0) || (group >= GROUP_COUNT))
+	{
+		return("");
+	}
+	return(g_GroupNames[group]);
+}
+
+/***********************************************************
+ *  GetStatisticName()
+ *
+ *  This method is used for getting the report name of a
+ *  statistic.
+ ***********************************************************/
+const char* PipelineStats::GetStatisticName(int statistic)
+{
+	if ((statistic < 0) || (statistic >= STAT_COUNT))
+	{
+		return("");
+	}
+	return(g_StatisticNames[statistic]);
+}
@@ -0,0 +1,114 @@
+///////////////////////////////////////////////////////////////////////////////
+// pipelinestats.h
+// ============
+// collect shader invocation counts for each group of scene objects
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <GL/glew.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/***********************************************************
+ *  PipelineStats
+ *
+ *  This class uses GL_ARB_pipeline_statistics_query to count
+ *  the vertex shader invocations, the primitives going into
+ *  and out of clipping and the fragment shader invocations
+ *  of each object group in the scene.  Only one query per
+ *  statistic can be active at a time, so the groups follow
+ *  each other: starting a group ends the one before it.  The
+ *  results of each frame are read back a few frames late,
+ *  and while the statistics are not enabled every call
+ *  returns immediately.
+ ***********************************************************/
+class PipelineStats
+{
+public:
+	enum RENDER_GROUP
+	{
+		GROUP_GROUND = 0,
+		GROUP_SKY,
+		GROUP_TREES,
+		GROUP_MOUNTAINS,
+		GROUP_CLOUDS,
+		GROUP_COUNT
+	};
+
+	enum STATISTIC
+	{
+		STAT_VERTEX_SHADER_INVOCATIONS = 0,
+		STAT_CLIPPING_INPUT_PRIMITIVES,
+		STAT_CLIPPING_OUTPUT_PRIMITIVES,
+		STAT_FRAGMENT_SHADER_INVOCATIONS,
+		STAT_COUNT
+	};
+
+	struct FRAME_RESULT
+	{
+		uint64_t values[GROUP_COUNT][STAT_COUNT];
+	};
+
+	// get the single statistics instance
+	static PipelineStats& Instance();
+
+	// start collecting - needs a current OpenGL context with the
+	// pipeline statistics extension, returns false without it
+	bool Enable();
+	// stop collecting and free the queries
+	void Disable();
+	bool IsEnabled() const { return(m_bEnabled); }
+
+	// mark the frame boundaries
+	void BeginFrame();
+	void EndFrame();
+
+	// count the following draws into the passed in group
+	void BeginGroup(RENDER_GROUP group);
+	// stop counting the draws of the current group
+	void EndGroup();
+
+	// wait for the results of every frame that is still pending
+	void Flush();
+	// results of the resolved frames, oldest first
+	const std::vector<FRAME_RESULT>& GetHistory() const { return(m_history); }
+	void ClearHistory() { m_history.clear(); }
+	// make room for the results of the passed in number of frames -
+	// the frame loop never grows the history, so the frames that
+	// do not fit are dropped
+	void ReserveHistory(size_t frames) { m_history.reserve(frames); }
+
+	// names used in the reports
+	static const char* GetGroupName(int group);
+	static const char* GetStatisticName(int statistic);
+
+private:
+	// constructor
+	PipelineStats();
+
+	// number of frames the queries may lag behind
+	static const int QUERY_LATENCY = 4;
+	// most group changes that are counted in one frame
+	static const int MAX_SCOPES_PER_FRAME = 32;
+
+	struct FRAME_QUERIES
+	{
+		bool bPending;
+		int scopeCount;
+		int groups[MAX_SCOPES_PER_FRAME];
+		GLuint queries[MAX_SCOPES_PER_FRAME][STAT_COUNT];
+	};
+
+	bool m_bEnabled;
+	uint64_t m_frameNumber;
+	// group whose queries are active, or -1
+	int m_activeGroup;
+	FRAME_QUERIES m_frames[QUERY_LATENCY];
+	std::vector<FRAME_RESULT> m_history;
+
+	// read back the results of one frame into the history
+	void ResolveFrame(FRAME_QUERIES& frame);
+};
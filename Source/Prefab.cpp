@@ -0,0 +1,123 @@
+///////////////////////////////////////////////////////////////////////////////
+// prefab.cpp
+// ============
+// local-space part matrices of the composite shapes, shared by every instance
+///////////////////////////////////////////////////////////////////////////////
+
+#include "Prefab.h"
+#include "CompositeShapes.h"
+
+// declaration of global variables and helper functions
+namespace
+{
+	/***********************************************************
+	 *  CountAllParts()
+	 *
+	 *  This function is used for counting the parts of every
+	 *  composite shape together.
+	 ***********************************************************/
+	constexpr size_t CountAllParts()
+	{
+		size_t parts = 0;
+		for (int type = 0; type < COMPOSITE_TYPE_COUNT; type++)
+		{
+			parts += g_CompositeShapes[type].partCount;
+		}
+		return(parts);
+	}
+
+	constexpr size_t PART_COUNT = CountAllParts();
+
+	struct PREFAB_TABLE
+	{
+		// index of the first local matrix of every shape
+		size_t firstPart[COMPOSITE_TYPE_COUNT];
+		TransformStore::AFFINE_3X4 locals[PART_COUNT];
+	};
+
+	/***********************************************************
+	 *  BuildPrefabs()
+	 *
+	 *  This function is used for composing the local matrix of
+	 *  every part from its offset, rotation and unscaled size.
+	 ***********************************************************/
+	constexpr PREFAB_TABLE BuildPrefabs()
+	{
+		PREFAB_TABLE table = {};
+		size_t local = 0;
+
+		for (int type = 0; type < COMPOSITE_TYPE_COUNT; type++)
+		{
+			const COMPOSITE_SHAPE& shape = g_CompositeShapes[type];
+			table.firstPart[type] = local;
+
+			for (size_t p = 0; p < shape.partCount; p++)
+			{
+				const COMPOSITE_PART& part = shape.pParts[p];
+				ComposeAffine(part.scale, part.rotation, part.offset, table.locals[local].m);
+				local++;
+			}
+		}
+		return(table);
+	}
+
+	// evaluated by the compiler
+	constexpr PREFAB_TABLE g_Prefabs = BuildPrefabs();
+
+	/***********************************************************
+	 *  MaxPartCount()
+	 *
+	 *  This function is used for getting the part count of the
+	 *  largest composite shape.
+	 ***********************************************************/
+	constexpr size_t MaxPartCount()
+	{
+		size_t most = 0;
+		for (int type = 0; type < COMPOSITE_TYPE_COUNT; type++)
+		{
+			most = (g_CompositeShapes[type].partCount > most) ? g_CompositeShapes[type].partCount : most;
+		}
+		return(most);
+	}
+
+	static_assert(MaxPartCount() <= Prefab::MAX_PARTS, "a composite shape has more than Prefab::MAX_PARTS parts");
+}
+
+/***********************************************************
+ *  GetPartCount()
+ *
+ *  This method is used for getting the number of parts of a
+ *  composite shape.
+ ***********************************************************/
+size_t Prefab::GetPartCount(int type)
+{
+	return(g_CompositeShapes[type].partCount);
+}
+
+/***********************************************************
+ *  GetLocals()
+ *
+ *  This method is used for copying the local matrices of a
+ *  shape's parts.  The instance scale sizes a part without
+ *  moving it, so it only multiplies the rotation and scale
+ *  columns of the parts that take it.
+ ***********************************************************/
+void Prefab::GetLocals(int type, float scale, TransformStore::AFFINE_3X4* pLocals)
+{
+	const COMPOSITE_SHAPE& shape = g_CompositeShapes[type];
+	const TransformStore::AFFINE_3X4* pShapeLocals = &g_Prefabs.locals[g_Prefabs.firstPart[type]];
+
+	for (size_t p = 0; p < shape.partCount; p++)
+	{
+		pLocals[p] = pShapeLocals[p];
+		if (shape.pParts[p].bScaled == true)
+		{
+			for (int row = 0; row < 3; row++)
+			{
+				pLocals[p].m[row * 4 + 0] *= scale;
+				pLocals[p].m[row * 4 + 1] *= scale;
+				pLocals[p].m[row * 4 + 2] *= scale;
+			}
+		}
+	}
+}
@@ -0,0 +1,35 @@
+///////////////////////////////////////////////////////////////////////////////
+// prefab.h
+// ============
+// local-space part matrices of the composite shapes, shared by every instance
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include "TransformStore.h"
+
+#include <cstddef>
+
+/***********************************************************
+ *  Prefab
+ *
+ *  This class holds the local matrix of every part of every
+ *  composite shape, relative to the shape's own origin, in a
+ *  table that the compiler builds.  An instance of a shape
+ *  is placed with one parent transform, and the world matrix
+ *  of each of its parts is the parent's matrix times the
+ *  part's local matrix, so no part transform is composed
+ *  when shapes are placed.
+ ***********************************************************/
+class Prefab
+{
+public:
+	// most parts any composite shape has
+	static const size_t MAX_PARTS = 8;
+
+	// number of parts of a COMPOSITE_TYPE shape
+	static size_t GetPartCount(int type);
+	// copy the local matrices of a shape's parts, with the
+	// instance scale applied to the parts that take it
+	static void GetLocals(int type, float scale, TransformStore::AFFINE_3X4* pLocals);
+};
@@ -0,0 +1,262 @@
+///////////////////////////////////////////////////////////////////////////////
+// renderstats.cpp
+// ============
+// count the OpenGL work that is submitted for every rendered frame
+///////////////////////////////////////////////////////////////////////////////
+
+#include "RenderStats.h"
+#include "Logger.h"
+
+#include <cstring>
+
+/***********************************************************
+ *  Instance()
+ *
+ *  This method is used for getting the single stats object
+ *  that all of the counters are recorded into.
+ ***********************************************************/
+RenderStats& RenderStats::Instance()
+{
+	static RenderStats stats;
+	return(stats);
+}
+
+/***********************************************************
+ *  RenderStats()
+ *
+ *  The constructor for the class
+ ***********************************************************/
+RenderStats::RenderStats()
+{
+	m_bEnabled = false;
+	m_bLogEverySecond = false;
+	memset(&m_current, 0, sizeof(m_current));
+	memset(&m_lastFrame, 0, sizeof(m_lastFrame));
+	memset(&m_secondTotals, 0, sizeof(m_secondTotals));
+	m_secondFrames = 0;
+	m_cachedUniforms = 0;
+	memset(m_primitiveQueries, 0, sizeof(m_primitiveQueries));
+	memset(m_queryPending, 0, sizeof(m_queryPending));
+	m_bQueryActive = false;
+	m_frameNumber = 0;
+	m_lastTriangles = 0;
+}
+
+/***********************************************************
+ *  Enable()
+ *
+ *  This method is used for creating the triangle counting
+ *  queries and starting to count.
+ ***********************************************************/
+void RenderStats::Enable(bool bLogEverySecond)
+{
+	if (m_bEnabled)
+	{
+		return;
+	}
+
+	glGenQueries(QUERY_LATENCY, m_primitiveQueries);
+	memset(m_queryPending, 0, sizeof(m_queryPending));
+	m_bQueryActive = false;
+	m_bLogEverySecond = bLogEverySecond;
+	m_frameNumber = 0;
+	m_secondFrames = 0;
+	memset(&m_secondTotals, 0, sizeof(m_secondTotals));
+	m_secondStart = std::chrono::steady_clock::now();
+	m_bEnabled = true;
+}
+
+/***********************************************************
+ *  Disable()
+ *
+ *  This method is used for freeing the triangle counting
+ *  queries.
+ ***********************************************************/
+void RenderStats::Disable()
+{
+	if (!m_bEnabled)
+	{
+		return;
+	}
+
+	glDeleteQueries(QUERY_LATENCY, m_primitiveQueries);
+	m_bEnabled = false;
+}
+
+/***********************************************************
+ *  BeginFrame()
+ *
+ *  This method is used for clearing the counters of the new
+ *  frame, reading back the finished triangle counting
+ *  queries without waiting for the GPU and starting the
+ *  query of the new frame.
+ ***********************************************************/
+void RenderStats::BeginFrame()
+{
+	memset(&m_current, 0, sizeof(m_current));
+
+	if (!m_bEnabled)
+	{
+		return;
+	}
+
+	int slot = (int)(m_frameNumber % QUERY_LATENCY);
+
+	// the queries finish in the order they were issued, so the
+	// ring is walked from the oldest one, which is in this slot,
+	// up to the first one the GPU has not finished
+	for (int i = 0; i < QUERY_LATENCY; i++)
+	{
+		int pending = (slot + i) % QUERY_LATENCY;
+		if (!m_queryPending[pending])
+		{
+			continue;
+		}
+
+		GLuint available = 0;
+		glGetQueryObjectuiv(m_primitiveQueries[pending], GL_QUERY_RESULT_AVAILABLE, &available);
+		if (0 == available)
+		{
+			break;
+		}
+
+		GLuint64 triangles = 0;
+		glGetQueryObjectui64v(m_primitiveQueries[pending], GL_QUERY_RESULT, &triangles);
+		m_lastTriangles = triangles;
+		m_queryPending[pending] = false;
+	}
+
+	// restarting a query that is still in flight would throw its
+	// count away, so the frame is not counted instead
+	m_bQueryActive = !m_queryPending[slot];
+	if (m_bQueryActive)
+	{
+		glBeginQuery(GL_PRIMITIVES_GENERATED, m_primitiveQueries[slot]);
+	}
+}
+
+/***********************************************************
+ *  EndFrame()
+ *
+ *  This method is used for finishing the counters of the
+ *  frame and writing the log line once every second.
+ ***********************************************************/
+void RenderStats::EndFrame()
+{
+	if (!m_bEnabled)
+	{
+		m_lastFrame = m_current;
+		return;
+	}
+
+	if (m_bQueryActive)
+	{
+		glEndQuery(GL_PRIMITIVES_GENERATED);
+		m_queryPending[m_frameNumber % QUERY_LATENCY] = true;
+		m_bQueryActive = false;
+	}
+	m_frameNumber++;
+
+	m_current.trianglesSubmitted = m_lastTriangles;
+	m_lastFrame = m_current;
+
+	Accumulate(m_secondTotals, m_current);
+	m_secondFrames++;
+
+	if (m_bLogEverySecond &&
+		(std::chrono::steady_clock::now() - m_secondStart >= std::chrono::seconds(1)))
+	{
+		LogSecond();
+	}
+}
+
+/***********************************************************
+ *  CountUniform()
+ *
+ *  This method is used for counting one uniform upload.  The
+ *  value is compared with the last value that was uploaded
+ *  to the same uniform to find the redundant uploads.  Most
+ *  names are the same string literal every time, so the
+ *  pointer is compared before the characters.
+ ***********************************************************/
+void RenderStats::CountUniform(const char* name, const void* value, size_t size)
+{
+	if (!m_bEnabled)
+	{
+		return;
+	}
+
+	m_current.uniformUploads++;
+
+	if (size > MAX_UNIFORM_SIZE)
+	{
+		return;
+	}
+
+	CACHED_UNIFORM* pUniform = NULL;
+	for (int i = 0; (i < m_cachedUniforms) && (NULL == pUniform); i++)
+	{
+		if ((m_uniforms[i].name == name) || (strcmp(m_uniforms[i].name, name) == 0))
+		{
+			pUniform = &m_uniforms[i];
+		}
+	}
+
+	if (NULL == pUniform)
+	{
+		if (m_cachedUniforms == MAX_CACHED_UNIFORMS)
+		{
+			return;
+		}
+		pUniform = &m_uniforms[m_cachedUniforms];
+		pUniform->name = name;
+		pUniform->size = 0;
+		m_cachedUniforms++;
+	}
+	else if ((pUniform->size == size) && (memcmp(pUniform->value, value, size) == 0))
+	{
+		m_current.redundantUniformUploads++;
+		return;
+	}
+
+	pUniform->size = size;
+	memcpy(pUniform->value, value, size);
+}
+
+/***********************************************************
+ *  Accumulate()
+ *
+ *  This method is used for adding the counters of one frame
+ *  into a set of totals.
+ ***********************************************************/
+void RenderStats::Accumulate(FRAME_STATS& totals, const FRAME_STATS& frame)
+{
+	totals.drawCalls += frame.drawCalls;
+	totals.uniformUploads += frame.uniformUploads;
+	totals.redundantUniformUploads += frame.redundantUniformUploads;
+	totals.samplerUpdates += frame.samplerUpdates;
+	totals.trianglesSubmitted += frame.trianglesSubmitted;
+}
+
+/***********************************************************
+ *  LogSecond()
+ *
+ *  This method is used for writing the per-frame averages of
+ *  the last second and then starting a new second.
+ ***********************************************************/
+void RenderStats::LogSecond()
+{
+	double frames = (m_secondFrames > 0) ? (double)m_secondFrames : 1.0;
+
+	LOG_INFO("STATS: fps:%u, draws:%g, uniforms:%g, redundant uniforms:%g, sampler updates:%g, triangles:%g",
+		m_secondFrames,
+		m_secondTotals.drawCalls / frames,
+		m_secondTotals.uniformUploads / frames,
+		m_secondTotals.redundantUniformUploads / frames,
+		m_secondTotals.samplerUpdates / frames,
+		m_secondTotals.trianglesSubmitted / frames);
+
+	memset(&m_secondTotals, 0, sizeof(m_secondTotals));
+	m_secondFrames = 0;
+	m_secondStart = std::chrono::steady_clock::now();
+}
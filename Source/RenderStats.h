@@ -0,0 +1,109 @@
+///////////////////////////////////////////////////////////////////////////////
+// renderstats.h
+// ============
+// count the OpenGL work that is submitted for every rendered frame
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <GL/glew.h>
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+
+/***********************************************************
+ *  RenderStats
+ *
+ *  This class counts the draw calls, uniform uploads,
+ *  redundant uniform uploads, sampler updates and triangles
+ *  of each frame.  A redundant upload is one that writes the
+ *  same value the uniform was last set to.  The textures stay
+ *  bound to their own units after loading, so a sampler
+ *  update, which points a sampler uniform at another unit,
+ *  is what switches a texture between draws.  The triangle
+ *  count comes from a ring of GL_PRIMITIVES_GENERATED queries
+ *  that are read back once the GPU has finished them, so it
+ *  trails the other counters by a few frames.  A frame whose
+ *  query slot is still in flight is not counted.
+ ***********************************************************/
+class RenderStats
+{
+public:
+	struct FRAME_STATS
+	{
+		uint32_t drawCalls;
+		uint32_t uniformUploads;
+		uint32_t redundantUniformUploads;
+		uint32_t samplerUpdates;
+		uint64_t trianglesSubmitted;
+	};
+
+	// get the single stats instance
+	static RenderStats& Instance();
+
+	// start counting - needs a current OpenGL context
+	void Enable(bool bLogEverySecond);
+	// stop counting and free the queries
+	void Disable();
+	bool IsEnabled() const { return(m_bEnabled); }
+
+	// mark the frame boundaries
+	void BeginFrame();
+	void EndFrame();
+
+	// count one uniform upload and check it against the last value
+	void CountUniform(const char* name, const void* value, size_t size);
+	void CountDraw() { m_current.drawCalls++; }
+	void CountSamplerUpdate() { m_current.samplerUpdates++; }
+	// forget the cached uniform values, e.g. after a program change
+	void ResetUniformCache() { m_cachedUniforms = 0; }
+
+	// counters of the last completed frame
+	const FRAME_STATS& GetLastFrameStats() const { return(m_lastFrame); }
+	// counters of the frame that is being recorded
+	const FRAME_STATS& GetCurrentFrameStats() const { return(m_current); }
+
+private:
+	// constructor
+	RenderStats();
+
+	// most distinct uniforms whose last value is remembered
+	static const int MAX_CACHED_UNIFORMS = 64;
+	// largest uniform value that is remembered - one mat4
+	static const size_t MAX_UNIFORM_SIZE = 64;
+	// number of frames the primitive queries may lag behind
+	static const int QUERY_LATENCY = 4;
+
+	struct CACHED_UNIFORM
+	{
+		const char* name;
+		size_t size;
+		unsigned char value[MAX_UNIFORM_SIZE];
+	};
+
+	bool m_bEnabled;
+	bool m_bLogEverySecond;
+	FRAME_STATS m_current;
+	FRAME_STATS m_lastFrame;
+	// totals of the frames since the last log line
+	FRAME_STATS m_secondTotals;
+	uint32_t m_secondFrames;
+	std::chrono::steady_clock::time_point m_secondStart;
+	// last uploaded value of each uniform
+	CACHED_UNIFORM m_uniforms[MAX_CACHED_UNIFORMS];
+	int m_cachedUniforms;
+	// triangle counting queries
+	GLuint m_primitiveQueries[QUERY_LATENCY];
+	// queries ended but not read back yet
+	bool m_queryPending[QUERY_LATENCY];
+	// the query of the current frame was started
+	bool m_bQueryActive;
+	uint64_t m_frameNumber;
+	uint64_t m_lastTriangles;
+
+	// add the passed in counters into the totals
+	static void Accumulate(FRAME_STATS& totals, const FRAME_STATS& frame);
+	// write the once per second summary line
+	void LogSecond();
+};
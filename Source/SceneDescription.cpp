@@ -0,0 +1,367 @@
+///////////////////////////////////////////////////////////////////////////////
+// scenedescription.cpp
+// ============
+// load the objects of a scene from a text file into flat arrays
+///////////////////////////////////////////////////////////////////////////////
+
+#include "SceneDescription.h"
+#include "SceneManager.h"
+#include "CompositeShapes.h"
+#include "Prefab.h"
+#include "Logger.h"
+
+#include <cstring>
+#include <fstream>
+#include <sstream>
+
+// declaration of global variables and helper functions
+namespace
+{
+	const char* g_KindNames[SceneDescription::KIND_COUNT] =
+	{
+		"ground",
+		"sky",
+		"pyramid_tree",
+		"spherical_tree",
+		"mountain",
+		"cloud"
+	};
+
+	const char* g_MeshNames[SceneManager::MESH_TYPE_COUNT] =
+	{
+		"plane",
+		"cylinder",
+		"sphere",
+		"pyramid3"
+	};
+
+	/***********************************************************
+	 *  FindName()
+	 *
+	 *  This function is used for getting the index of a name
+	 *  in a list of names, or -1 when it is not in the list.
+	 ***********************************************************/
+	int FindName(const std::string& name, const char* const* names, int count)
+	{
+		for (int i = 0; i < count; i++)
+		{
+			if (strcmp(names[i], name.c_str()) == 0)
+			{
+				return(i);
+			}
+		}
+		return(-1);
+	}
+}
+
+/***********************************************************
+ *  Load()
+ *
+ *  This method is used for reading the objects of a scene
+ *  file.  The file is rejected if a line cannot be parsed,
+ *  and the scene is left empty.
+ ***********************************************************/
+bool SceneDescription::Load(const std::string& filename)
+{
+	std::ifstream file(filename.c_str());
+	if (!file.is_open())
+	{
+		LOG_ERROR("Could not open scene file:%s", filename.c_str());
+		return(false);
+	}
+
+	Clear();
+
+	std::string line;
+	int lineNumber = 0;
+	while (std::getline(file, line))
+	{
+		lineNumber++;
+
+		std::istringstream fields(line);
+		std::string keyword;
+		if (!(fields >> keyword) || (keyword[0] == '#'))
+		{
+			continue;
+		}
+
+		bool bParsed = false;
+		glm::vec3 position;
+		float scale = 1.0f;
+
+		if (keyword == "object")
+		{
+			OBJECT object;
+			std::string kind;
+			std::string mesh;
+			bParsed = (fields >> kind >> mesh
+				>> object.scale.x >> object.scale.y >> object.scale.z
+				>> object.rotation.x >> object.rotation.y >> object.rotation.z
+				>> object.position.x >> object.position.y >> object.position.z
+				>> object.color.r >> object.color.g >> object.color.b >> object.color.a
+				>> object.textureTag >> object.materialTag) ? true : false;
+
+			int kindIndex = FindName(kind, g_KindNames, KIND_COUNT);
+			object.mesh = FindName(mesh, g_MeshNames, SceneManager::MESH_TYPE_COUNT);
+			bParsed = bParsed && (kindIndex >= 0) && (object.mesh >= 0);
+			if (bParsed == true)
+			{
+				object.kind = (OBJECT_KIND)kindIndex;
+				if (object.textureTag == "-")
+				{
+					object.textureTag.clear();
+				}
+				AddObject(object);
+			}
+		}
+		else if ((keyword == "planes") || (keyword == "pyramid_tree") || (keyword == "spherical_tree"))
+		{
+			bParsed = (fields >> position.x >> position.y >> position.z) ? true : false;
+			if (bParsed == true)
+			{
+				if (keyword == "planes")
+				{
+					AddPlanes(position.x, position.y, position.z);
+				}
+				else if (keyword == "pyramid_tree")
+				{
+					AddPyramidTree(position.x, position.y, position.z);
+				}
+				else
+				{
+					AddSphericalTree(position.x, position.y, position.z);
+				}
+			}
+		}
+		else if ((keyword == "mountain") || (keyword == "cloud"))
+		{
+			bParsed = (fields >> position.x >> position.y >> position.z >> scale) ? true : false;
+			if (bParsed == true)
+			{
+				if (keyword == "mountain")
+				{
+					AddMountain(position.x, position.y, position.z, scale);
+				}
+				else
+				{
+					AddCloud(position.x, position.y, position.z, scale);
+				}
+			}
+		}
+
+		if (bParsed == false)
+		{
+			LOG_ERROR("Bad scene file line %d:%s", lineNumber, filename.c_str());
+			Clear();
+			return(false);
+		}
+	}
+
+	return(true);
+}
+
+/***********************************************************
+ *  Clear()
+ *
+ *  This method is used for removing every object.
+ ***********************************************************/
+void SceneDescription::Clear()
+{
+	m_kinds.clear();
+	m_meshes.clear();
+	m_scales.clear();
+	m_rotations.clear();
+	m_positions.clear();
+	m_colors.clear();
+	m_textureTags.clear();
+	m_materialTags.clear();
+	m_parents.clear();
+
+	m_instanceTypes.clear();
+	m_instanceRotations.clear();
+	m_instancePositions.clear();
+	m_instanceScales.clear();
+	m_instanceFirstObjects.clear();
+}
+
+/***********************************************************
+ *  AddObject()
+ *
+ *  This method is used for adding one mesh to the end of
+ *  every array.
+ ***********************************************************/
+void SceneDescription::AddObject(const OBJECT& object)
+{
+	m_kinds.push_back(object.kind);
+	m_meshes.push_back(object.mesh);
+	m_scales.push_back(object.scale);
+	m_rotations.push_back(object.rotation);
+	m_positions.push_back(object.position);
+	m_colors.push_back(object.color);
+	m_textureTags.push_back(object.textureTag);
+	m_materialTags.push_back(object.materialTag);
+	m_parents.push_back(-1);
+}
+
+/***********************************************************
+ *  SetTransform()
+ *
+ *  This method is used for replacing the scale, rotation and
+ *  position of one object.
+ ***********************************************************/
+void SceneDescription::SetTransform(size_t index, const glm::vec3& scale, const glm::vec3& rotation, const glm::vec3& position)
+{
+	m_scales[index] = scale;
+	m_rotations[index] = rotation;
+	m_positions[index] = position;
+}
+
+/***********************************************************
+ *  SetInstanceTransform()
+ *
+ *  This method is used for replacing the rotation and
+ *  position of one prefab instance.  Its parts keep their
+ *  own transforms, which are relative to the instance.
+ ***********************************************************/
+void SceneDescription::SetInstanceTransform(size_t instance, const glm::vec3& rotation, const glm::vec3& position)
+{
+	m_instanceRotations[instance] = rotation;
+	m_instancePositions[instance] = position;
+}
+
+/***********************************************************
+ *  AddPrefab()
+ *
+ *  This method is used for adding an instance of a composite
+ *  shape, followed by its parts.  The parts keep the offsets
+ *  and rotations of the shape as their transforms, relative
+ *  to the instance.
+ ***********************************************************/
+void SceneDescription::AddPrefab(int type, const glm::vec3& position, const glm::vec3& rotation, float scale)
+{
+	int instance = (int)m_instanceTypes.size();
+	m_instanceTypes.push_back(type);
+	m_instanceRotations.push_back(rotation);
+	m_instancePositions.push_back(position);
+	m_instanceScales.push_back(scale);
+	m_instanceFirstObjects.push_back((uint32_t)m_kinds.size());
+
+	const COMPOSITE_SHAPE& shape = g_CompositeShapes[type];
+	for (size_t i = 0; i < shape.partCount; i++)
+	{
+		const COMPOSITE_PART& part = shape.pParts[i];
+		float partScale = (part.bScaled == true) ? scale : 1.0f;
+
+		OBJECT object;
+		object.kind = (OBJECT_KIND)part.kind;
+		object.mesh = part.mesh;
+		object.scale = glm::vec3(part.scale[0], part.scale[1], part.scale[2]) * partScale;
+		object.rotation = glm::vec3(part.rotation[0], part.rotation[1], part.rotation[2]);
+		object.position = glm::vec3(part.offset[0], part.offset[1], part.offset[2]);
+		object.color = glm::vec4(part.color[0], part.color[1], part.color[2], part.color[3]);
+		object.textureTag = part.textureTag;
+		object.materialTag = part.materialTag;
+		AddObject(object);
+		m_parents.back() = instance;
+	}
+}
+
+/***********************************************************
+ *  FillTransforms()
+ *
+ *  This method is used for storing the transform of every
+ *  object, with the objects of prefab instances as children
+ *  of their instance.  The parts of an instance are placed
+ *  from the shared local matrices of the prefab, so only the
+ *  instance's own matrix is composed here; the objects that
+ *  are not part of an instance are left dirty.
+ ***********************************************************/
+void SceneDescription::FillTransforms(TransformStore& transforms) const
+{
+	transforms.Resize(m_kinds.size());
+	for (size_t i = 0; i < m_kinds.size(); i++)
+	{
+		transforms.Set((uint32_t)i, m_scales[i], m_rotations[i], m_positions[i]);
+	}
+
+	TransformStore::AFFINE_3X4 locals[Prefab::MAX_PARTS];
+	transforms.ResizeParents(m_instanceTypes.size());
+	for (size_t i = 0; i < m_instanceTypes.size(); i++)
+	{
+		uint32_t instance = (uint32_t)i;
+		transforms.AttachChildren(instance, m_instanceFirstObjects[i], (uint32_t)Prefab::GetPartCount(m_instanceTypes[i]));
+		transforms.SetParentTransform(instance, glm::vec3(1.0f, 1.0f, 1.0f), m_instanceRotations[i], m_instancePositions[i]);
+		Prefab::GetLocals(m_instanceTypes[i], m_instanceScales[i], locals);
+		transforms.SetChildrenComposed(instance, locals);
+	}
+}
+
+/***********************************************************
+ *  AddPlanes()
+ *
+ *  This method is used for adding the ground plane and the
+ *  upright sky plane behind it.
+ ***********************************************************/
+void SceneDescription::AddPlanes(float posx, float posy, float posz)
+{
+	AddPrefab(COMPOSITE_PLANES, glm::vec3(posx, posy, posz), glm::vec3(0.0f, 0.0f, 0.0f), 1.0f);
+}
+
+/***********************************************************
+ *  AddPyramidTree()
+ *
+ *  This method is used for adding a log trunk with three
+ *  stacked pyramids of pine leaves.
+ ***********************************************************/
+void SceneDescription::AddPyramidTree(float posx, float posy, float posz)
+{
+	AddPrefab(COMPOSITE_PYRAMID_TREE, glm::vec3(posx, posy, posz), glm::vec3(0.0f, 0.0f, 0.0f), 1.0f);
+}
+
+/***********************************************************
+ *  AddSphericalTree()
+ *
+ *  This method is used for adding a log trunk topped by a
+ *  small sphere and a large sphere of leaves.
+ ***********************************************************/
+void SceneDescription::AddSphericalTree(float posx, float posy, float posz)
+{
+	AddPrefab(COMPOSITE_SPHERICAL_TREE, glm::vec3(posx, posy, posz), glm::vec3(0.0f, 0.0f, 0.0f), 1.0f);
+}
+
+/***********************************************************
+ *  AddMountain()
+ *
+ *  This method is used for adding a stone pyramid of the
+ *  passed in size.
+ ***********************************************************/
+void SceneDescription::AddMountain(float posx, float posy, float posz, float scale)
+{
+	AddPrefab(COMPOSITE_MOUNTAIN, glm::vec3(posx, posy, posz), glm::vec3(0.0f, 0.0f, 0.0f), scale);
+}
+
+/***********************************************************
+ *  AddCloud()
+ *
+ *  This method is used for adding a cloud made of six
+ *  overlapping spheres.
+ ***********************************************************/
+void SceneDescription::AddCloud(float posx, float posy, float posz, float scale)
+{
+	AddPrefab(COMPOSITE_CLOUD, glm::vec3(posx, posy, posz), glm::vec3(0.0f, 0.0f, 0.0f), scale);
+}
+
+/***********************************************************
+ *  GetKindName()
+ *
+ *  This method is used for getting the scene file name of
+ *  an object kind.
+ ***********************************************************/
+const char* SceneDescription::GetKindName(int kind)
+{
+	if ((kind < 0) || (kind >= KIND_COUNT))
+	{
+		return("");
+	}
+	return(g_KindNames[kind]);
+}
@@ -0,0 +1,148 @@
+///////////////////////////////////////////////////////////////////////////////
+// scenedescription.h
+// ============
+// load the objects of a scene from a text file into flat arrays
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include "TransformStore.h"
+
+#include <glm/glm.hpp>
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/***********************************************************
+ *  SceneDescription
+ *
+ *  This class holds every mesh draw of a scene in parallel
+ *  arrays, one entry per draw, from which the entities of
+ *  the scene world are created without any per-object setup
+ *  code.  A scene file
+ *  is plain text with one entry per line.  Single meshes are
+ *  written as
+ *
+ *    object <kind> <mesh> <sx> <sy> <sz> <rx> <ry> <rz>
+ *           <px> <py> <pz> <r> <g> <b> <a> <texture> <material>
+ *
+ *  on one line, where kind is one of the OBJECT_KIND names,
+ *  mesh is plane, cylinder, sphere or pyramid3, r holds the
+ *  X, Y and Z rotations in degrees and texture is "-" for an
+ *  untextured mesh.  The composite shapes are placed with
+ *
+ *    planes <x> <y> <z>
+ *    pyramid_tree <x> <y> <z>
+ *    spherical_tree <x> <y> <z>
+ *    mountain <x> <y> <z> <scale>
+ *    cloud <x> <y> <z> <scale>
+ *
+ *  and are added as prefab instances - each of their meshes
+ *  is a child of the instance, with a transform relative to
+ *  the instance's position and rotation.  Blank lines and
+ *  lines starting with '#' are ignored.
+ ***********************************************************/
+class SceneDescription
+{
+public:
+	// what an object is part of - selects the profiler zone,
+	// GPU category and pipeline statistics group it is drawn in
+	enum OBJECT_KIND
+	{
+		KIND_GROUND = 0,
+		KIND_SKY,
+		KIND_PYRAMID_TREE,
+		KIND_SPHERICAL_TREE,
+		KIND_MOUNTAIN,
+		KIND_CLOUD,
+		KIND_COUNT
+	};
+
+	struct OBJECT
+	{
+		OBJECT_KIND kind;
+		// a SceneManager::MESH_TYPE
+		int mesh;
+		glm::vec3 scale;
+		// X, Y and Z rotations in degrees
+		glm::vec3 rotation;
+		glm::vec3 position;
+		glm::vec4 color;
+		// empty for an untextured object
+		std::string textureTag;
+		std::string materialTag;
+	};
+
+	// replace the objects with the ones of a scene file
+	bool Load(const std::string& filename);
+	// remove every object
+	void Clear();
+
+	// add a single mesh
+	void AddObject(const OBJECT& object);
+	// add an instance of a COMPOSITE_TYPE shape with its parts
+	// as children - the scale only sizes the parts that take it
+	void AddPrefab(int type, const glm::vec3& position, const glm::vec3& rotation, float scale);
+	// add the composite shapes with their parts around the
+	// passed in position
+	void AddPlanes(float posx, float posy, float posz);
+	void AddPyramidTree(float posx, float posy, float posz);
+	void AddSphericalTree(float posx, float posy, float posz);
+	void AddMountain(float posx, float posy, float posz, float scale);
+	void AddCloud(float posx, float posy, float posz, float scale);
+
+	size_t GetCount() const { return(m_kinds.size()); }
+
+	// move, turn or resize one object - relative to its prefab
+	// instance when it has one
+	void SetTransform(size_t index, const glm::vec3& scale, const glm::vec3& rotation, const glm::vec3& position);
+	// move or turn a prefab instance together with its parts
+	void SetInstanceTransform(size_t instance, const glm::vec3& rotation, const glm::vec3& position);
+	// fill a transform store with every object and instance, the
+	// parts of the instances already composed
+	void FillTransforms(TransformStore& transforms) const;
+
+	// per-object arrays, all GetCount() long
+	const std::vector<int>& GetKinds() const { return(m_kinds); }
+	const std::vector<int>& GetMeshes() const { return(m_meshes); }
+	const std::vector<glm::vec3>& GetScales() const { return(m_scales); }
+	const std::vector<glm::vec3>& GetRotations() const { return(m_rotations); }
+	const std::vector<glm::vec3>& GetPositions() const { return(m_positions); }
+	const std::vector<glm::vec4>& GetColors() const { return(m_colors); }
+	// prefab instance of every object, -1 for none
+	const std::vector<int>& GetParents() const { return(m_parents); }
+	// the tags are only needed once, to resolve them into the
+	// texture slots and material indices of the scene
+	const std::vector<std::string>& GetTextureTags() const { return(m_textureTags); }
+	const std::vector<std::string>& GetMaterialTags() const { return(m_materialTags); }
+
+	// prefab instance arrays, all GetInstanceCount() long - the
+	// parts of an instance are the objects from its first object
+	// on, as many as the prefab has
+	size_t GetInstanceCount() const { return(m_instanceTypes.size()); }
+	const std::vector<int>& GetInstanceTypes() const { return(m_instanceTypes); }
+	const std::vector<glm::vec3>& GetInstanceRotations() const { return(m_instanceRotations); }
+	const std::vector<glm::vec3>& GetInstancePositions() const { return(m_instancePositions); }
+	const std::vector<float>& GetInstanceScales() const { return(m_instanceScales); }
+	const std::vector<uint32_t>& GetInstanceFirstObjects() const { return(m_instanceFirstObjects); }
+
+	static const char* GetKindName(int kind);
+
+private:
+	std::vector<int> m_kinds;
+	std::vector<int> m_meshes;
+	std::vector<glm::vec3> m_scales;
+	std::vector<glm::vec3> m_rotations;
+	std::vector<glm::vec3> m_positions;
+	std::vector<glm::vec4> m_colors;
+	std::vector<std::string> m_textureTags;
+	std::vector<std::string> m_materialTags;
+	std::vector<int> m_parents;
+
+	std::vector<int> m_instanceTypes;
+	std::vector<glm::vec3> m_instanceRotations;
+	std::vector<glm::vec3> m_instancePositions;
+	std::vector<float> m_instanceScales;
+	std::vector<uint32_t> m_instanceFirstObjects;
+};
@@ -0,0 +1,292 @@
+///////////////////////////////////////////////////////////////////////////////
+// scenehelperbenchmark.cpp
+// ============
+// microbenchmarks for the SceneManager helpers that run for every draw
+///////////////////////////////////////////////////////////////////////////////
+
+#include "SceneHelperBenchmark.h"
+#include "TagHash.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+
+// declaration of global variables and helper functions
+namespace
+{
+	// each measurement is repeated and the fastest run is kept
+	const int REPEAT_COUNT = 5;
+
+	// parameter ranges of the benchmarks
+	const int TEXTURE_COUNTS[] = { 1, 4, 16 };
+	const int MATERIAL_COUNTS[] = { 1, 8, 64, 256 };
+	const int OBJECT_COUNTS[] = { 1000, 10000, 100000 };
+
+	// results are folded into this value so the timed calls
+	// cannot be optimized away
+	volatile int g_Sink = 0;
+
+	typedef std::chrono::steady_clock Clock;
+
+	/***********************************************************
+	 *  MakeTag()
+	 *
+	 *  This function is used for building the tag string of the
+	 *  numbered texture or material.
+	 ***********************************************************/
+	std::string MakeTag(const char* prefix, int index)
+	{
+		char tag[32];
+		snprintf(tag, sizeof(tag), "%s%d", prefix, index);
+		return(std::string(tag));
+	}
+
+	/***********************************************************
+	 *  NsPerCall()
+	 *
+	 *  This function is used for converting a timed run into
+	 *  nanoseconds per call.
+	 ***********************************************************/
+	double NsPerCall(Clock::time_point start, Clock::time_point end, int calls)
+	{
+		return(std::chrono::duration<double, std::nano>(end - start).count() / calls);
+	}
+}
+
+/***********************************************************
+ *  AddTextures()
+ *
+ *  This method is used for registering the passed in number
+ *  of tagged textures without loading any image data.
+ ***********************************************************/
+void SceneHelperBenchmark::AddTextures(SceneManager& scene, int count)
+{
+	for (int i = 0; i < count; i++)
+	{
+		scene.m_textureIDs[i].tag = MakeTag("texture", i);
+		scene.m_textureIDs[i].ID = i + 1;
+	}
+	scene.m_loadedTextures = count;
+}
+
+/***********************************************************
+ *  AddMaterials()
+ *
+ *  This method is used for defining the passed in number of
+ *  tagged materials.
+ ***********************************************************/
+void SceneHelperBenchmark::AddMaterials(SceneManager& scene, int count)
+{
+	for (int i = 0; i < count; i++)
+	{
+		SceneManager::OBJECT_MATERIAL material;
+		material.diffuseColor = glm::vec3(0.5f, 0.5f, 0.5f);
+		material.specularColor = glm::vec3(0.1f, 0.1f, 0.1f);
+		material.shininess = (float)i;
+		material.tag = MakeTag("material", i);
+		scene.m_objectMaterials.push_back(material);
+	}
+}
+
+/***********************************************************
+ *  RunTransformations()
+ *
+ *  This method is used for timing SetTransformations with a
+ *  different transform for every object.
+ ***********************************************************/
+void SceneHelperBenchmark::RunTransformations(int objects)
+{
+	SceneManager scene(NULL);
+	double best = 0.0;
+
+	for (int repeat = 0; repeat < REPEAT_COUNT; repeat++)
+	{
+		Clock::time_point start = Clock::now();
+		for (int i = 0; i < objects; i++)
+		{
+			float value = (float)(i & 255);
+			scene.SetTransformations(
+				glm::vec3(1.0f + value, 2.0f, 3.0f),
+				value, 15.0f, 0.0f,
+				glm::vec3(value, 0.0f, -value));
+		}
+		Clock::time_point end = Clock::now();
+
+		double ns = NsPerCall(start, end, objects);
+		best = (repeat == 0) ? ns : std::min(best, ns);
+	}
+
+	RESULT result = { "SetTransformations", 0, 0, objects, best };
+	m_results.push_back(result);
+}
+
+/***********************************************************
+ *  RunTextureLookups()
+ *
+ *  This method is used for timing FindTextureSlot and
+ *  FindTextureID.  The looked up tags cycle through all of
+ *  the registered textures.
+ ***********************************************************/
+void SceneHelperBenchmark::RunTextureLookups(int textures, int objects)
+{
+	SceneManager scene(NULL);
+	AddTextures(scene, textures);
+
+	std::vector<std::string> tags;
+	for (int i = 0; i < textures; i++)
+	{
+		tags.push_back(MakeTag("texture", i));
+	}
+
+	double bestSlot = 0.0;
+	double bestID = 0.0;
+	for (int repeat = 0; repeat < REPEAT_COUNT; repeat++)
+	{
+		Clock::time_point start = Clock::now();
+		for (int i = 0; i < objects; i++)
+		{
+			g_Sink += scene.FindTextureSlot(tags[i % textures]);
+		}
+		Clock::time_point middle = Clock::now();
+		for (int i = 0; i < objects; i++)
+		{
+			g_Sink += scene.FindTextureID(tags[i % textures]);
+		}
+		Clock::time_point end = Clock::now();
+
+		double slotNs = NsPerCall(start, middle, objects);
+		double idNs = NsPerCall(middle, end, objects);
+		bestSlot = (repeat == 0) ? slotNs : std::min(bestSlot, slotNs);
+		bestID = (repeat == 0) ? idNs : std::min(bestID, idNs);
+	}
+
+	RESULT slotResult = { "FindTextureSlot", textures, 0, objects, bestSlot };
+	RESULT idResult = { "FindTextureID", textures, 0, objects, bestID };
+	m_results.push_back(slotResult);
+	m_results.push_back(idResult);
+}
+
+/***********************************************************
+ *  RunMaterialLookups()
+ *
+ *  This method is used for timing FindMaterial, which looks
+ *  up a tag, and SetShaderMaterial, which takes the handle
+ *  the tag was resolved to once.
+ ***********************************************************/
+void SceneHelperBenchmark::RunMaterialLookups(int materials, int objects)
+{
+	SceneManager scene(NULL);
+	AddMaterials(scene, materials);
+
+	std::vector<std::string> tags;
+	std::vector<SceneManager::MATERIAL_HANDLE> handles;
+	for (int i = 0; i < materials; i++)
+	{
+		tags.push_back(MakeTag("material", i));
+		handles.push_back(scene.ResolveMaterial(HashTag(tags.back().c_str())));
+	}
+
+	double bestFind = 0.0;
+	double bestSet = 0.0;
+	for (int repeat = 0; repeat < REPEAT_COUNT; repeat++)
+	{
+		SceneManager::OBJECT_MATERIAL material;
+
+		Clock::time_point start = Clock::now();
+		for (int i = 0; i < objects; i++)
+		{
+			g_Sink += scene.FindMaterial(tags[i % materials], material) ? 1 : 0;
+		}
+		Clock::time_point middle = Clock::now();
+		for (int i = 0; i < objects; i++)
+		{
+			scene.SetShaderMaterial(handles[i % materials]);
+		}
+		Clock::time_point end = Clock::now();
+
+		double findNs = NsPerCall(start, middle, objects);
+		double setNs = NsPerCall(middle, end, objects);
+		bestFind = (repeat == 0) ? findNs : std::min(bestFind, findNs);
+		bestSet = (repeat == 0) ? setNs : std::min(bestSet, setNs);
+	}
+
+	RESULT findResult = { "FindMaterial", 0, materials, objects, bestFind };
+	RESULT setResult = { "SetShaderMaterial", 0, materials, objects, bestSet };
+	m_results.push_back(findResult);
+	m_results.push_back(setResult);
+}
+
+/***********************************************************
+ *  Run()
+ *
+ *  This method is used for running every helper benchmark
+ *  over every parameter combination.
+ ***********************************************************/
+void SceneHelperBenchmark::Run()
+{
+	m_results.clear();
+
+	for (size_t o = 0; o < sizeof(OBJECT_COUNTS) / sizeof(OBJECT_COUNTS[0]); o++)
+	{
+		RunTransformations(OBJECT_COUNTS[o]);
+
+		for (size_t t = 0; t < sizeof(TEXTURE_COUNTS) / sizeof(TEXTURE_COUNTS[0]); t++)
+		{
+			RunTextureLookups(TEXTURE_COUNTS[t], OBJECT_COUNTS[o]);
+		}
+		for (size_t m = 0; m < sizeof(MATERIAL_COUNTS) / sizeof(MATERIAL_COUNTS[0]); m++)
+		{
+			RunMaterialLookups(MATERIAL_COUNTS[m], OBJECT_COUNTS[o]);
+		}
+	}
+}
+
+/***********************************************************
+ *  WriteReport()
+ *
+ *  This method is used for writing the JSON report to the
+ *  passed in file path, or to stdout if the path is a single
+ *  dash.
+ ***********************************************************/
+bool SceneHelperBenchmark::WriteReport(const std::string& reportPath) const
+{
+	if (reportPath == "-")
+	{
+		WriteReportJSON(std::cout);
+		return(true);
+	}
+
+	std::ofstream file(reportPath.c_str());
+	if (!file.is_open())
+	{
+		std::cerr << "Could not open benchmark report file:" << reportPath << std::endl;
+		return(false);
+	}
+
+	WriteReportJSON(file);
+	return(file.good());
+}
+
+/***********************************************************
+ *  WriteReportJSON()
+ *
+ *  This method is used for writing one JSON entry for every
+ *  measured helper and parameter combination.
+ ***********************************************************/
+void SceneHelperBenchmark::WriteReportJSON(std::ostream& out) const
+{
+	out << "{\n  \"microbenchmarks\": [\n";
+	for (size_t i = 0; i < m_results.size(); i++)
+	{
+		const RESULT& result = m_results[i];
+		out << "    { \"helper\": \"" << result.helper << "\""
+			<< ", \"textures\": " << result.textures
+			<< ", \"materials\": " << result.materials
+			<< ", \"objects\": " << result.objects
+			<< ", \"ns_per_call\": " << result.nsPerCall << " }"
+			<< ((i + 1 < m_results.size()) ? ",\n" : "\n");
+	}
+	out << "  ]\n}" << std::endl;
+}
@@ -0,0 +1,56 @@
+///////////////////////////////////////////////////////////////////////////////
+// scenehelperbenchmark.h
+// ============
+// microbenchmarks for the SceneManager helpers that run for every draw
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include "SceneManager.h"
+
+#include <ostream>
+#include <string>
+#include <vector>
+
+/***********************************************************
+ *  SceneHelperBenchmark
+ *
+ *  This class times SetTransformations, FindTextureSlot,
+ *  FindTextureID, FindMaterial and SetShaderMaterial over a
+ *  range of texture counts, material counts and object
+ *  counts.  The scene managers are created without a shader
+ *  manager, so every upload is counted but never reaches
+ *  OpenGL and no context is needed.
+ ***********************************************************/
+class SceneHelperBenchmark
+{
+public:
+	struct RESULT
+	{
+		const char* helper;
+		int textures;
+		int materials;
+		int objects;
+		// fastest time of the repeated runs
+		double nsPerCall;
+	};
+
+	// run every helper over every parameter combination
+	void Run();
+	// write the JSON report to a file, or stdout for "-"
+	bool WriteReport(const std::string& reportPath) const;
+
+private:
+	std::vector<RESULT> m_results;
+
+	// fill a scene manager with the passed in number of tags
+	static void AddTextures(SceneManager& scene, int count);
+	static void AddMaterials(SceneManager& scene, int count);
+
+	void RunTransformations(int objects);
+	void RunTextureLookups(int textures, int objects);
+	void RunMaterialLookups(int materials, int objects);
+
+	// write the JSON report into the passed in stream
+	void WriteReportJSON(std::ostream& out) const;
+};
@@ -8,6 +8,17 @@
 ///////////////////////////////////////////////////////////////////////////////
 
 #include "SceneManager.h"
+#include "FrameProfiler.h"
+#include "RenderStats.h"
+#include "StartupTimer.h"
+#include "PipelineStats.h"
+#include "CategoryTimer.h"
+#include "Logger.h"
+#include "MemoryStats.h"
+#include "BakedScene.h"
+#include "Prefab.h"
+#include "CompiledScene.h"
+#include "TagHash.h"
 
 #ifndef STB_IMAGE_IMPLEMENTATION
 #define STB_IMAGE_IMPLEMENTATION
@@ -15,6 +26,9 @@
 #endif
 
 #include <glm/gtx/transform.hpp>
+#include <glm/gtc/type_ptr.hpp>
+
+#include <cstring>
 
 // declaration of global variables
 namespace
@@ -24,6 +38,68 @@ namespace
 	const char* g_TextureValueName = "objectTexture";
 	const char* g_UseTextureName = "bUseTexture";
 	const char* g_UseLightingName = "bUseLighting";
+	const char* g_ObjectModelsName = "objectModels";
+	const char* g_ObjectIndexName = "objectIndex";
+	const char* g_UseObjectBufferName = "bUseObjectBuffer";
+
+	// the object buffer is bound after the scene texture slots
+	const int OBJECT_BUFFER_TEXTURE_UNIT = 16;
+
+	/***********************************************************
+	 *  ComposeModelMatrix()
+	 *
+	 *  This function is used for building a model matrix that
+	 *  scales, then rotates about X, Y and Z, then translates.
+	 ***********************************************************/
+	glm::mat4 ComposeModelMatrix(
+		const glm::vec3& scaleXYZ,
+		float XrotationDegrees,
+		float YrotationDegrees,
+		float ZrotationDegrees,
+		const glm::vec3& positionXYZ)
+	{
+		// variables for this function
+		glm::mat4 scale;
+		glm::mat4 rotationX;
+		glm::mat4 rotationY;
+		glm::mat4 rotationZ;
+		glm::mat4 translation;
+
+		// set the scale value in the transform buffer
+		scale = glm::scale(scaleXYZ);
+		// set the rotation values in the transform buffer
+		rotationX = glm::rotate(glm::radians(XrotationDegrees), glm::vec3(1.0f, 0.0f, 0.0f));
+		rotationY = glm::rotate(glm::radians(YrotationDegrees), glm::vec3(0.0f, 1.0f, 0.0f));
+		rotationZ = glm::rotate(glm::radians(ZrotationDegrees), glm::vec3(0.0f, 0.0f, 1.0f));
+		// set the translation value in the transform buffer
+		translation = glm::translate(positionXYZ);
+
+		return(translation * rotationZ * rotationY * rotationX * scale);
+	}
+
+	// scene file loaded when no other file is set
+	const char* g_DefaultSceneFile = "scenes/default.scene";
+
+	// GPU category and pipeline statistics group of each
+	// SceneDescription::OBJECT_KIND
+	const CategoryTimer::CATEGORY g_KindCategories[SceneDescription::KIND_COUNT] =
+	{
+		CategoryTimer::CATEGORY_PLANES,
+		CategoryTimer::CATEGORY_PLANES,
+		CategoryTimer::CATEGORY_PYRAMID_TREES,
+		CategoryTimer::CATEGORY_SPHERICAL_TREES,
+		CategoryTimer::CATEGORY_MOUNTAINS,
+		CategoryTimer::CATEGORY_CLOUDS
+	};
+	const PipelineStats::RENDER_GROUP g_KindGroups[SceneDescription::KIND_COUNT] =
+	{
+		PipelineStats::GROUP_GROUND,
+		PipelineStats::GROUP_SKY,
+		PipelineStats::GROUP_TREES,
+		PipelineStats::GROUP_TREES,
+		PipelineStats::GROUP_MOUNTAINS,
+		PipelineStats::GROUP_CLOUDS
+	};
 }
 
 /***********************************************************
@@ -35,6 +111,18 @@ SceneManager::SceneManager(ShaderManager *pShaderManager)
 {
 	m_pShaderManager = pShaderManager;
 	m_basicMeshes = new ShapeMeshes();
+	m_loadedTextures = 0;
+	m_pRecorder = NULL;
+	m_streamCellSize = 0.0f;
+	m_streamRadius = 0.0f;
+	m_streamBudgetBytes = 0;
+	m_cameraPosition = glm::vec3(0.0f, 0.0f, 0.0f);
+	m_sceneFile = g_DefaultSceneFile;
+	m_pStressScene = NULL;
+	m_bBakedScene = false;
+	m_uniformLocationCount = 0;
+	memset(m_accountedBytes, 0, sizeof(m_accountedBytes));
+	memset(m_accountedObjects, 0, sizeof(m_accountedObjects));
 }
 
 /***********************************************************
@@ -47,6 +135,109 @@ SceneManager::~SceneManager()
 	m_pShaderManager = NULL;
 	delete m_basicMeshes;
 	m_basicMeshes = NULL;
+	m_streamer.Stop();
+	m_objectBuffer.Destroy();
+
+	// take the memory of this scene back out of the totals
+	for (int i = 0; i < MemoryStats::CATEGORY_COUNT; i++)
+	{
+		MemoryStats::Instance().Remove((MemoryStats::CATEGORY)i, m_accountedBytes[i], m_accountedObjects[i]);
+	}
+}
+
+/***********************************************************
+ *  AccountMemory()
+ *
+ *  This method is used for counting memory into the memory
+ *  stats and remembering it for the destructor.
+ ***********************************************************/
+void SceneManager::AccountMemory(MemoryStats::CATEGORY category, uint64_t bytes, uint32_t objects)
+{
+	MemoryStats::Instance().Add(category, bytes, objects);
+	m_accountedBytes[category] += bytes;
+	m_accountedObjects[category] += objects;
+}
+
+/***********************************************************
+ *  AccountMeshMemory()
+ *
+ *  This method is used for counting the GPU memory of the
+ *  buffers of the mesh that was just loaded, whose vertex
+ *  array is still bound.
+ ***********************************************************/
+void SceneManager::AccountMeshMemory()
+{
+	uint32_t buffers = 0;
+	uint64_t bytes = MemoryStats::VertexArrayBytes(buffers);
+	AccountMemory(MemoryStats::GPU_MESH_BUFFERS, bytes, buffers);
+}
+
+/***********************************************************
+ *  AccountObjectBufferMemory()
+ *
+ *  This method is used for replacing the counted size of the
+ *  object buffer with its current size, after it was created
+ *  or has grown.
+ ***********************************************************/
+void SceneManager::AccountObjectBufferMemory()
+{
+	const MemoryStats::CATEGORY category = MemoryStats::GPU_OBJECT_BUFFER;
+	uint64_t bytes = m_objectBuffer.GetBufferBytes();
+	if (bytes == m_accountedBytes[category])
+	{
+		return;
+	}
+
+	MemoryStats::Instance().Remove(category, m_accountedBytes[category], m_accountedObjects[category]);
+	m_accountedBytes[category] = 0;
+	m_accountedObjects[category] = 0;
+	AccountMemory(category, bytes, (m_objectBuffer.IsCreated() == true) ? 1 : 0);
+}
+
+/***********************************************************
+ *  AccountContainerMemory()
+ *
+ *  This method is used for counting the CPU memory of the
+ *  material list and the texture table, including the heap
+ *  storage of their tag strings, and of the scene object
+ *  arrays.
+ ***********************************************************/
+void SceneManager::AccountContainerMemory()
+{
+	uint64_t materialBytes = m_objectMaterials.capacity() * sizeof(OBJECT_MATERIAL);
+	for (size_t i = 0; i < m_objectMaterials.size(); i++)
+	{
+		materialBytes += m_objectMaterials[i].tag.capacity();
+	}
+	AccountMemory(MemoryStats::CPU_MATERIALS, materialBytes, (uint32_t)m_objectMaterials.size());
+
+	uint64_t textureTableBytes = sizeof(m_textureIDs);
+	for (int i = 0; i < m_loadedTextures; i++)
+	{
+		textureTableBytes += m_textureIDs[i].tag.capacity();
+	}
+	AccountMemory(MemoryStats::CPU_TEXTURE_TABLE, textureTableBytes, (uint32_t)m_loadedTextures);
+
+	uint64_t sceneBytes =
+		m_scene.GetKinds().capacity() * sizeof(int) +
+		m_scene.GetMeshes().capacity() * sizeof(int) +
+		m_scene.GetScales().capacity() * sizeof(glm::vec3) +
+		m_scene.GetRotations().capacity() * sizeof(glm::vec3) +
+		m_scene.GetPositions().capacity() * sizeof(glm::vec3) +
+		m_scene.GetColors().capacity() * sizeof(glm::vec4) +
+		m_scene.GetTextureTags().capacity() * sizeof(std::string) +
+		m_scene.GetMaterialTags().capacity() * sizeof(std::string) +
+		m_scene.GetParents().capacity() * sizeof(int) +
+		m_scene.GetInstanceTypes().capacity() * sizeof(int) +
+		m_scene.GetInstanceRotations().capacity() * sizeof(glm::vec3) +
+		m_scene.GetInstancePositions().capacity() * sizeof(glm::vec3) +
+		m_scene.GetInstanceScales().capacity() * sizeof(float) +
+		m_scene.GetInstanceFirstObjects().capacity() * sizeof(uint32_t) +
+		m_world.GetMemoryBytes() +
+		m_compiledScene.GetMappedBytes() +
+		(m_compiledTextureSlots.capacity() + m_compiledMaterialIndices.capacity()) * sizeof(int);
+	uint32_t sceneObjects = m_compiledScene.IsOpen() ? m_compiledScene.GetCount() : (uint32_t)m_scene.GetCount();
+	AccountMemory(MemoryStats::CPU_SCENE_OBJECTS, sceneBytes, sceneObjects);
 }
 
 /***********************************************************
@@ -64,21 +255,35 @@ bool SceneManager::CreateGLTexture(const char* filename, std::string tag)
 	int colorChannels = 0;
 	GLuint textureID = 0;
 
+	STARTUP_PHASE(std::string("CreateGLTexture ") + filename);
+
+	// handles are resolved from tag hashes, so no two tags may
+	// share one
+	if (ResolveTexture(HashTag(tag.c_str())) >= 0)
+	{
+		LOG_ERROR("Texture tag is already used or has the hash of another tag:%s", tag.c_str());
+		return false;
+	}
+
 	// indicate to always flip images vertically when loaded
 	stbi_set_flip_vertically_on_load(true);
 
 	// try to parse the image data from the specified image file
-	unsigned char* image = stbi_load(
-		filename,
-		&width,
-		&height,
-		&colorChannels,
-		0);
+	unsigned char* image = NULL;
+	{
+		STARTUP_PHASE("Decode");
+		image = stbi_load(
+			filename,
+			&width,
+			&height,
+			&colorChannels,
+			0);
+	}
 
 	// if the image was successfully read from the image file
 	if (image)
 	{
-		std::cout << "Successfully loaded image:" << filename << ", width:" << width << ", height:" << height << ", channels:" << colorChannels << std::endl;
+		LOG_INFO("Successfully loaded image:%s, width:%d, height:%d, channels:%d", filename, width, height, colorChannels);
 
 		glGenTextures(1, &textureID);
 		glBindTexture(GL_TEXTURE_2D, textureID);
@@ -90,25 +295,44 @@ bool SceneManager::CreateGLTexture(const char* filename, std::string tag)
 		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
 		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
 
-		// if the loaded image is in RGB format
-		if (colorChannels == 3)
-			glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB8, width, height, 0, GL_RGB, GL_UNSIGNED_BYTE, image);
-		// if the loaded image is in RGBA format - it supports transparency
-		else if (colorChannels == 4)
-			glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, width, height, 0, GL_RGBA, GL_UNSIGNED_BYTE, image);
-		else
 		{
-			std::cout << "Not implemented to handle image with " << colorChannels << " channels" << std::endl;
-			return false;
+			STARTUP_PHASE("Upload");
+
+			// if the loaded image is in RGB format
+			if (colorChannels == 3)
+				glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB8, width, height, 0, GL_RGB, GL_UNSIGNED_BYTE, image);
+			// if the loaded image is in RGBA format - it supports transparency
+			else if (colorChannels == 4)
+				glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, width, height, 0, GL_RGBA, GL_UNSIGNED_BYTE, image);
+			else
+			{
+				LOG_ERROR("Not implemented to handle image with %d channels", colorChannels);
+				stbi_image_free(image);
+				glBindTexture(GL_TEXTURE_2D, 0);
+				glDeleteTextures(1, &textureID);
+				return false;
+			}
+		}
+
+		{
+			STARTUP_PHASE("GenerateMipmap");
+
+			// generate the texture mipmaps for mapping textures to lower resolutions
+			glGenerateMipmap(GL_TEXTURE_2D);
 		}
 
-		// generate the texture mipmaps for mapping textures to lower resolutions
-		glGenerateMipmap(GL_TEXTURE_2D);
+		// the mipmaps add about a third to the size of the image
+		AccountMemory(MemoryStats::GPU_TEXTURES, MemoryStats::TextureBytes(width, height, colorChannels), 1);
 
 		// free the image data from local memory
 		stbi_image_free(image);
 		glBindTexture(GL_TEXTURE_2D, 0); // Unbind the texture
 
+		if (NULL != m_pRecorder)
+		{
+			m_pRecorder->RecordTexture(m_loadedTextures, width, height, colorChannels);
+		}
+
 		// register the loaded texture and associate it with the special tag string
 		m_textureIDs[m_loadedTextures].ID = textureID;
 		m_textureIDs[m_loadedTextures].tag = tag;
@@ -117,7 +341,7 @@ bool SceneManager::CreateGLTexture(const char* filename, std::string tag)
 		return true;
 	}
 
-	std::cout << "Could not load image:" << filename << std::endl;
+	LOG_ERROR("Could not load image:%s", filename);
 
 	// Error loading the image
 	return false;
@@ -149,7 +373,8 @@ void SceneManager::DestroyGLTextures()
 {
 	for (int i = 0; i < m_loadedTextures; i++)
 	{
-		glGenTextures(1, &m_textureIDs[i].ID);
+		glDeleteTextures(1, &m_textureIDs[i].ID);
+		m_textureIDs[i].ID = 0;
 	}
 }
 
@@ -159,50 +384,35 @@ void SceneManager::DestroyGLTextures()
  *  This method is used for getting an ID for the previously
  *  loaded texture bitmap associated with the passed in tag.
  ***********************************************************/
-int SceneManager::FindTextureID(std::string tag)
+int SceneManager::FindTextureID(const std::string& tag)
 {
-	int textureID = -1;
-	int index = 0;
-	bool bFound = false;
-
-	while ((index < m_loadedTextures) && (bFound == false))
+	int textureSlot = FindTextureSlot(tag);
+	if (textureSlot < 0)
 	{
-		if (m_textureIDs[index].tag.compare(tag) == 0)
-		{
-			textureID = m_textureIDs[index].ID;
-			bFound = true;
-		}
-		else
-			index++;
+		return(-1);
 	}
 
-	return(textureID);
+	return(m_textureIDs[textureSlot].ID);
 }
 
 /***********************************************************
  *  FindTextureSlot()
  *
  *  This method is used for getting a slot index for the previously
- *  loaded texture bitmap associated with the passed in tag.
+ *  loaded texture bitmap associated with the passed in tag.  The
+ *  slot is also the texture's handle.
  ***********************************************************/
-int SceneManager::FindTextureSlot(std::string tag)
+int SceneManager::FindTextureSlot(const std::string& tag)
 {
-	int textureSlot = -1;
-	int index = 0;
-	bool bFound = false;
-
-	while ((index < m_loadedTextures) && (bFound == false))
+	for (int index = 0; index < m_loadedTextures; index++)
 	{
-		if (m_textureIDs[index].tag.compare(tag) == 0)
+		if (m_textureIDs[index].tag == tag)
 		{
-			textureSlot = index;
-			bFound = true;
+			return(index);
 		}
-		else
-			index++;
 	}
 
-	return(textureSlot);
+	return(-1);
 }
 
 /***********************************************************
@@ -211,31 +421,266 @@ int SceneManager::FindTextureSlot(std::string tag)
  *  This method is used for getting a material from the previously
  *  defined materials list that is associated with the passed in tag.
  ***********************************************************/
-bool SceneManager::FindMaterial(std::string tag, OBJECT_MATERIAL& material)
+bool SceneManager::FindMaterial(const std::string& tag, OBJECT_MATERIAL& material)
 {
-	if (m_objectMaterials.size() == 0)
+	int index = FindMaterialIndex(tag);
+	if (index < 0)
 	{
 		return(false);
 	}
 
-	int index = 0;
-	bool bFound = false;
-	while ((index < m_objectMaterials.size()) && (bFound == false))
+	material.diffuseColor = m_objectMaterials[index].diffuseColor;
+	material.specularColor = m_objectMaterials[index].specularColor;
+	material.shininess = m_objectMaterials[index].shininess;
+	return(true);
+}
+
+/***********************************************************
+ *  FindMaterialIndex()
+ *
+ *  This method is used for getting the index of the defined
+ *  material associated with the passed in tag, which is also
+ *  the material's handle.
+ ***********************************************************/
+int SceneManager::FindMaterialIndex(const std::string& tag)
+{
+	for (size_t index = 0; index < m_objectMaterials.size(); index++)
+	{
+		if (m_objectMaterials[index].tag == tag)
+		{
+			return((int)index);
+		}
+	}
+
+	return(-1);
+}
+
+/***********************************************************
+ *  ResolveTexture()
+ *
+ *  This method is used for getting the handle of the loaded
+ *  texture whose tag has the passed in hash.
+ ***********************************************************/
+SceneManager::TEXTURE_HANDLE SceneManager::ResolveTexture(uint32_t tagHash) const
+{
+	for (int index = 0; index < m_loadedTextures; index++)
 	{
-		if (m_objectMaterials[index].tag.compare(tag) == 0)
+		if (HashTag(m_textureIDs[index].tag.c_str()) == tagHash)
 		{
-			bFound = true;
-			material.diffuseColor = m_objectMaterials[index].diffuseColor;
-			material.specularColor = m_objectMaterials[index].specularColor;
-			material.shininess = m_objectMaterials[index].shininess;
+			return(index);
 		}
-		else
+	}
+
+	return(-1);
+}
+
+/***********************************************************
+ *  ResolveMaterial()
+ *
+ *  This method is used for getting the handle of the defined
+ *  material whose tag has the passed in hash.
+ ***********************************************************/
+SceneManager::MATERIAL_HANDLE SceneManager::ResolveMaterial(uint32_t tagHash) const
+{
+	for (size_t index = 0; index < m_objectMaterials.size(); index++)
+	{
+		if (HashTag(m_objectMaterials[index].tag.c_str()) == tagHash)
 		{
-			index++;
+			return((int)index);
 		}
 	}
 
-	return(true);
+	return(-1);
+}
+
+/***********************************************************
+ *  GetUniformLocation()
+ *
+ *  This method is used for getting the location of a uniform
+ *  in the shader program.  The location is looked up once
+ *  and remembered with the name.  Most names are the same
+ *  string literal every time, so every entry is first
+ *  compared by pointer, and the characters are only compared
+ *  when no pointer matches.  Nothing is allocated, unlike the
+ *  shader manager's setters which copy the name into a
+ *  std::string on every call.
+ ***********************************************************/
+GLint SceneManager::GetUniformLocation(const char* name)
+{
+	for (int i = 0; i < m_uniformLocationCount; i++)
+	{
+		if (m_uniformLocations[i].name == name)
+		{
+			return(m_uniformLocations[i].location);
+		}
+	}
+	for (int i = 0; i < m_uniformLocationCount; i++)
+	{
+		if (strcmp(m_uniformLocations[i].name, name) == 0)
+		{
+			return(m_uniformLocations[i].location);
+		}
+	}
+
+	GLint location = glGetUniformLocation(m_pShaderManager->m_programID, name);
+	if (m_uniformLocationCount < MAX_UNIFORM_LOCATIONS)
+	{
+		m_uniformLocations[m_uniformLocationCount].name = name;
+		m_uniformLocations[m_uniformLocationCount].location = location;
+		m_uniformLocationCount++;
+	}
+	return(location);
+}
+
+/***********************************************************
+ *  UploadBoolValue()
+ *
+ *  These methods are used for uploading a uniform value into
+ *  the shader.  Every upload is counted so that the redundant
+ *  uploads of each frame can be measured, and is written to
+ *  the draw stream while one is being recorded.  Without a
+ *  shader manager the values are only counted and recorded,
+ *  which lets the helpers be measured without OpenGL.  The
+ *  values go straight to the cached uniform locations so that
+ *  no upload allocates memory.
+ ***********************************************************/
+void SceneManager::UploadBoolValue(const char* name, bool value)
+{
+	int intValue = value ? 1 : 0;
+	if (NULL != m_pRecorder)
+	{
+		m_pRecorder->RecordInt(name, intValue);
+	}
+	RenderStats::Instance().CountUniform(name, &intValue, sizeof(intValue));
+	if (NULL != m_pShaderManager)
+	{
+		glUniform1i(GetUniformLocation(name), intValue);
+	}
+}
+
+void SceneManager::UploadIntValue(const char* name, int value)
+{
+	if (NULL != m_pRecorder)
+	{
+		m_pRecorder->RecordInt(name, value);
+	}
+	RenderStats::Instance().CountUniform(name, &value, sizeof(value));
+	if (NULL != m_pShaderManager)
+	{
+		glUniform1i(GetUniformLocation(name), value);
+	}
+}
+
+void SceneManager::UploadFloatValue(const char* name, float value)
+{
+	if (NULL != m_pRecorder)
+	{
+		m_pRecorder->RecordFloat(name, value);
+	}
+	RenderStats::Instance().CountUniform(name, &value, sizeof(value));
+	if (NULL != m_pShaderManager)
+	{
+		glUniform1f(GetUniformLocation(name), value);
+	}
+}
+
+void SceneManager::UploadSampler2DValue(const char* name, int value)
+{
+	if (NULL != m_pRecorder)
+	{
+		m_pRecorder->RecordInt(name, value);
+	}
+	RenderStats::Instance().CountUniform(name, &value, sizeof(value));
+	RenderStats::Instance().CountSamplerUpdate();
+	if (NULL != m_pShaderManager)
+	{
+		glUniform1i(GetUniformLocation(name), value);
+	}
+}
+
+void SceneManager::UploadVec2Value(const char* name, const glm::vec2& value)
+{
+	if (NULL != m_pRecorder)
+	{
+		m_pRecorder->RecordVec2(name, value);
+	}
+	RenderStats::Instance().CountUniform(name, &value, sizeof(value));
+	if (NULL != m_pShaderManager)
+	{
+		glUniform2fv(GetUniformLocation(name), 1, glm::value_ptr(value));
+	}
+}
+
+void SceneManager::UploadVec3Value(const char* name, const glm::vec3& value)
+{
+	if (NULL != m_pRecorder)
+	{
+		m_pRecorder->RecordVec3(name, value);
+	}
+	RenderStats::Instance().CountUniform(name, &value, sizeof(value));
+	if (NULL != m_pShaderManager)
+	{
+		glUniform3fv(GetUniformLocation(name), 1, glm::value_ptr(value));
+	}
+}
+
+void SceneManager::UploadVec4Value(const char* name, const glm::vec4& value)
+{
+	if (NULL != m_pRecorder)
+	{
+		m_pRecorder->RecordVec4(name, value);
+	}
+	RenderStats::Instance().CountUniform(name, &value, sizeof(value));
+	if (NULL != m_pShaderManager)
+	{
+		glUniform4fv(GetUniformLocation(name), 1, glm::value_ptr(value));
+	}
+}
+
+void SceneManager::UploadMat4Value(const char* name, const glm::mat4& value)
+{
+	if (NULL != m_pRecorder)
+	{
+		m_pRecorder->RecordMat4(name, value);
+	}
+	RenderStats::Instance().CountUniform(name, &value, sizeof(value));
+	if (NULL != m_pShaderManager)
+	{
+		glUniformMatrix4fv(GetUniformLocation(name), 1, GL_FALSE, glm::value_ptr(value));
+	}
+}
+
+/***********************************************************
+ *  DrawMesh()
+ *
+ *  This method is used for drawing one of the loaded basic
+ *  meshes with the uniforms that are currently set.
+ ***********************************************************/
+void SceneManager::DrawMesh(MESH_TYPE mesh)
+{
+	RenderStats::Instance().CountDraw();
+	if (NULL != m_pRecorder)
+	{
+		m_pRecorder->RecordDraw(mesh);
+	}
+
+	switch (mesh)
+	{
+	case MESH_PLANE:
+		m_basicMeshes->DrawPlaneMesh();
+		break;
+	case MESH_CYLINDER:
+		m_basicMeshes->DrawCylinderMesh();
+		break;
+	case MESH_SPHERE:
+		m_basicMeshes->DrawSphereMesh();
+		break;
+	case MESH_PYRAMID3:
+		m_basicMeshes->DrawPyramid3Mesh();
+		break;
+	default:
+		break;
+	}
 }
 
 /***********************************************************
@@ -251,29 +696,14 @@ void SceneManager::SetTransformations(
 	float ZrotationDegrees,
 	glm::vec3 positionXYZ)
 {
-	// variables for this method
-	glm::mat4 modelView;
-	glm::mat4 scale;
-	glm::mat4 rotationX;
-	glm::mat4 rotationY;
-	glm::mat4 rotationZ;
-	glm::mat4 translation;
-
-	// set the scale value in the transform buffer
-	scale = glm::scale(scaleXYZ);
-	// set the rotation values in the transform buffer
-	rotationX = glm::rotate(glm::radians(XrotationDegrees), glm::vec3(1.0f, 0.0f, 0.0f));
-	rotationY = glm::rotate(glm::radians(YrotationDegrees), glm::vec3(0.0f, 1.0f, 0.0f));
-	rotationZ = glm::rotate(glm::radians(ZrotationDegrees), glm::vec3(0.0f, 0.0f, 1.0f));
-	// set the translation value in the transform buffer
-	translation = glm::translate(positionXYZ);
-
-	modelView = translation * rotationZ * rotationY * rotationX * scale;
+	glm::mat4 modelView = ComposeModelMatrix(
+		scaleXYZ,
+		XrotationDegrees,
+		YrotationDegrees,
+		ZrotationDegrees,
+		positionXYZ);
 
-	if (NULL != m_pShaderManager)
-	{
-		m_pShaderManager->setMat4Value(g_ModelName, modelView);
-	}
+	UploadMat4Value(g_ModelName, modelView);
 }
 
 /***********************************************************
@@ -296,30 +726,21 @@ void SceneManager::SetShaderColor(
 	currentColor.b = blueColorValue;
 	currentColor.a = alphaValue;
 
-	if (NULL != m_pShaderManager)
-	{
-		m_pShaderManager->setIntValue(g_UseTextureName, false);
-		m_pShaderManager->setVec4Value(g_ColorValueName, currentColor);
-	}
+	UploadIntValue(g_UseTextureName, false);
+	UploadVec4Value(g_ColorValueName, currentColor);
 }
 
 /***********************************************************
  *  SetShaderTexture()
  *
  *  This method is used for setting the texture data
- *  associated with the passed in ID into the shader.
+ *  associated with the passed in handle into the shader.
  ***********************************************************/
 void SceneManager::SetShaderTexture(
-	std::string textureTag)
+	TEXTURE_HANDLE texture)
 {
-	if (NULL != m_pShaderManager)
-	{
-		m_pShaderManager->setIntValue(g_UseTextureName, true);
-
-		int textureID = -1;
-		textureID = FindTextureSlot(textureTag);
-		m_pShaderManager->setSampler2DValue(g_TextureValueName, textureID);
-	}
+	UploadIntValue(g_UseTextureName, true);
+	UploadSampler2DValue(g_TextureValueName, texture);
 }
 
 /***********************************************************
@@ -330,34 +751,29 @@ void SceneManager::SetShaderTexture(
  ***********************************************************/
 void SceneManager::SetTextureUVScale(float u, float v)
 {
-	if (NULL != m_pShaderManager)
-	{
-		m_pShaderManager->setVec2Value("UVscale", glm::vec2(u, v));
-	}
+	UploadVec2Value("UVscale", glm::vec2(u, v));
 }
 
 /***********************************************************
  *  SetShaderMaterial()
  *
  *  This method is used for passing the material values
- *  into the shader.
+ *  associated with the passed in handle into the shader.
+ *  A negative handle, of a tag that was not found, leaves
+ *  the material uniforms as they are.
  ***********************************************************/
 void SceneManager::SetShaderMaterial(
-	std::string materialTag)
+	MATERIAL_HANDLE material)
 {
-	if (m_objectMaterials.size() > 0)
+	if (material < 0)
 	{
-		OBJECT_MATERIAL material;
-		bool bReturn = false;
-
-		bReturn = FindMaterial(materialTag, material);
-		if (bReturn == true)
-		{
-			m_pShaderManager->setVec3Value("material.diffuseColor", material.diffuseColor);
-			m_pShaderManager->setVec3Value("material.specularColor", material.specularColor);
-			m_pShaderManager->setFloatValue("material.shininess", material.shininess);
-		}
+		return;
 	}
+
+	const OBJECT_MATERIAL& values = m_objectMaterials[material];
+	UploadVec3Value("material.diffuseColor", values.diffuseColor);
+	UploadVec3Value("material.specularColor", values.specularColor);
+	UploadFloatValue("material.shininess", values.shininess);
 }
 
 /**************************************************************/
@@ -413,7 +829,7 @@ void SceneManager::SetupSceneLights()
 // the 3D scene with custom lighting, if no light sources have
 // been added then the display window will be black - to use the 
 // default OpenGL lighting then comment out the following line
-	m_pShaderManager->setBoolValue(g_UseLightingName, true);
+	UploadBoolValue(g_UseLightingName, true);
 
 	/*** STUDENTS - add the code BELOW for setting up light sources ***/
 	/*** Up to four light sources can be defined. Refer to the code ***/
@@ -421,18 +837,18 @@ void SceneManager::SetupSceneLights()
 
 
 	// directional light to emulate sunlight coming into scene
-	m_pShaderManager->setVec3Value("directionalLight.direction", -4.0f, -1.0f, -1.0f);
-	m_pShaderManager->setVec3Value("directionalLight.ambient", 0.5f, 0.5f, 0.5f);
-	m_pShaderManager->setVec3Value("directionalLight.diffuse", 2.0f, 2.0f, 2.0f);
-	m_pShaderManager->setVec3Value("directionalLight.specular", 0.0f, 0.0f, 0.0f);
-	m_pShaderManager->setBoolValue("directionalLight.bActive", true);
-
-	m_pShaderManager->setVec3Value("pointLights[1].position", 30.0f, 20.0f, -80.0f);
-	m_pShaderManager->setVec3Value("pointLights[1].direction", -4.0f, -1.0f, -1.0f);
-	m_pShaderManager->setVec3Value("pointLights[1].ambient", 0.05f, 0.1f, 0.1f);
-	m_pShaderManager->setVec3Value("pointLights[1].diffuse", 0.05f, 0.8f, 0.8f);
-	m_pShaderManager->setVec3Value("pointLights[1].specular", 0.05f, 0.5f, 0.5f);
-	m_pShaderManager->setBoolValue("pointLights[1].bActive", true);
+	UploadVec3Value("directionalLight.direction", glm::vec3(-4.0f, -1.0f, -1.0f));
+	UploadVec3Value("directionalLight.ambient", glm::vec3(0.5f, 0.5f, 0.5f));
+	UploadVec3Value("directionalLight.diffuse", glm::vec3(2.0f, 2.0f, 2.0f));
+	UploadVec3Value("directionalLight.specular", glm::vec3(0.0f, 0.0f, 0.0f));
+	UploadBoolValue("directionalLight.bActive", true);
+
+	UploadVec3Value("pointLights[1].position", glm::vec3(30.0f, 20.0f, -80.0f));
+	UploadVec3Value("pointLights[1].direction", glm::vec3(-4.0f, -1.0f, -1.0f));
+	UploadVec3Value("pointLights[1].ambient", glm::vec3(0.05f, 0.1f, 0.1f));
+	UploadVec3Value("pointLights[1].diffuse", glm::vec3(0.05f, 0.8f, 0.8f));
+	UploadVec3Value("pointLights[1].specular", glm::vec3(0.05f, 0.5f, 0.5f));
+	UploadBoolValue("pointLights[1].bActive", true);
 
 }
 
@@ -476,541 +892,519 @@ void SceneManager::DefineObjectMaterials()
  ***********************************************************/
 void SceneManager::PrepareScene()
 {
+	STARTUP_PHASE("PrepareScene");
+
 	// define the materials for objects in the scene
 	DefineObjectMaterials();
 	// add and define the light sources for the scene
 	SetupSceneLights();
 	// load the textures for the 3D scene
-	LoadSceneTextures();
-
+	{
+		STARTUP_PHASE("LoadSceneTextures");
+		LoadSceneTextures();
+	}
 
 	// only one instance of a particular mesh needs to be
 	// loaded in memory no matter how many times it is drawn
-	// in the rendered 3D scene
+	// in the rendered 3D scene - the buffers of each mesh are
+	// measured while its vertex array is still bound
+	{
+		STARTUP_PHASE("LoadPlaneMesh");
+		m_basicMeshes->LoadPlaneMesh();
+	}
+	AccountMeshMemory();
+	{
+		STARTUP_PHASE("LoadCylinderMesh");
+		m_basicMeshes->LoadCylinderMesh();
+	}
+	AccountMeshMemory();
+	{
+		STARTUP_PHASE("LoadSphereMesh");
+		m_basicMeshes->LoadSphereMesh();
+	}
+	AccountMeshMemory();
+	{
+		STARTUP_PHASE("LoadPyramid3Mesh");
+		m_basicMeshes->LoadPyramid3Mesh();
+	}
+	AccountMeshMemory();
+
+	// place the objects once the textures and materials they
+	// refer to exist
+	{
+		STARTUP_PHASE("LoadSceneObjects");
+		LoadSceneObjects();
+	}
+
+	// the object matrices are copied to the GPU with the first
+	// frame, and only the changed ones after that
+	if (NULL != m_pShaderManager)
+	{
+		m_objectBuffer.Create();
+		m_objectBuffer.Bind(OBJECT_BUFFER_TEXTURE_UNIT);
+		UploadIntValue(g_ObjectModelsName, OBJECT_BUFFER_TEXTURE_UNIT);
+		AccountObjectBufferMemory();
+	}
 
-	m_basicMeshes->LoadPlaneMesh();
-	m_basicMeshes->LoadCylinderMesh();
-	m_basicMeshes->LoadSphereMesh();
-	m_basicMeshes->LoadPyramid3Mesh();
+	AccountContainerMemory();
 }
 
 /***********************************************************
- *  RenderScene()
+ *  LoadSceneObjects()
  *
- *  This method is used for rendering the 3D scene by 
- *  transforming and drawing the basic 3D shapes
+ *  This method is used for filling the scene objects and
+ *  resolving their texture and material tags once, so that
+ *  no tags are looked up while rendering.  The built-in
+ *  scene is used when the scene file cannot be loaded.
  ***********************************************************/
-void SceneManager::RenderScene()
+void SceneManager::LoadSceneObjects()
 {
+	m_streamer.Stop();
+	if ((NULL == m_pStressScene) && !m_compiledSceneFile.empty() && (LoadCompiledScene() == true))
+	{
+		return;
+	}
+	m_compiledScene.Close();
 
-	DrawPlanes(0.0, 0.0, -100.0);
-
-	DrawPyramidTree(-5.0, 0.0, -30.0);
-	DrawPyramidTree(5.0, 0.0, -10.0);
-
-	DrawSphericalTree(-45.0, 0.0, -15.0);
-	DrawSphericalTree(-40.0, 0.0, -35.0);
+	if (NULL != m_pStressScene)
+	{
+		// the generated objects stand on the usual ground plane
+		m_scene.Clear();
+		m_scene.AddPlanes(0.0f, 0.0f, -100.0f);
+		m_pStressScene->AddToScene(m_scene);
+	}
+	else if (m_bBakedScene == true)
+	{
+		m_scene.Clear();
+		BakedScene::AddToScene(m_scene);
+	}
+	else if (m_scene.Load(m_sceneFile) == false)
+	{
+		// a scene file that cannot be read must not leave the
+		// scene empty or half loaded
+		LOG_ERROR("Drawing the built-in scene instead of:%s", m_sceneFile.c_str());
+		m_scene.Clear();
+		BakedScene::AddToScene(m_scene);
+	}
 
-	DrawPyramidTree(45.0, 0.0, -10.0);
-	DrawSphericalTree(50.0, 0.0, -35.0);
+	// every model matrix is built before the first frame
+	TransformStore transforms;
+	ComposeSceneTransforms(transforms);
 
-	DrawMountain(-50.0,25.0,-80.0, 50.0);
-	DrawMountain(-30.0, 15.0, -120.0, 30.0);
+	const std::vector<std::string>& textureTags = m_scene.GetTextureTags();
+	const std::vector<std::string>& materialTags = m_scene.GetMaterialTags();
 
-	DrawMountain(40.0, 10.0, -80.0, 20.0);
-	DrawMountain(55.0, 24.0, -120.0, 48.0);
-	DrawMountain(70.0, 10.0, -80.0, 20.0);
+	m_world.Clear();
+	m_objectHandles.resize(m_scene.GetCount());
+	for (size_t i = 0; i < m_scene.GetCount(); i++)
+	{
+		SceneWorld::ENTITY_DESC entity;
+		entity.kind = m_scene.GetKinds()[i];
+		entity.mesh = m_scene.GetMeshes()[i];
+		entity.scale = m_scene.GetScales()[i];
+		entity.rotation = m_scene.GetRotations()[i];
+		entity.position = m_scene.GetPositions()[i];
+		entity.color = m_scene.GetColors()[i];
+		entity.material = FindMaterialIndex(materialTags[i]);
+		entity.texture = textureTags[i].empty() ? -1 : FindTextureSlot(textureTags[i]);
+		entity.parent = m_scene.GetParents()[i];
+		entity.pModel = &transforms.GetAffine((uint32_t)i);
+		entity.bStatic = false;
+		m_objectHandles[i] = m_world.CreateEntity(entity);
+	}
 
-	DrawCloud(10.0, 100.0, -80.0, 2.0);
-	DrawCloud(-50.0, 85.0, -90.0, 2.0);
-	DrawCloud(50.0, 50.0, -70.0, 2.0);
-	
+	// the parts of the prefab instances keep their instance's
+	// matrix, so they can be moved together
+	m_world.ResizeParents(transforms.GetParentCount());
+	for (size_t i = 0; i < transforms.GetParentCount(); i++)
+	{
+		uint32_t instance = (uint32_t)i;
+		m_world.AttachChildren(instance, m_scene.GetInstanceFirstObjects()[i],
+			(uint32_t)Prefab::GetPartCount(m_scene.GetInstanceTypes()[i]));
+		m_world.SetParentComposed(instance, transforms.GetParentAffine(instance));
+	}
 }
 
-void SceneManager::DrawPlanes(float posx, float posy, float posz) {
-	// declare the variables for the transformations
-	glm::vec3 scaleXYZ;
-	float XrotationDegrees = 0.0f;
-	float YrotationDegrees = 0.0f;
-	float ZrotationDegrees = 0.0f;
-	glm::vec3 positionXYZ;
-
-		/*** Set needed transformations before drawing the basic mesh.  ***/
-	/*** This same ordering of code should be used for transforming ***/
-	/*** and drawing all the basic 3D shapes.						***/
-	/****************************PLANE 1*********************************/
-	// set the XYZ scale for the mesh
-	scaleXYZ = glm::vec3(200.0f, 1.0f, 200.0f);
-
-	// set the XYZ rotation for the mesh
-	XrotationDegrees = 0.0f;
-	YrotationDegrees = 0.0f;
-	ZrotationDegrees = 0.0f;
-
-	// set the XYZ position for the mesh
-	positionXYZ = glm::vec3(0.0f + posx, 0.0f + posy, 0.0f + posz);
+/***********************************************************
+ *  ComposeSceneTransforms()
+ *
+ *  This method is used for filling a transform store with
+ *  the transforms of the scene objects and composing every
+ *  model matrix, or taking the baked matrices as they are.
+ ***********************************************************/
+void SceneManager::ComposeSceneTransforms(TransformStore& transforms)
+{
+	if ((NULL == m_pStressScene) && (m_bBakedScene == true))
+	{
+		transforms.Resize(m_scene.GetCount());
+		BakedScene::SetTransforms(transforms);
+	}
+	else
+	{
+		m_scene.FillTransforms(transforms);
+	}
+	transforms.ComposeDirty();
+}
 
-	// set the transformations into memory to be used on the drawn meshes
-	SetTransformations(
-		scaleXYZ,
-		XrotationDegrees,
-		YrotationDegrees,
-		ZrotationDegrees,
-		positionXYZ);
-
-	SetShaderColor(0.0, 0.502, 0.0, 1);
-	SetShaderMaterial("greenery");
-
-	// draw the mesh with transformation values
-	m_basicMeshes->DrawPlaneMesh();
-
-	/****************************PLANE SKYBOX*********************************/
-	// set the XYZ scale for the mesh
-	scaleXYZ = glm::vec3(300.0f, 1.0f, 300.0f);
-
-	// set the XYZ rotation for the mesh
-	XrotationDegrees = 90.0f;
-	YrotationDegrees = 0.0f;
-	ZrotationDegrees = 0.0f;
+/***********************************************************
+ *  LoadCompiledScene()
+ *
+ *  This method is used for mapping the compiled scene file.
+ *  Its arrays are drawn in place, so the scene objects are
+ *  left empty, and only the entries of its small tag tables
+ *  are looked up - nothing is done per object.  When it is
+ *  streamed, its objects are added to the world cell by cell
+ *  from the first frame on.
+ ***********************************************************/
+bool SceneManager::LoadCompiledScene()
+{
+	if (m_compiledScene.Open(m_compiledSceneFile) == false)
+	{
+		return(false);
+	}
 
-	// set the XYZ position for the mesh
-	positionXYZ = glm::vec3(0.0f + posx, 15.0f + posy, -50.0f + posz);
-
-	// set the transformations into memory to be used on the drawn meshes
-	SetTransformations(
-		scaleXYZ,
-		XrotationDegrees,
-		YrotationDegrees,
-		ZrotationDegrees,
-		positionXYZ);
+	m_scene.Clear();
+	m_world.Clear();
+	m_objectHandles.clear();
 
+	m_compiledTextureSlots.assign(m_compiledScene.GetTextureTagCount(), -1);
+	for (uint32_t i = 0; i < m_compiledScene.GetTextureTagCount(); i++)
+	{
+		m_compiledTextureSlots[i] = FindTextureSlot(m_compiledScene.GetTextureTag(i));
+	}
 
+	m_compiledMaterialIndices.assign(m_compiledScene.GetMaterialTagCount(), -1);
+	for (uint32_t i = 0; i < m_compiledScene.GetMaterialTagCount(); i++)
+	{
+		m_compiledMaterialIndices[i] = FindMaterialIndex(m_compiledScene.GetMaterialTag(i));
+	}
 
-	SetShaderColor(0.416, 0.835, 0.851, 1.0);
-	SetShaderMaterial("sky");
+	if (m_streamCellSize > 0.0f)
+	{
+		m_streamer.Start(&m_compiledScene, m_compiledTextureSlots.data(), m_compiledMaterialIndices.data(),
+			m_streamCellSize, m_streamRadius, m_streamBudgetBytes);
+	}
 
-	// draw the mesh with transformation values
-	m_basicMeshes->DrawPlaneMesh();
+	return(true);
 }
 
-void SceneManager::DrawSphericalTree(float posx, float posy, float posz) {
-	// declare the variables for the transformations
-	glm::vec3 scaleXYZ;
-	float XrotationDegrees = 0.0f;
-	float YrotationDegrees = 0.0f;
-	float ZrotationDegrees = 0.0f;
-	glm::vec3 positionXYZ;
-
-	/***********************Spherical Tree****************************/
-	/***********************Cylinder Root***************************/
-	// set the XYZ scale for the mesh
-	scaleXYZ = glm::vec3(1.0f, 8.0f, 1.0f);
-
-	// set the XYZ rotation for the mesh
-	XrotationDegrees = 0.0f;
-	YrotationDegrees = 0.0f;
-	ZrotationDegrees = 0.0f;
-
-	// set the XYZ position for the mesh
-	positionXYZ = glm::vec3(0.0f + posx, 0.0f + posy, 0.0f + posz);
-
-	// set the transformations into memory to be used on the drawn meshes
-	SetTransformations(
-		scaleXYZ,
-		XrotationDegrees,
-		YrotationDegrees,
-		ZrotationDegrees,
-		positionXYZ);
-
-	SetShaderColor(0.235, 0.702, 0.443, 1);
-	SetShaderTexture("log");
-	SetShaderMaterial("wood");
-	
-
-	// draw the mesh with transformation values
-	m_basicMeshes->DrawCylinderMesh();
-
-
-	/************************Sphere Root Top**************************/
-	// set the XYZ scale for the mesh
-	scaleXYZ = glm::vec3(2.0f, 2.0f, 2.0f);
-
-	// set the XYZ rotation for the mesh
-	XrotationDegrees = 0.0f;
-	YrotationDegrees = 0.0f;
-	ZrotationDegrees = 0.0f;
-
-	// set the XYZ position for the mesh
-	positionXYZ = glm::vec3(0.0f + posx, 8.0f + posy, 0.0f + posz);
-
-	// set the transformations into memory to be used on the drawn meshes
-	SetTransformations(
-		scaleXYZ,
-		XrotationDegrees,
-		YrotationDegrees,
-		ZrotationDegrees,
-		positionXYZ);
-
-	SetShaderColor(0.235, 0.702, 0.443, 1);
-	SetShaderMaterial("greenery");
-
-	// draw the mesh with transformation values
-	m_basicMeshes->DrawSphereMesh();
-
-
-	/**********************Sphere Leaves*******************************/
-	// set the XYZ scale for the mesh
-	scaleXYZ = glm::vec3(4.0f, 4.0f, 4.0f);
-
-	// set the XYZ rotation for the mesh
-	XrotationDegrees = 0.0f;
-	YrotationDegrees = 0.0f;
-	ZrotationDegrees = 0.0f;
-
-	// set the XYZ position for the mesh
-	positionXYZ = glm::vec3(0.0f + posx, 10.0f + posy, 0.0f + posz);
-
-	// set the transformations into memory to be used on the drawn meshes
-	SetTransformations(
-		scaleXYZ,
-		XrotationDegrees,
-		YrotationDegrees,
-		ZrotationDegrees,
-		positionXYZ);
-
-	SetShaderColor(0.065, 0.532, 0.273, 1);
-	SetShaderMaterial("greenery");
-	SetShaderTexture("leaves");
-
-	// draw the mesh with transformation values
-	m_basicMeshes->DrawSphereMesh();
-	/****************************************************************/
+/***********************************************************
+ *  CompileScene()
+ *
+ *  This method is used for loading the scene objects the way
+ *  PrepareScene() does, composing their matrices and writing
+ *  them to a compiled scene file.  No textures or meshes are
+ *  loaded, so it runs without an OpenGL context.
+ ***********************************************************/
+bool SceneManager::CompileScene(const std::string& filename)
+{
+	std::string compiledSceneFile = m_compiledSceneFile;
+	m_compiledSceneFile.clear();
+	LoadSceneObjects();
+	m_compiledSceneFile = compiledSceneFile;
+
+	TransformStore transforms;
+	ComposeSceneTransforms(transforms);
+	return(CompiledScene::Write(m_scene, transforms, filename));
 }
 
-void SceneManager::DrawPyramidTree(float posx, float posy, float posz) {
-	// declare the variables for the transformations
-	glm::vec3 scaleXYZ;
-	float XrotationDegrees = 0.0f;
-	float YrotationDegrees = 0.0f;
-	float ZrotationDegrees = 0.0f;
-	glm::vec3 positionXYZ;
-
-	/***********************Pyramid Tree****************************/
-	/***********************Cylinder Root***************************/
-	// set the XYZ scale for the mesh
-	scaleXYZ = glm::vec3(1.0f, 8.0f, 1.0f);
-
-	// set the XYZ rotation for the mesh
-	XrotationDegrees = 0.0f;
-	YrotationDegrees = 0.0f;
-	ZrotationDegrees = 0.0f;
-
-	// set the XYZ position for the mesh
-	positionXYZ = glm::vec3(12.0f + posx, 0.0f + posy, 0.0f + posz);
-
-	// set the transformations into memory to be used on the drawn meshes
-	SetTransformations(
-		scaleXYZ,
-		XrotationDegrees,
-		YrotationDegrees,
-		ZrotationDegrees,
-		positionXYZ);
-
-	SetShaderColor(0.235, 0.702, 0.443, 1);
-	SetShaderTexture("log");
-	SetShaderMaterial("wood");
-
-	// draw the mesh with transformation values
-	m_basicMeshes->DrawCylinderMesh();
-
-	/**********************Pyramid Leaves 1*******************************/
-	// set the XYZ scale for the mesh
-	scaleXYZ = glm::vec3(9.0f, 9.0f, 9.0f);
-
-	// set the XYZ rotation for the mesh
-	XrotationDegrees = 0.0f;
-	YrotationDegrees = 0.0f;
-	ZrotationDegrees = 0.0f;
-
-	// set the XYZ position for the mesh
-	positionXYZ = glm::vec3(12.0f + posx, 10.5f + posy, -0.5f + posz);
-
-	// set the transformations into memory to be used on the drawn meshes
-	SetTransformations(
-		scaleXYZ,
-		XrotationDegrees,
-		YrotationDegrees,
-		ZrotationDegrees,
-		positionXYZ);
-
-	SetShaderColor(0.065, 0.532, 0.273, 1);
-	SetShaderTexture("pineleaves");
-	SetShaderMaterial("greenery");
-
-	// draw the mesh with transformation values
-	m_basicMeshes->DrawPyramid3Mesh();
-
-
-	/**********************Pyramid Leaves 2*******************************/
-		// set the XYZ scale for the mesh
-	scaleXYZ = glm::vec3(7.0f, 7.0f, 7.0f);
-
-	// set the XYZ rotation for the mesh
-	XrotationDegrees = 0.0f;
-	YrotationDegrees = 0.0f;
-	ZrotationDegrees = 0.0f;
-
-	// set the XYZ position for the mesh
-	positionXYZ = glm::vec3(12.0f + posx, 15.0f + posy, -0.5f + posz);
-
-	// set the transformations into memory to be used on the drawn meshes
-	SetTransformations(
-		scaleXYZ,
-		XrotationDegrees,
-		YrotationDegrees,
-		ZrotationDegrees,
-		positionXYZ);
-
-	SetShaderColor(0.065, 0.532, 0.273, 1);
-	SetShaderTexture("pineleaves");
-	SetShaderMaterial("greenery");
-
-	// draw the mesh with transformation values
-	m_basicMeshes->DrawPyramid3Mesh();
-
-
-	/**********************Pyramid Leaves 3*******************************/
-	// set the XYZ scale for the mesh
-	scaleXYZ = glm::vec3(5.0f, 5.0f, 5.0f);
-
-	// set the XYZ rotation for the mesh
-	XrotationDegrees = 0.0f;
-	YrotationDegrees = 0.0f;
-	ZrotationDegrees = 0.0f;
-
-	// set the XYZ position for the mesh
-	positionXYZ = glm::vec3(12.0f + posx, 19.0f + posy, -0.5f + posz);
-
-	// set the transformations into memory to be used on the drawn meshes
-	SetTransformations(
-		scaleXYZ,
-		XrotationDegrees,
-		YrotationDegrees,
-		ZrotationDegrees,
-		positionXYZ);
-
-	SetShaderColor(0.065, 0.532, 0.273, 1);
-	SetShaderTexture("pineleaves");
-	SetShaderMaterial("greenery");
-
-	// draw the mesh with transformation values
-	m_basicMeshes->DrawPyramid3Mesh();
+/***********************************************************
+ *  SetStreaming()
+ *
+ *  This method is used for setting how the compiled scene is
+ *  streamed when the scene is prepared.
+ ***********************************************************/
+void SceneManager::SetStreaming(float cellSize, float radius, uint64_t budgetBytes)
+{
+	m_streamCellSize = cellSize;
+	m_streamRadius = radius;
+	m_streamBudgetBytes = budgetBytes;
 }
 
-void SceneManager::DrawMountain(float posx, float posy, float posz, float scale) {
-	// declare the variables for the transformations
-	glm::vec3 scaleXYZ;
-	float XrotationDegrees = 0.0f;
-	float YrotationDegrees = 0.0f;
-	float ZrotationDegrees = 0.0f;
-	glm::vec3 positionXYZ;
-
-	/**********************Pyramid*******************************/
-	// set the XYZ scale for the mesh
-	scaleXYZ = glm::vec3(scale, scale, scale);
-
-	// set the XYZ rotation for the mesh
-	XrotationDegrees = 0.0f;
-	YrotationDegrees = 180.0f;
-	ZrotationDegrees = 0.0f;
-
-	// set the XYZ position for the mesh
-	positionXYZ = glm::vec3(0.0f + posx, 0.0f + posy, 0.0f + posz);
-
-	// set the transformations into memory to be used on the drawn meshes
-	SetTransformations(
-		scaleXYZ,
-		XrotationDegrees,
-		YrotationDegrees,
-		ZrotationDegrees,
-		positionXYZ);
-
-	SetShaderColor(0.5, 0.5, 0.5, 1);
-	SetShaderTexture("stone");
-	SetShaderMaterial("wood");
-
-	// draw the mesh with transformation values
-	m_basicMeshes->DrawPyramid3Mesh();
+/***********************************************************
+ *  SetView()
+ *
+ *  This method is used for culling against the passed in
+ *  view and remembering the camera position the cells are
+ *  streamed around.
+ ***********************************************************/
+void SceneManager::SetView(const glm::mat4& viewProjection, const glm::vec3& cameraPosition)
+{
+	m_world.SetCullingView(viewProjection);
+	m_cameraPosition = cameraPosition;
 }
 
-void SceneManager::DrawCloud(float posx, float posy, float posz, float scale) {
-	// declare the variables for the transformations
-	glm::vec3 scaleXYZ;
-	float XrotationDegrees = 0.0f;
-	float YrotationDegrees = 0.0f;
-	float ZrotationDegrees = 0.0f;
-	glm::vec3 positionXYZ;
-
-	/**********************Cloud*******************************/
-	// set the XYZ scale for the mesh
-	scaleXYZ = glm::vec3(1.5 * scale, 1.0 * scale, 1.5 * scale);
-
-	// set the XYZ rotation for the mesh
-	XrotationDegrees = 0.0f;
-	YrotationDegrees = 0.0f;
-	ZrotationDegrees = 0.0f;
-
-	// set the XYZ position for the mesh
-	positionXYZ = glm::vec3(0.0f + posx, 1.5f + posy, 0.0f + posz);
-
-	// set the transformations into memory to be used on the drawn meshes
-	SetTransformations(
-		scaleXYZ,
-		XrotationDegrees,
-		YrotationDegrees,
-		ZrotationDegrees,
-		positionXYZ);
-
-	SetShaderColor(0.9, 0.9, 0.9, 1);
-	// SetShaderTexture("");
-	SetShaderMaterial("wood");
-
-	// draw the mesh with transformation values
-	m_basicMeshes->DrawSphereMesh();
-
-	/**********************Cloud 2*******************************/
-// set the XYZ scale for the mesh
-	scaleXYZ = glm::vec3(3.0 * scale, 2.0 * scale, 3.0 * scale);
-
-	// set the XYZ rotation for the mesh
-	XrotationDegrees = 0.0f;
-	YrotationDegrees = 0.0f;
-	ZrotationDegrees = 0.0f;
-
-	// set the XYZ position for the mesh
-	positionXYZ = glm::vec3(-3.5f + posx, 0.0f + posy, 0.5f + posz);
-
-	// set the transformations into memory to be used on the drawn meshes
-	SetTransformations(
-		scaleXYZ,
-		XrotationDegrees,
-		YrotationDegrees,
-		ZrotationDegrees,
-		positionXYZ);
-
-	SetShaderColor(0.9, 0.9, 0.9, 1);
-	// SetShaderTexture("");
-	SetShaderMaterial("wood");
-
-	// draw the mesh with transformation values
-	m_basicMeshes->DrawSphereMesh();
+/***********************************************************
+ *  SetObjectTransform()
+ *
+ *  This method is used for changing the transform of one
+ *  scene object and marking its model matrix out of date.
+ *  An object that was removed, or whose slot now holds an
+ *  added object, is left alone.
+ ***********************************************************/
+void SceneManager::SetObjectTransform(uint32_t index, const glm::vec3& scale, const glm::vec3& rotation, const glm::vec3& position)
+{
+	if ((index >= m_scene.GetCount()) || (m_world.IsAlive(GetObjectHandle(index)) == false))
+	{
+		return;
+	}
 
-	/**********************Cloud 3*******************************/
-// set the XYZ scale for the mesh
-	scaleXYZ = glm::vec3(3.0 * scale, 2.0 * scale, 3.0 * scale);
+	m_scene.SetTransform(index, scale, rotation, position);
+	m_world.SetTransform(GetObjectHandle(index), scale, rotation, position);
+}
 
-	// set the XYZ rotation for the mesh
-	XrotationDegrees = 0.0f;
-	YrotationDegrees = 0.0f;
-	ZrotationDegrees = 0.0f;
+/***********************************************************
+ *  SetInstanceTransform()
+ *
+ *  This method is used for moving or turning one prefab
+ *  instance.  Its parts are composed again under the new
+ *  instance matrix before the next frame.
+ ***********************************************************/
+void SceneManager::SetInstanceTransform(uint32_t instance, const glm::vec3& rotation, const glm::vec3& position)
+{
+	if (instance >= m_scene.GetInstanceCount())
+	{
+		return;
+	}
 
-	// set the XYZ position for the mesh
-	positionXYZ = glm::vec3(3.25f + posx, 0.0f + posy, -0.5f + posz);
+	m_scene.SetInstanceTransform(instance, rotation, position);
+	m_world.SetParentTransform(instance, glm::vec3(1.0f, 1.0f, 1.0f), rotation, position);
+}
 
-	// set the transformations into memory to be used on the drawn meshes
-	SetTransformations(
-		scaleXYZ,
-		XrotationDegrees,
-		YrotationDegrees,
-		ZrotationDegrees,
-		positionXYZ);
+/***********************************************************
+ *  AddObject()
+ *
+ *  This method is used for adding one object to the scene
+ *  at runtime.  Its tags are resolved into handles here, and
+ *  its model matrix is composed by the next update.  The
+ *  scene description is left as it was loaded.
+ ***********************************************************/
+SceneManager::OBJECT_HANDLE SceneManager::AddObject(const SceneDescription::OBJECT& object)
+{
+	if (m_compiledScene.IsOpen() && (m_streamer.IsRunning() == false))
+	{
+		OBJECT_HANDLE invalid = { UINT32_MAX, 0 };
+		return(invalid);
+	}
 
-	SetShaderColor(0.9, 0.9, 0.9, 1);
-	// SetShaderTexture("");
-	SetShaderMaterial("wood");
+	SceneWorld::ENTITY_DESC entity;
+	entity.kind = object.kind;
+	entity.mesh = object.mesh;
+	entity.scale = object.scale;
+	entity.rotation = object.rotation;
+	entity.position = object.position;
+	entity.color = object.color;
+	entity.material = FindMaterialIndex(object.materialTag);
+	entity.texture = object.textureTag.empty() ? -1 : FindTextureSlot(object.textureTag);
+	entity.parent = -1;
+	entity.pModel = NULL;
+	entity.bStatic = false;
+	return(m_world.CreateEntity(entity));
+}
 
-	// draw the mesh with transformation values
-	m_basicMeshes->DrawSphereMesh();
+/***********************************************************
+ *  RemoveObject()
+ *
+ *  This method is used for removing one object from the
+ *  scene.  Its slot is used again by a later AddObject().
+ ***********************************************************/
+bool SceneManager::RemoveObject(OBJECT_HANDLE object)
+{
+	return(m_world.DestroyEntity(object));
+}
 
-	/**********************Cloud 4*******************************/
-// set the XYZ scale for the mesh
-	scaleXYZ = glm::vec3(4.0 * scale, 3.0 * scale, 4.0 * scale);
+/***********************************************************
+ *  MoveObject()
+ *
+ *  This method is used for changing the transform of one
+ *  object - its model matrix is rebuilt and copied to the
+ *  GPU before the next frame is drawn.
+ ***********************************************************/
+bool SceneManager::MoveObject(OBJECT_HANDLE object, const glm::vec3& scale, const glm::vec3& rotation, const glm::vec3& position)
+{
+	return(m_world.SetTransform(object, scale, rotation, position));
+}
 
-	// set the XYZ rotation for the mesh
-	XrotationDegrees = 0.0f;
-	YrotationDegrees = 0.0f;
-	ZrotationDegrees = 0.0f;
+/***********************************************************
+ *  GetObjectHandle()
+ *
+ *  This method is used for getting the handle of an object
+ *  of the prepared scene, as it was created.  The handle
+ *  stops working once the object is removed or the scene is
+ *  prepared again.
+ ***********************************************************/
+SceneManager::OBJECT_HANDLE SceneManager::GetObjectHandle(uint32_t index) const
+{
+	if (index >= m_objectHandles.size())
+	{
+		OBJECT_HANDLE invalid = { UINT32_MAX, 0 };
+		return(invalid);
+	}
+	return(m_objectHandles[index]);
+}
 
-	// set the XYZ position for the mesh
-	positionXYZ = glm::vec3(0.5f + posx, -1.0f + posy, 2.0f + posz);
+/***********************************************************
+ *  SwitchDrawnKind()
+ *
+ *  This method is used for closing the profiler zone and GPU
+ *  timer scope of the objects drawn so far and opening the
+ *  ones of the next kind, so that each run of objects of the
+ *  same kind is profiled and timed as one scope.
+ ***********************************************************/
+void SceneManager::SwitchDrawnKind(int kind, int& zone, int& scope)
+{
+	CategoryTimer::Instance().EndScope(scope);
+	FrameProfiler::Instance().EndZone(zone);
 
-	// set the transformations into memory to be used on the drawn meshes
-	SetTransformations(
-		scaleXYZ,
-		XrotationDegrees,
-		YrotationDegrees,
-		ZrotationDegrees,
-		positionXYZ);
+	zone = FrameProfiler::Instance().BeginZone(SceneDescription::GetKindName(kind));
+	scope = CategoryTimer::Instance().BeginScope(g_KindCategories[kind]);
+	PipelineStats::Instance().BeginGroup(g_KindGroups[kind]);
+}
 
-	SetShaderColor(0.9, 0.9, 0.9, 1);
-	// SetShaderTexture("");
-	SetShaderMaterial("wood");
+/***********************************************************
+ *  DrawObject()
+ *
+ *  This method is used for uploading the model matrix, color,
+ *  texture and material of one object and drawing its mesh.
+ *  An object with a slot only uploads the slot, its matrix
+ *  being in the object buffer already.  The color is always
+ *  set, and switches texturing off unless the object has a
+ *  texture.
+ ***********************************************************/
+void SceneManager::DrawObject(const TransformStore::AFFINE_3X4& model, int slot, const float* color, int mesh,
+	TEXTURE_HANDLE texture, MATERIAL_HANDLE material)
+{
+	if (slot >= 0)
+	{
+		UploadIntValue(g_ObjectIndexName, slot);
+	}
+	else
+	{
+		UploadMat4Value(g_ModelName, TransformStore::ToMat4(model));
+	}
 
-	// draw the mesh with transformation values
-	m_basicMeshes->DrawSphereMesh();
+	SetShaderColor(color[0], color[1], color[2], color[3]);
+	if (texture >= 0)
+	{
+		SetShaderTexture(texture);
+	}
+	if (material >= 0)
+	{
+		SetShaderMaterial(material);
+	}
 
-	/**********************Cloud 5*******************************/
-// set the XYZ scale for the mesh
-	scaleXYZ = glm::vec3(3.0 * scale, 2.0 * scale, 3.0 * scale);
+	DrawMesh((MESH_TYPE)mesh);
+}
 
-	// set the XYZ rotation for the mesh
-	XrotationDegrees = 0.0f;
-	YrotationDegrees = 0.0f;
-	ZrotationDegrees = 0.0f;
+/***********************************************************
+ *  RenderScene()
+ *
+ *  This method is used for rendering the 3D scene.  The
+ *  scene systems rebuild the model matrices of the moved
+ *  objects, cull the objects outside the view and list the
+ *  rest grouped by kind, and the list is drawn in order.
+ *  A streamed scene first adds and removes its cells.  The
+ *  changed matrices are copied to the object buffer,
+ *  unless a draw stream is being recorded - a recording
+ *  only holds uniforms, so the matrices are uploaded as
+ *  uniforms then, as they are when there are more slots than
+ *  the object buffer can hold.  The shader is switched back to the model
+ *  uniform afterwards for the other draws.
+ ***********************************************************/
+void SceneManager::RenderScene()
+{
+	if (m_compiledScene.IsOpen() && (m_streamer.IsRunning() == false))
+	{
+		RenderCompiledScene();
+		return;
+	}
 
-	// set the XYZ position for the mesh
-	positionXYZ = glm::vec3(-5.0f + posx, -0.5f + posy, 1.0f + posz);
+	if (m_streamer.IsRunning() == true)
+	{
+		PROFILE_ZONE("StreamSceneCells");
+		m_streamer.Update(m_world, m_cameraPosition);
+	}
 
-	// set the transformations into memory to be used on the drawn meshes
-	SetTransformations(
-		scaleXYZ,
-		XrotationDegrees,
-		YrotationDegrees,
-		ZrotationDegrees,
-		positionXYZ);
+	{
+		PROFILE_ZONE("UpdateSceneSystems");
+		m_world.Update();
+	}
 
-	SetShaderColor(0.9, 0.9, 0.9, 1);
-	// SetShaderTexture("");
-	SetShaderMaterial("wood");
+	bool bUseObjectBuffer = (m_objectBuffer.CanHold(m_world.GetSlotCount()) == true) && (NULL == m_pRecorder);
+	if (m_objectBuffer.IsCreated() == true)
+	{
+		PROFILE_ZONE("UploadObjectBuffer");
+		m_objectBuffer.Update(m_world.GetSlotModels(), m_world.GetSlotCount(),
+			m_world.GetChangedRanges(), m_world.GetChangedRangeCount());
+		AccountObjectBufferMemory();
+	}
+	UploadBoolValue(g_UseObjectBufferName, bUseObjectBuffer);
 
-	// draw the mesh with transformation values
-	m_basicMeshes->DrawSphereMesh();
+	const SceneWorld::DRAW_ITEM* drawList = m_world.GetDrawList();
+	uint32_t count = m_world.GetDrawCount();
+	int currentKind = -1;
+	int zone = -1;
+	int scope = -1;
 
-	/**********************Cloud 5*******************************/
-// set the XYZ scale for the mesh
-	scaleXYZ = glm::vec3(4.0 * scale, 2.0 * scale, 4.0 * scale);
+	for (uint32_t i = 0; i < count; i++)
+	{
+		const SceneWorld::DRAW_ITEM& item = drawList[i];
+		if (item.kind != currentKind)
+		{
+			currentKind = item.kind;
+			SwitchDrawnKind(currentKind, zone, scope);
+		}
 
-	// set the XYZ rotation for the mesh
-	XrotationDegrees = 15.0f;
-	YrotationDegrees = 0.0f;
-	ZrotationDegrees = 0.0f;
+		DrawObject(*item.pModel, bUseObjectBuffer ? (int)item.slot : -1,
+			item.pColor, item.mesh, item.texture, item.material);
+		CategoryTimer::Instance().CountObject(scope);
+	}
 
-	// set the XYZ position for the mesh
-	positionXYZ = glm::vec3(5.5f + posx, 0.0f + posy, -1.25f + posz);
+	CategoryTimer::Instance().EndScope(scope);
+	FrameProfiler::Instance().EndZone(zone);
+	PipelineStats::Instance().EndGroup();
 
-	// set the transformations into memory to be used on the drawn meshes
-	SetTransformations(
-		scaleXYZ,
-		XrotationDegrees,
-		YrotationDegrees,
-		ZrotationDegrees,
-		positionXYZ);
+	if (bUseObjectBuffer == true)
+	{
+		UploadBoolValue(g_UseObjectBufferName, false);
+	}
+}
 
-	SetShaderColor(0.9, 0.9, 0.9, 1);
-	// SetShaderTexture("");
-	SetShaderMaterial("wood");
+/***********************************************************
+ *  RenderCompiledScene()
+ *
+ *  This method is used for drawing the objects of the mapped
+ *  compiled scene straight from its arrays, in order.  Its
+ *  texture and material IDs index its tag tables.
+ ***********************************************************/
+void SceneManager::RenderCompiledScene()
+{
+	uint32_t count = m_compiledScene.GetCount();
+	const int* kinds = m_compiledScene.GetKinds();
+	const int* meshes = m_compiledScene.GetMeshes();
+	const float* colors = m_compiledScene.GetColors();
+	const TransformStore::AFFINE_3X4* models = m_compiledScene.GetModels();
+	const int* textureIds = m_compiledScene.GetTextureIds();
+	const int* materialIds = m_compiledScene.GetMaterialIds();
+	int currentKind = -1;
+	int zone = -1;
+	int scope = -1;
+
+	for (uint32_t i = 0; i < count; i++)
+	{
+		if (kinds[i] != currentKind)
+		{
+			currentKind = kinds[i];
+			SwitchDrawnKind(currentKind, zone, scope);
+		}
 
-	// draw the mesh with transformation values
-	m_basicMeshes->DrawSphereMesh();
+		int textureSlot = (textureIds[i] >= 0) ? m_compiledTextureSlots[textureIds[i]] : -1;
+		int materialIndex = (materialIds[i] >= 0) ? m_compiledMaterialIndices[materialIds[i]] : -1;
+		DrawObject(models[i], -1, colors + i * 4, meshes[i], textureSlot, materialIndex);
+		CategoryTimer::Instance().CountObject(scope);
+	}
 
+	CategoryTimer::Instance().EndScope(scope);
+	FrameProfiler::Instance().EndZone(zone);
+	PipelineStats::Instance().EndGroup();
 }
\ No newline at end of file
@@ -11,6 +11,15 @@
 
 #include "ShaderManager.h"
 #include "ShapeMeshes.h"
+#include "DrawStream.h"
+#include "MemoryStats.h"
+#include "StressScene.h"
+#include "SceneDescription.h"
+#include "TransformStore.h"
+#include "SceneWorld.h"
+#include "ObjectBuffer.h"
+#include "CompiledScene.h"
+#include "SceneStreamer.h"
 
 #include <string>
 #include <vector>
@@ -23,6 +32,10 @@
  ***********************************************************/
 class SceneManager
 {
+	// the helper microbenchmarks call the private per-draw methods
+	friend class SceneHelperBenchmark;
+	friend class TransformBenchmark;
+
 public:
 	// constructor
 	SceneManager(ShaderManager *pShaderManager);
@@ -43,6 +56,25 @@ public:
 		std::string tag;
 	};
 
+	// dense handles of the loaded textures, which are also their
+	// texture slots, and of the defined materials - -1 for none
+	typedef int TEXTURE_HANDLE;
+	typedef int MATERIAL_HANDLE;
+	// names one object of the scene while it is in the scene -
+	// a handle of a removed object stops working, even when its
+	// slot is used again
+	typedef SceneWorld::ENTITY OBJECT_HANDLE;
+
+	// basic meshes that the scene is built from
+	enum MESH_TYPE
+	{
+		MESH_PLANE = 0,
+		MESH_CYLINDER,
+		MESH_SPHERE,
+		MESH_PYRAMID3,
+		MESH_TYPE_COUNT
+	};
+
 private:
 	// pointer to shader manager object
 	ShaderManager* m_pShaderManager;
@@ -54,6 +86,80 @@ private:
 	TEXTURE_INFO m_textureIDs[16];
 	// defined object materials
 	std::vector<OBJECT_MATERIAL> m_objectMaterials;
+	// optional recorder of the uniform writes and mesh draws
+	DrawStreamRecorder* m_pRecorder;
+	// scene file the objects are loaded from
+	std::string m_sceneFile;
+	// optional generated objects used instead of the scene file
+	const StressScene* m_pStressScene;
+	// use the compile-time baked default scene instead of the
+	// scene file
+	bool m_bBakedScene;
+	// every mesh draw of the scene
+	SceneDescription m_scene;
+	// the scene objects as entities, one per object in the same
+	// order followed by the objects added at runtime, with their
+	// texture and material tags resolved into handles - their
+	// systems rebuild the model matrices of the moved objects,
+	// cull and list the draws every frame
+	SceneWorld m_world;
+	// handle of every object of the prepared scene, by index
+	std::vector<SceneWorld::ENTITY> m_objectHandles;
+	// model matrix of every entity slot on the GPU, read by the
+	// vertex shader in place of the model uniform
+	ObjectBuffer m_objectBuffer;
+	// compiled scene file drawn in place of the scene objects -
+	// empty when not used
+	std::string m_compiledSceneFile;
+	CompiledScene m_compiledScene;
+	// texture and material handle of every tag of the compiled
+	// scene's tag tables
+	std::vector<TEXTURE_HANDLE> m_compiledTextureSlots;
+	std::vector<MATERIAL_HANDLE> m_compiledMaterialIndices;
+	// streams the compiled scene into the world by grid cells
+	// around the camera instead of drawing all of it - the
+	// streamer reads the scene, so it is declared after it
+	SceneStreamer m_streamer;
+	// cell size, residency radius and memory budget of the
+	// streaming - a cell size of 0 turns it off
+	float m_streamCellSize;
+	float m_streamRadius;
+	uint64_t m_streamBudgetBytes;
+	// camera position set with the last view
+	glm::vec3 m_cameraPosition;
+	// memory this scene has counted into the memory stats, so
+	// that it can be taken back out when the scene is freed
+	uint64_t m_accountedBytes[MemoryStats::CATEGORY_COUNT];
+	uint32_t m_accountedObjects[MemoryStats::CATEGORY_COUNT];
+
+	// count memory into the memory stats on behalf of the scene
+	void AccountMemory(MemoryStats::CATEGORY category, uint64_t bytes, uint32_t objects);
+	// count the buffers of the mesh that was just loaded
+	void AccountMeshMemory();
+	// count the object buffer again when its size changed
+	void AccountObjectBufferMemory();
+	// count the CPU containers of the materials, textures and
+	// scene objects
+	void AccountContainerMemory();
+
+	// fill the scene objects from the generated scene or the
+	// scene file and resolve their tags
+	void LoadSceneObjects();
+	// map the compiled scene file and resolve its tag tables
+	bool LoadCompiledScene();
+	// fill a transform store with the scene objects and compose
+	// their model matrices
+	void ComposeSceneTransforms(TransformStore& transforms);
+	// draw one object with its uniforms - its model matrix is
+	// read from its slot of the object buffer when the slot is
+	// not -1
+	void DrawObject(const TransformStore::AFFINE_3X4& model, int slot, const float* color, int mesh,
+		TEXTURE_HANDLE texture, MATERIAL_HANDLE material);
+	// end the profiler zone and GPU timer scope of the last kind
+	// of object drawn and begin the ones of the passed in kind
+	void SwitchDrawnKind(int kind, int& zone, int& scope);
+	// draw the mapped compiled scene
+	void RenderCompiledScene();
 
 	// load texture images and convert to OpenGL texture data
 	bool CreateGLTexture(const char* filename, std::string tag);
@@ -62,10 +168,41 @@ private:
 	// free the loaded OpenGL textures
 	void DestroyGLTextures();
 	// find a loaded texture by tag
-	int FindTextureID(std::string tag);
-	int FindTextureSlot(std::string tag);
+	int FindTextureID(const std::string& tag);
+	int FindTextureSlot(const std::string& tag);
 	// find a defined material by tag
-	bool FindMaterial(std::string tag, OBJECT_MATERIAL& material);
+	bool FindMaterial(const std::string& tag, OBJECT_MATERIAL& material);
+	int FindMaterialIndex(const std::string& tag);
+
+	// most distinct uniforms whose location is remembered
+	static const int MAX_UNIFORM_LOCATIONS = 64;
+
+	// location of a uniform in the shader program, looked up
+	// once by name
+	struct UNIFORM_LOCATION
+	{
+		const char* name;
+		GLint location;
+	};
+
+	UNIFORM_LOCATION m_uniformLocations[MAX_UNIFORM_LOCATIONS];
+	int m_uniformLocationCount;
+
+	// get the location of a uniform, looking it up the first
+	// time the name is used
+	GLint GetUniformLocation(const char* name);
+	// upload a uniform value into the shader - every uniform
+	// that SceneManager sets goes through these methods
+	void UploadBoolValue(const char* name, bool value);
+	void UploadIntValue(const char* name, int value);
+	void UploadFloatValue(const char* name, float value);
+	void UploadSampler2DValue(const char* name, int value);
+	void UploadVec2Value(const char* name, const glm::vec2& value);
+	void UploadVec3Value(const char* name, const glm::vec3& value);
+	void UploadVec4Value(const char* name, const glm::vec4& value);
+	void UploadMat4Value(const char* name, const glm::mat4& value);
+	// draw one of the loaded basic meshes
+	void DrawMesh(MESH_TYPE mesh);
 
 	// set the transformation values 
 	// into the transform buffer
@@ -83,19 +220,89 @@ private:
 		float blueColorValue,
 		float alphaValue);
 
-	// set the texture data into the shader
+	// set the texture with the passed in handle into the shader
 	void SetShaderTexture(
-		std::string textureTag);
+		TEXTURE_HANDLE texture);
 
 	// set the UV scale for the texture mapping
 	void SetTextureUVScale(
 		float u, float v);
 
-	// set the object material into the shader
+	// set the object material with the passed in handle into
+	// the shader
 	void SetShaderMaterial(
-		std::string materialTag);
+		MATERIAL_HANDLE material);
 
 public:
+	// get the handle of a loaded texture or defined material from
+	// the hash of its tag, see HashTag() - -1 when there is none.
+	// Tags are resolved once, and only handles are used per draw
+	TEXTURE_HANDLE ResolveTexture(uint32_t tagHash) const;
+	MATERIAL_HANDLE ResolveMaterial(uint32_t tagHash) const;
+
+	// record every uniform write and mesh draw into the passed in
+	// recorder, or stop recording when it is NULL
+	void SetDrawStreamRecorder(DrawStreamRecorder* pRecorder) { m_pRecorder = pRecorder; }
+	// load the scene objects from this file when the scene is
+	// prepared (default scenes/default.scene)
+	void SetSceneFile(const std::string& filename) { m_sceneFile = filename; }
+	// place the objects of the passed in generated scene on the
+	// ground plane instead of loading the scene file, or go back
+	// to the scene file when it is NULL - must be set before the
+	// scene is prepared
+	void SetStressScene(const StressScene* pStressScene) { m_pStressScene = pStressScene; }
+	// use the default scene baked in at compile time, with its
+	// model matrices, instead of loading the scene file - must be
+	// set before the scene is prepared
+	void SetBakedScene(bool bBakedScene) { m_bBakedScene = bBakedScene; }
+	// draw the objects of a compiled scene file, mapped and used
+	// in place, instead of loading the scene - its objects cannot
+	// be moved, and the scene file is loaded if it cannot be
+	// mapped - must be set before the scene is prepared
+	void SetCompiledSceneFile(const std::string& filename) { m_compiledSceneFile = filename; }
+	// stream the objects of the compiled scene in square cells of
+	// cellSize around the camera, keeping the cells within radius
+	// that fit in budgetBytes - must be set before the scene is
+	// prepared, and a cell size of 0 draws the whole scene
+	void SetStreaming(float cellSize, float radius, uint64_t budgetBytes);
+	const SceneStreamer& GetStreamer() const { return(m_streamer); }
+	// load the objects the scene would be prepared with and write
+	// them to a compiled scene file, without OpenGL
+	bool CompileScene(const std::string& filename);
+	// objects of the prepared scene
+	const SceneDescription& GetSceneDescription() const { return(m_scene); }
+	// move, turn or resize one object of the prepared scene - its
+	// model matrix is rebuilt before the next frame is drawn, and
+	// the transform of a prefab part is relative to its instance
+	void SetObjectTransform(uint32_t index, const glm::vec3& scale, const glm::vec3& rotation, const glm::vec3& position);
+	// move or turn one prefab instance of the prepared scene
+	// together with its parts
+	void SetInstanceTransform(uint32_t instance, const glm::vec3& rotation, const glm::vec3& position);
+	// add an object to the prepared scene, drawn from the next
+	// frame on - its tags are resolved now.  Not available when
+	// a compiled scene is drawn without streaming, where an
+	// invalid handle is returned
+	OBJECT_HANDLE AddObject(const SceneDescription::OBJECT& object);
+	// remove an object - false when it was already removed
+	bool RemoveObject(OBJECT_HANDLE object);
+	// move, turn or resize an object - false when it was removed
+	bool MoveObject(OBJECT_HANDLE object, const glm::vec3& scale, const glm::vec3& rotation, const glm::vec3& position);
+	bool IsObjectAlive(OBJECT_HANDLE object) const { return(m_world.IsAlive(object)); }
+	// handle of an object of the prepared scene by its index
+	OBJECT_HANDLE GetObjectHandle(uint32_t index) const;
+	// bytes of model matrices copied to the GPU by the last
+	// RenderScene()
+	uint64_t GetLastObjectUploadBytes() const { return(m_objectBuffer.GetLastUploadBytes()); }
+	// number of model matrices rebuilt by the last RenderScene()
+	uint32_t GetLastMatrixUpdates() const { return(m_world.GetLastComposed()); }
+	// split the per-frame scene systems across this many
+	// threads (default 1)
+	void SetSystemThreads(int threadCount) { m_world.SetThreadCount(threadCount); }
+	// skip the objects outside the frustum of this
+	// view-projection matrix from now on, and stream the cells
+	// around the camera position - every object is drawn until
+	// the view is first set
+	void SetView(const glm::mat4& viewProjection, const glm::vec3& cameraPosition);
 
 	// The following methods are for the students to 
 	// customize for their own 3D scene
@@ -107,11 +314,4 @@ public:
 	void SetupSceneLights();
 	// pre-define the object materials for lighting
 	void DefineObjectMaterials();
-
-
-	void DrawPyramidTree(float posx, float posy, float posz);
-	void DrawSphericalTree(float posx, float posy, float posz);
-	void DrawPlanes(float posx, float posy, float posz);
-	void DrawMountain(float posx, float posy, float posz, float scale);
-	void DrawCloud(float posx, float posy, float posz, float scale);
 };
\ No newline at end of file
@@ -0,0 +1,416 @@
+///////////////////////////////////////////////////////////////////////////////
+// scenestreamer.cpp
+// ============
+// stream the grid cells of a compiled scene in and out around the camera
+///////////////////////////////////////////////////////////////////////////////
+
+#include "SceneStreamer.h"
+#include "Logger.h"
+#include "MemoryStats.h"
+
+#include <algorithm>
+#include <cmath>
+#include <utility>
+
+/***********************************************************
+ *  SceneStreamer()
+ *
+ *  The constructor for the class
+ ***********************************************************/
+SceneStreamer::SceneStreamer()
+{
+	m_pScene = NULL;
+	m_pTextureSlots = NULL;
+	m_pMaterialIndices = NULL;
+	m_cellSize = 0.0f;
+	m_radius = 0.0f;
+	m_budgetBytes = 0;
+	m_origin = glm::vec2(0.0f, 0.0f);
+	m_cameraX = 0;
+	m_cameraZ = 0;
+	m_bSelected = false;
+	m_residentCells = 0;
+	m_residentObjects = 0;
+	m_pendingLoads = 0;
+	m_loadCount = 0;
+	m_unloadCount = 0;
+	m_bStopping = false;
+}
+
+/***********************************************************
+ *  ~SceneStreamer()
+ *
+ *  The destructor for the class
+ ***********************************************************/
+SceneStreamer::~SceneStreamer()
+{
+	Stop();
+}
+
+/***********************************************************
+ *  Start()
+ *
+ *  This method is used for sorting the objects of the scene
+ *  by the grid cell the center of their box is in, listing
+ *  the cells that have objects, and starting the loading
+ *  thread.  Nothing is loaded until the first Update().
+ ***********************************************************/
+void SceneStreamer::Start(const CompiledScene* pScene, const int* pTextureSlots, const int* pMaterialIndices,
+	float cellSize, float radius, uint64_t budgetBytes)
+{
+	Stop();
+
+	m_pScene = pScene;
+	m_pTextureSlots = pTextureSlots;
+	m_pMaterialIndices = pMaterialIndices;
+	m_cellSize = cellSize;
+	m_radius = radius;
+	m_budgetBytes = budgetBytes;
+	m_bSelected = false;
+	m_residentCells = 0;
+	m_residentObjects = 0;
+	m_pendingLoads = 0;
+	m_loadCount = 0;
+	m_unloadCount = 0;
+
+	uint32_t count = pScene->GetCount();
+	const CompiledScene::BOUNDS* bounds = pScene->GetBounds();
+
+	m_origin = glm::vec2(0.0f, 0.0f);
+	for (uint32_t i = 0; i < count; i++)
+	{
+		float x = (bounds[i].min[0] + bounds[i].max[0]) * 0.5f;
+		float z = (bounds[i].min[2] + bounds[i].max[2]) * 0.5f;
+		m_origin.x = (i == 0) ? x : std::min(m_origin.x, x);
+		m_origin.y = (i == 0) ? z : std::min(m_origin.y, z);
+	}
+
+	// the grid coordinates are never negative from the origin,
+	// so X and Z pack into one sortable key
+	std::vector<std::pair<uint64_t, uint32_t> > keys(count);
+	for (uint32_t i = 0; i < count; i++)
+	{
+		uint32_t x = (uint32_t)((((bounds[i].min[0] + bounds[i].max[0]) * 0.5f) - m_origin.x) / cellSize);
+		uint32_t z = (uint32_t)((((bounds[i].min[2] + bounds[i].max[2]) * 0.5f) - m_origin.y) / cellSize);
+		keys[i] = std::make_pair(((uint64_t)x << 32) | z, i);
+	}
+	std::sort(keys.begin(), keys.end());
+
+	m_cellObjects.resize(count);
+	for (uint32_t i = 0; i < count; i++)
+	{
+		m_cellObjects[i] = keys[i].second;
+		if ((i == 0) || (keys[i].first != keys[i - 1].first))
+		{
+			CELL cell;
+			cell.x = (int)(keys[i].first >> 32);
+			cell.z = (int)(keys[i].first & 0xFFFFFFFF);
+			cell.firstObject = i;
+			cell.objectCount = 0;
+			cell.state = CELL_UNLOADED;
+			cell.bWanted = false;
+			cell.bOverBudgetLogged = false;
+			m_cells.push_back(cell);
+		}
+		m_cells.back().objectCount++;
+	}
+	m_candidates.reserve(m_cells.size());
+
+	m_bStopping = false;
+	m_thread = std::thread(&SceneStreamer::ThreadMain, this);
+
+	LOG_INFO("Streaming %u objects in %u cells of %.1f units", count, (uint32_t)m_cells.size(), cellSize);
+}
+
+/***********************************************************
+ *  Stop()
+ *
+ *  This method is used for waking the loading thread to
+ *  exit, waiting for it and forgetting the cells and the
+ *  loads that were still queued.  The resident cells leave
+ *  the memory totals.
+ ***********************************************************/
+void SceneStreamer::Stop()
+{
+	if (m_thread.joinable())
+	{
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
+			m_bStopping = true;
+		}
+		m_wake.notify_all();
+		m_thread.join();
+	}
+
+	m_requests.clear();
+	m_loaded.clear();
+	m_arrived.clear();
+	m_cells.clear();
+	m_cellObjects.clear();
+	m_candidates.clear();
+	MemoryStats::Instance().Remove(MemoryStats::CPU_STREAMED_CELLS, GetResidentBytes(), m_residentObjects);
+	m_residentCells = 0;
+	m_residentObjects = 0;
+	m_pendingLoads = 0;
+	m_pScene = NULL;
+}
+
+/***********************************************************
+ *  Update()
+ *
+ *  This method is used for adding the cells that the loading
+ *  thread has finished to the world, up to the objects
+ *  allowed per frame, and selecting the cells again when the
+ *  camera has moved into another cell.  A loaded cell that
+ *  is no longer wanted is dropped.
+ ***********************************************************/
+void SceneStreamer::Update(SceneWorld& world, const glm::vec3& cameraPosition)
+{
+	if (IsRunning() == false)
+	{
+		return;
+	}
+
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		for (size_t i = 0; i < m_loaded.size(); i++)
+		{
+			m_arrived.push_back(std::move(m_loaded[i]));
+		}
+		m_loaded.clear();
+	}
+
+	uint32_t added = 0;
+	size_t done = 0;
+	for (; (done < m_arrived.size()) && (added < MAX_OBJECTS_PER_FRAME); done++)
+	{
+		LOADED_CELL& loaded = m_arrived[done];
+		CELL& cell = m_cells[loaded.cell];
+		m_pendingLoads--;
+		if (cell.bWanted == false)
+		{
+			cell.state = CELL_UNLOADED;
+			continue;
+		}
+
+		cell.entities.reserve(loaded.entities.size());
+		for (size_t i = 0; i < loaded.entities.size(); i++)
+		{
+			cell.entities.push_back(world.CreateEntity(loaded.entities[i]));
+		}
+		cell.state = CELL_RESIDENT;
+		m_residentCells++;
+		m_residentObjects += cell.objectCount;
+		MemoryStats::Instance().Add(MemoryStats::CPU_STREAMED_CELLS,
+			(uint64_t)cell.objectCount * RESIDENT_OBJECT_BYTES, cell.objectCount);
+		m_loadCount++;
+		added += cell.objectCount;
+	}
+	m_arrived.erase(m_arrived.begin(), m_arrived.begin() + done);
+
+	int cameraX = (int)floorf((cameraPosition.x - m_origin.x) / m_cellSize);
+	int cameraZ = (int)floorf((cameraPosition.z - m_origin.y) / m_cellSize);
+	if ((m_bSelected == false) || (cameraX != m_cameraX) || (cameraZ != m_cameraZ))
+	{
+		m_cameraX = cameraX;
+		m_cameraZ = cameraZ;
+		m_bSelected = true;
+		SelectCells(world, cameraPosition);
+	}
+}
+
+/***********************************************************
+ *  SelectCells()
+ *
+ *  This method is used for picking the cells whose square
+ *  comes within the residency radius of the camera, nearest
+ *  first, until the next one would go over the budget.  The
+ *  nearest cell is picked even when it is larger than the
+ *  whole budget, so the ground under the camera is never
+ *  left empty, and that is logged once for the cell.  The
+ *  resident cells that were not picked are removed, the
+ *  queued loads of those cells are taken back, and the
+ *  picked cells that are not resident or loading are queued
+ *  nearest first.
+ ***********************************************************/
+void SceneStreamer::SelectCells(SceneWorld& world, const glm::vec3& cameraPosition)
+{
+	m_candidates.clear();
+	for (uint32_t i = 0; i < m_cells.size(); i++)
+	{
+		CELL& cell = m_cells[i];
+		cell.bWanted = false;
+
+		float minX = m_origin.x + cell.x * m_cellSize;
+		float minZ = m_origin.y + cell.z * m_cellSize;
+		float dx = std::max(0.0f, std::max(minX - cameraPosition.x, cameraPosition.x - (minX + m_cellSize)));
+		float dz = std::max(0.0f, std::max(minZ - cameraPosition.z, cameraPosition.z - (minZ + m_cellSize)));
+		float distance = sqrtf(dx * dx + dz * dz);
+		if (distance <= m_radius)
+		{
+			CANDIDATE candidate;
+			candidate.distance = distance;
+			candidate.cell = i;
+			m_candidates.push_back(candidate);
+		}
+	}
+	std::sort(m_candidates.begin(), m_candidates.end());
+
+	uint64_t bytes = 0;
+	for (size_t i = 0; i < m_candidates.size(); i++)
+	{
+		CELL& cell = m_cells[m_candidates[i].cell];
+		uint64_t cellBytes = (uint64_t)cell.objectCount * RESIDENT_OBJECT_BYTES;
+		if ((i > 0) && (bytes + cellBytes > m_budgetBytes))
+		{
+			m_candidates.resize(i);
+			break;
+		}
+		if ((cellBytes > m_budgetBytes) && (cell.bOverBudgetLogged == false))
+		{
+			LOG_ERROR("Stream cell %d, %d needs %llu bytes, over the budget of %llu bytes", cell.x, cell.z,
+				(unsigned long long)cellBytes, (unsigned long long)m_budgetBytes);
+			cell.bOverBudgetLogged = true;
+		}
+		bytes += cellBytes;
+		cell.bWanted = true;
+	}
+
+	for (size_t i = 0; i < m_cells.size(); i++)
+	{
+		if ((m_cells[i].bWanted == false) && (m_cells[i].state == CELL_RESIDENT))
+		{
+			UnloadCell(world, m_cells[i]);
+		}
+	}
+
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+
+		size_t kept = 0;
+		for (size_t i = 0; i < m_requests.size(); i++)
+		{
+			CELL& cell = m_cells[m_requests[i]];
+			if (cell.bWanted == true)
+			{
+				m_requests[kept++] = m_requests[i];
+			}
+			else
+			{
+				cell.state = CELL_UNLOADED;
+				m_pendingLoads--;
+			}
+		}
+		m_requests.resize(kept);
+
+		for (size_t i = 0; i < m_candidates.size(); i++)
+		{
+			CELL& cell = m_cells[m_candidates[i].cell];
+			if (cell.state == CELL_UNLOADED)
+			{
+				cell.state = CELL_LOADING;
+				m_pendingLoads++;
+				m_requests.push_back(m_candidates[i].cell);
+			}
+		}
+	}
+	m_wake.notify_one();
+}
+
+/***********************************************************
+ *  UnloadCell()
+ *
+ *  This method is used for destroying the entities of a
+ *  resident cell and freeing its handle list.
+ ***********************************************************/
+void SceneStreamer::UnloadCell(SceneWorld& world, CELL& cell)
+{
+	for (size_t i = 0; i < cell.entities.size(); i++)
+	{
+		world.DestroyEntity(cell.entities[i]);
+	}
+	std::vector<SceneWorld::ENTITY>().swap(cell.entities);
+
+	cell.state = CELL_UNLOADED;
+	m_residentCells--;
+	m_residentObjects -= cell.objectCount;
+	MemoryStats::Instance().Remove(MemoryStats::CPU_STREAMED_CELLS,
+		(uint64_t)cell.objectCount * RESIDENT_OBJECT_BYTES, cell.objectCount);
+	m_unloadCount++;
+}
+
+/***********************************************************
+ *  LoadCell()
+ *
+ *  This method is used for reading the objects of one cell
+ *  out of the mapped arrays into static entity descriptions,
+ *  with their IDs resolved into texture and material
+ *  handles.  It only reads what Start() left unchanged, so
+ *  it runs on the loading thread.
+ ***********************************************************/
+void SceneStreamer::LoadCell(uint32_t cellIndex, LOADED_CELL& loaded) const
+{
+	const CELL& cell = m_cells[cellIndex];
+	const int32_t* kinds = m_pScene->GetKinds();
+	const int32_t* meshes = m_pScene->GetMeshes();
+	const float* colors = m_pScene->GetColors();
+	const TransformStore::AFFINE_3X4* models = m_pScene->GetModels();
+	const int32_t* textureIds = m_pScene->GetTextureIds();
+	const int32_t* materialIds = m_pScene->GetMaterialIds();
+
+	loaded.cell = cellIndex;
+	loaded.entities.resize(cell.objectCount);
+	loaded.models.resize(cell.objectCount);
+	for (uint32_t i = 0; i < cell.objectCount; i++)
+	{
+		uint32_t object = m_cellObjects[cell.firstObject + i];
+		const TransformStore::AFFINE_3X4& model = models[object];
+		loaded.models[i] = model;
+
+		SceneWorld::ENTITY_DESC& entity = loaded.entities[i];
+		entity.kind = kinds[object];
+		entity.mesh = meshes[object];
+		entity.scale = glm::vec3(1.0f, 1.0f, 1.0f);
+		entity.rotation = glm::vec3(0.0f, 0.0f, 0.0f);
+		entity.position = glm::vec3(model.m[3], model.m[7], model.m[11]);
+		entity.color = glm::vec4(colors[object * 4], colors[object * 4 + 1], colors[object * 4 + 2], colors[object * 4 + 3]);
+		entity.material = (materialIds[object] >= 0) ? m_pMaterialIndices[materialIds[object]] : -1;
+		entity.texture = (textureIds[object] >= 0) ? m_pTextureSlots[textureIds[object]] : -1;
+		entity.parent = -1;
+		entity.pModel = &loaded.models[i];
+		entity.bStatic = true;
+	}
+}
+
+/***********************************************************
+ *  ThreadMain()
+ *
+ *  This method is used for loading the queued cells in
+ *  order, one at a time without holding the lock, until the
+ *  streamer is stopped.
+ ***********************************************************/
+void SceneStreamer::ThreadMain()
+{
+	std::unique_lock<std::mutex> lock(m_mutex);
+	for (;;)
+	{
+		while ((m_bStopping == false) && m_requests.empty())
+		{
+			m_wake.wait(lock);
+		}
+		if (m_bStopping == true)
+		{
+			return;
+		}
+
+		uint32_t cellIndex = m_requests.front();
+		m_requests.pop_front();
+		lock.unlock();
+
+		LOADED_CELL loaded;
+		LoadCell(cellIndex, loaded);
+
+		lock.lock();
+		m_loaded.push_back(std::move(loaded));
+	}
+}
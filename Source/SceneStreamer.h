@@ -0,0 +1,170 @@
+///////////////////////////////////////////////////////////////////////////////
+// scenestreamer.h
+// ============
+// stream the grid cells of a compiled scene in and out around the camera
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include "CompiledScene.h"
+#include "SceneWorld.h"
+
+#include <glm/glm.hpp>
+
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/***********************************************************
+ *  SceneStreamer
+ *
+ *  This class splits the objects of a mapped compiled scene
+ *  into square grid cells on the ground, by the center of
+ *  each object's box, and keeps only the cells around the
+ *  camera in the scene world.  The cells within the
+ *  residency radius are made resident nearest first, until
+ *  the memory budget is used up - the nearest cell is always
+ *  kept, even when it alone is over the budget.  A loading thread reads the
+ *  objects of a requested cell out of the mapped file, so
+ *  its pages are faulted in off the render thread, and the
+ *  render thread then adds the loaded cells to the world as
+ *  static entities, whose matrices reach the GPU with the
+ *  object buffer's next partial update.  The cells that are
+ *  no longer wanted are removed from the world, and the
+ *  operating system drops their clean file pages when it
+ *  needs the memory.
+ ***********************************************************/
+class SceneStreamer
+{
+public:
+	// bytes one resident object is counted as against the
+	// budget - about its rows in the world chunks and slot
+	// tables, its draw list entry and its object buffer texels
+	static const uint32_t RESIDENT_OBJECT_BYTES = 272;
+
+	// constructor
+	SceneStreamer();
+	// destructor
+	~SceneStreamer();
+
+	// split the objects of an open compiled scene into cells and
+	// start the loading thread - the texture and material handle
+	// arrays index the scene's tag tables, and the scene and the
+	// arrays must stay as they are until Stop()
+	void Start(const CompiledScene* pScene, const int* pTextureSlots, const int* pMaterialIndices,
+		float cellSize, float radius, uint64_t budgetBytes);
+	// stop the loading thread and forget the cells - the entities
+	// of the resident cells are left in the world
+	void Stop();
+	bool IsRunning() const { return(NULL != m_pScene); }
+
+	// add the loaded cells to the world, and when the camera has
+	// entered another cell, remove the cells that are no longer
+	// wanted and ask for the new ones
+	void Update(SceneWorld& world, const glm::vec3& cameraPosition);
+
+	uint32_t GetCellCount() const { return((uint32_t)m_cells.size()); }
+	uint32_t GetResidentCells() const { return(m_residentCells); }
+	uint32_t GetResidentObjects() const { return(m_residentObjects); }
+	uint64_t GetResidentBytes() const { return((uint64_t)m_residentObjects * RESIDENT_OBJECT_BYTES); }
+	// cells asked for that are not resident yet
+	uint32_t GetPendingLoads() const { return(m_pendingLoads); }
+	// cells added to and removed from the world since Start()
+	uint64_t GetLoadCount() const { return(m_loadCount); }
+	uint64_t GetUnloadCount() const { return(m_unloadCount); }
+
+private:
+	// most objects added to the world in one frame - a loaded
+	// cell is never split, so at least one cell is added
+	static const uint32_t MAX_OBJECTS_PER_FRAME = 8192;
+
+	enum CELL_STATE
+	{
+		CELL_UNLOADED = 0,
+		CELL_LOADING,
+		CELL_RESIDENT
+	};
+
+	struct CELL
+	{
+		// grid coordinates on X and Z
+		int x;
+		int z;
+		// objects of the cell in m_cellObjects
+		uint32_t firstObject;
+		uint32_t objectCount;
+		CELL_STATE state;
+		// picked by the last selection
+		bool bWanted;
+		// the cell went over the budget as the nearest cell and
+		// this was logged
+		bool bOverBudgetLogged;
+		// entities of the resident cell
+		std::vector<SceneWorld::ENTITY> entities;
+	};
+
+	// the objects of a cell read by the loading thread, ready to
+	// be added to the world
+	struct LOADED_CELL
+	{
+		uint32_t cell;
+		std::vector<SceneWorld::ENTITY_DESC> entities;
+		std::vector<TransformStore::AFFINE_3X4> models;
+	};
+
+	// a cell within the residency radius
+	struct CANDIDATE
+	{
+		float distance;
+		uint32_t cell;
+
+		bool operator<(const CANDIDATE& other) const { return(distance < other.distance); }
+	};
+
+	const CompiledScene* m_pScene;
+	const int* m_pTextureSlots;
+	const int* m_pMaterialIndices;
+	float m_cellSize;
+	float m_radius;
+	uint64_t m_budgetBytes;
+	// X and Z of the corner of cell 0, 0
+	glm::vec2 m_origin;
+
+	std::vector<CELL> m_cells;
+	// object indices grouped by cell
+	std::vector<uint32_t> m_cellObjects;
+	std::vector<CANDIDATE> m_candidates;
+	// cell the camera was in at the last selection
+	int m_cameraX;
+	int m_cameraZ;
+	bool m_bSelected;
+
+	// loaded cells waiting to be added to the world
+	std::vector<LOADED_CELL> m_arrived;
+	uint32_t m_residentCells;
+	uint32_t m_residentObjects;
+	uint32_t m_pendingLoads;
+	uint64_t m_loadCount;
+	uint64_t m_unloadCount;
+
+	// shared with the loading thread under the mutex
+	std::thread m_thread;
+	std::mutex m_mutex;
+	std::condition_variable m_wake;
+	std::deque<uint32_t> m_requests;
+	std::vector<LOADED_CELL> m_loaded;
+	bool m_bStopping;
+
+	// pick the cells to keep around the camera, remove the ones
+	// not picked and ask for the missing ones
+	void SelectCells(SceneWorld& world, const glm::vec3& cameraPosition);
+	// remove the entities of a resident cell from the world
+	void UnloadCell(SceneWorld& world, CELL& cell);
+	// read the objects of a cell out of the mapped scene
+	void LoadCell(uint32_t cellIndex, LOADED_CELL& loaded) const;
+	// loading thread body
+	void ThreadMain();
+};
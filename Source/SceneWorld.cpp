@@ -0,0 +1,850 @@
+///////////////////////////////////////////////////////////////////////////////
+// sceneworld.cpp
+// ============
+// scene objects stored as entities in archetype chunks, updated by systems
+///////////////////////////////////////////////////////////////////////////////
+
+#include "SceneWorld.h"
+
+#include <algorithm>
+#include <cstring>
+
+// declaration of global variables and helper functions
+namespace
+{
+	// the arrays of a chunk start on cache line boundaries
+	const size_t COLUMN_ALIGNMENT = 64;
+
+	// component that every chunk array belongs to, -1 for the
+	// arrays that every archetype has, and the bytes of one row
+	struct COLUMN_INFO
+	{
+		int component;
+		size_t rowBytes;
+	};
+
+	const COLUMN_INFO g_Columns[] =
+	{
+		{ SceneWorld::COMPONENT_TRANSFORM, sizeof(float) },
+		{ SceneWorld::COMPONENT_TRANSFORM, sizeof(float) },
+		{ SceneWorld::COMPONENT_TRANSFORM, sizeof(float) },
+		{ SceneWorld::COMPONENT_TRANSFORM, sizeof(float) },
+		{ SceneWorld::COMPONENT_TRANSFORM, sizeof(float) },
+		{ SceneWorld::COMPONENT_TRANSFORM, sizeof(float) },
+		{ SceneWorld::COMPONENT_TRANSFORM, sizeof(float) },
+		{ SceneWorld::COMPONENT_TRANSFORM, sizeof(float) },
+		{ SceneWorld::COMPONENT_TRANSFORM, sizeof(float) },
+		{ SceneWorld::COMPONENT_MODEL, sizeof(TransformStore::AFFINE_3X4) },
+		{ SceneWorld::COMPONENT_BOUNDS, sizeof(TransformStore::BOUNDS) },
+		{ SceneWorld::COMPONENT_MESH, sizeof(int) },
+		{ SceneWorld::COMPONENT_COLOR, sizeof(glm::vec4) },
+		{ SceneWorld::COMPONENT_MATERIAL, sizeof(int) },
+		{ SceneWorld::COMPONENT_TEXTURE, sizeof(int) },
+		{ SceneWorld::COMPONENT_PARENT, sizeof(uint32_t) },
+		{ -1, sizeof(uint32_t) },
+		{ -1, sizeof(uint16_t) }
+	};
+
+	// the components every system needs
+	const SceneWorld::COMPONENT_MASK TRANSFORM_SYSTEM_MASK =
+		(1u << SceneWorld::COMPONENT_TRANSFORM) |
+		(1u << SceneWorld::COMPONENT_MODEL) |
+		(1u << SceneWorld::COMPONENT_BOUNDS);
+	const SceneWorld::COMPONENT_MASK DRAW_SYSTEM_MASK =
+		(1u << SceneWorld::COMPONENT_MODEL) |
+		(1u << SceneWorld::COMPONENT_BOUNDS) |
+		(1u << SceneWorld::COMPONENT_MESH) |
+		(1u << SceneWorld::COMPONENT_COLOR);
+
+	/***********************************************************
+	 *  BoxInFrustum()
+	 *
+	 *  This function is used for testing a box against the six
+	 *  frustum planes.  For each plane only the corner furthest
+	 *  along its normal is tested, so a box that is outside is
+	 *  always rejected, and a few boxes near the frustum's
+	 *  corners are kept even though they are outside.
+	 ***********************************************************/
+	bool BoxInFrustum(const TransformStore::BOUNDS& bounds, const glm::vec4* planes)
+	{
+		for (int i = 0; i < 6; i++)
+		{
+			const glm::vec4& plane = planes[i];
+			float x = (plane.x >= 0.0f) ? bounds.max[0] : bounds.min[0];
+			float y = (plane.y >= 0.0f) ? bounds.max[1] : bounds.min[1];
+			float z = (plane.z >= 0.0f) ? bounds.max[2] : bounds.min[2];
+			if (plane.x * x + plane.y * y + plane.z * z + plane.w < 0.0f)
+			{
+				return(false);
+			}
+		}
+		return(true);
+	}
+}
+
+/***********************************************************
+ *  SceneWorld()
+ *
+ *  The constructor for the class
+ ***********************************************************/
+SceneWorld::SceneWorld()
+{
+	m_bCulling = false;
+	m_drawCount = 0;
+	m_lastComposed = 0;
+}
+
+/***********************************************************
+ *  Clear()
+ *
+ *  This method is used for removing every entity, chunk,
+ *  archetype and parent.  The slots and their generations
+ *  are kept, the live ones moving on a generation, so a
+ *  handle taken before never names an entity created after.
+ *  The slots are freed in reverse, so the entities created
+ *  next take them in order from slot 0 again.
+ ***********************************************************/
+void SceneWorld::Clear()
+{
+	m_archetypes.clear();
+	m_chunks.clear();
+	m_freeSlots.clear();
+	for (size_t i = m_slots.size(); i > 0; i--)
+	{
+		SLOT& slot = m_slots[i - 1];
+		if (slot.bAlive == true)
+		{
+			slot.bAlive = false;
+			slot.generation++;
+		}
+		m_freeSlots.push_back((uint32_t)(i - 1));
+	}
+	m_drawOrder.clear();
+	m_parentAffine.clear();
+	m_parentFirstChild.clear();
+	m_parentChildCount.clear();
+	m_drawList.clear();
+	m_drawCount = 0;
+	m_lastComposed = 0;
+	m_composedChunks.clear();
+	std::fill(m_changedBlocks.begin(), m_changedBlocks.end(), (unsigned char)0);
+	m_changedBlockList.clear();
+	m_changedRanges.clear();
+}
+
+/***********************************************************
+ *  FindArchetype()
+ *
+ *  This method is used for getting the archetype of a set of
+ *  components and a kind.  A new archetype lays out its chunk
+ *  with one array per column of its components.
+ ***********************************************************/
+uint32_t SceneWorld::FindArchetype(COMPONENT_MASK mask, int kind)
+{
+	for (size_t i = 0; i < m_archetypes.size(); i++)
+	{
+		if ((m_archetypes[i].mask == mask) && (m_archetypes[i].kind == kind))
+		{
+			return((uint32_t)i);
+		}
+	}
+
+	static_assert(sizeof(g_Columns) / sizeof(g_Columns[0]) == COLUMN_COUNT, "one COLUMN_INFO per column");
+
+	ARCHETYPE archetype;
+	archetype.mask = mask;
+	archetype.kind = kind;
+	archetype.chunkBytes = 0;
+	archetype.usedChunks = 0;
+	for (int column = 0; column < COLUMN_COUNT; column++)
+	{
+		archetype.columnOffsets[column] = 0;
+		int component = g_Columns[column].component;
+		if ((component < 0) || ((mask & (1u << component)) != 0))
+		{
+			archetype.columnOffsets[column] = archetype.chunkBytes;
+			size_t bytes = g_Columns[column].rowBytes * CHUNK_CAPACITY;
+			archetype.chunkBytes += (bytes + COLUMN_ALIGNMENT - 1) & ~(COLUMN_ALIGNMENT - 1);
+		}
+	}
+
+	m_archetypes.push_back(archetype);
+	return((uint32_t)(m_archetypes.size() - 1));
+}
+
+/***********************************************************
+ *  FindFreeChunk()
+ *
+ *  This method is used for getting the last used chunk of
+ *  an archetype when it has a free row, then an emptied
+ *  chunk, or adding a chunk.  A new chunk goes into the draw
+ *  order after the chunks of its kind.
+ ***********************************************************/
+uint32_t SceneWorld::FindFreeChunk(uint32_t archetype)
+{
+	std::vector<uint32_t>& chunks = m_archetypes[archetype].chunks;
+	uint32_t& usedChunks = m_archetypes[archetype].usedChunks;
+	if ((usedChunks > 0) && (m_chunks[chunks[usedChunks - 1]].count < CHUNK_CAPACITY))
+	{
+		return(chunks[usedChunks - 1]);
+	}
+	if (usedChunks < chunks.size())
+	{
+		usedChunks++;
+		return(chunks[usedChunks - 1]);
+	}
+
+	uint32_t index = (uint32_t)m_chunks.size();
+	m_chunks.push_back(CHUNK());
+	CHUNK& chunk = m_chunks.back();
+	chunk.archetype = archetype;
+	chunk.count = 0;
+	chunk.bDirty = false;
+	chunk.visibleCount = 0;
+	chunk.drawOffset = 0;
+	chunk.memory.resize(m_archetypes[archetype].chunkBytes);
+	chunks.push_back(index);
+	usedChunks++;
+	m_composedChunks.reserve(m_chunks.size());
+
+	int kind = m_archetypes[archetype].kind;
+	size_t position = m_drawOrder.size();
+	while ((position > 0) && (m_archetypes[m_chunks[m_drawOrder[position - 1]].archetype].kind > kind))
+	{
+		position--;
+	}
+	m_drawOrder.insert(m_drawOrder.begin() + position, index);
+
+	return(index);
+}
+
+/***********************************************************
+ *  AllocateSlot()
+ *
+ *  This method is used for taking the most recently freed
+ *  slot, or adding a slot along with its matrix and, every
+ *  CHANGED_BLOCK_SLOTS slots, a block flag.  The lists that
+ *  the update fills are reserved here, so that the update
+ *  never has to grow them.
+ ***********************************************************/
+uint32_t SceneWorld::AllocateSlot()
+{
+	if (!m_freeSlots.empty())
+	{
+		uint32_t slot = m_freeSlots.back();
+		m_freeSlots.pop_back();
+		return(slot);
+	}
+
+	uint32_t slot = (uint32_t)m_slots.size();
+	SLOT entry;
+	entry.chunk = 0;
+	entry.row = 0;
+	entry.generation = 0;
+	entry.bAlive = false;
+	m_slots.push_back(entry);
+	m_slotModels.push_back(TransformStore::AFFINE_3X4());
+
+	if ((slot % CHANGED_BLOCK_SLOTS) == 0)
+	{
+		m_changedBlocks.push_back(0);
+		m_changedBlockList.reserve(m_changedBlocks.size());
+		m_changedRanges.reserve(m_changedBlocks.size());
+	}
+	return(slot);
+}
+
+/***********************************************************
+ *  CreateEntity()
+ *
+ *  This method is used for adding an entity to the next free
+ *  row of its archetype.  An entity without a composed
+ *  matrix marks its chunk for the transform system, and the
+ *  slot of an entity with one is marked for the GPU copy.  A
+ *  static entity has no transform arrays for the transform
+ *  system to compose it from.
+ ***********************************************************/
+SceneWorld::ENTITY SceneWorld::CreateEntity(const ENTITY_DESC& desc)
+{
+	COMPONENT_MASK mask = DRAW_SYSTEM_MASK;
+	if (desc.bStatic == false)
+	{
+		mask |= TRANSFORM_SYSTEM_MASK;
+	}
+	if (desc.material >= 0)
+	{
+		mask |= (1u << COMPONENT_MATERIAL);
+	}
+	if (desc.texture >= 0)
+	{
+		mask |= (1u << COMPONENT_TEXTURE);
+	}
+	if (desc.parent >= 0)
+	{
+		mask |= (1u << COMPONENT_PARENT);
+	}
+
+	uint32_t chunkIndex = FindFreeChunk(FindArchetype(mask, desc.kind));
+	CHUNK& chunk = m_chunks[chunkIndex];
+	uint32_t row = chunk.count++;
+	uint32_t slot = AllocateSlot();
+
+	if ((mask & (1u << COMPONENT_TRANSFORM)) != 0)
+	{
+		Column<float>(chunk, COLUMN_SCALE_X)[row] = desc.scale.x;
+		Column<float>(chunk, COLUMN_SCALE_Y)[row] = desc.scale.y;
+		Column<float>(chunk, COLUMN_SCALE_Z)[row] = desc.scale.z;
+		Column<float>(chunk, COLUMN_ROTATION_X)[row] = desc.rotation.x;
+		Column<float>(chunk, COLUMN_ROTATION_Y)[row] = desc.rotation.y;
+		Column<float>(chunk, COLUMN_ROTATION_Z)[row] = desc.rotation.z;
+		Column<float>(chunk, COLUMN_POSITION_X)[row] = desc.position.x;
+		Column<float>(chunk, COLUMN_POSITION_Y)[row] = desc.position.y;
+		Column<float>(chunk, COLUMN_POSITION_Z)[row] = desc.position.z;
+	}
+	Column<int>(chunk, COLUMN_MESH)[row] = desc.mesh;
+	Column<glm::vec4>(chunk, COLUMN_COLOR)[row] = desc.color;
+	Column<uint32_t>(chunk, COLUMN_ENTITY)[row] = slot;
+	if ((mask & (1u << COMPONENT_MATERIAL)) != 0)
+	{
+		Column<int>(chunk, COLUMN_MATERIAL)[row] = desc.material;
+	}
+	if ((mask & (1u << COMPONENT_TEXTURE)) != 0)
+	{
+		Column<int>(chunk, COLUMN_TEXTURE)[row] = desc.texture;
+	}
+	if ((mask & (1u << COMPONENT_PARENT)) != 0)
+	{
+		Column<uint32_t>(chunk, COLUMN_PARENT)[row] = (uint32_t)desc.parent;
+	}
+
+	if (NULL != desc.pModel)
+	{
+		Column<TransformStore::AFFINE_3X4>(chunk, COLUMN_MODEL)[row] = *desc.pModel;
+		Column<TransformStore::BOUNDS>(chunk, COLUMN_BOUNDS)[row] = TransformStore::ComputeBounds(*desc.pModel);
+		m_slotModels[slot] = *desc.pModel;
+		MarkSlotChanged(slot);
+	}
+	else
+	{
+		chunk.bDirty = true;
+	}
+
+	m_slots[slot].chunk = chunkIndex;
+	m_slots[slot].row = row;
+	m_slots[slot].bAlive = true;
+	m_drawList.push_back(DRAW_ITEM());
+
+	ENTITY entity;
+	entity.slot = slot;
+	entity.generation = m_slots[slot].generation;
+	return(entity);
+}
+
+/***********************************************************
+ *  DestroyEntity()
+ *
+ *  This method is used for removing an entity.  The last row
+ *  of the archetype's last used chunk is moved into the
+ *  freed row, so the used chunks of an archetype stay full
+ *  except for the last one, and the moved entity keeps its
+ *  slot, so nothing has to be copied to the GPU again.
+ ***********************************************************/
+bool SceneWorld::DestroyEntity(ENTITY entity)
+{
+	if (IsAlive(entity) == false)
+	{
+		return(false);
+	}
+
+	SLOT& slot = m_slots[entity.slot];
+	CHUNK& chunk = m_chunks[slot.chunk];
+	ARCHETYPE& archetype = m_archetypes[chunk.archetype];
+	CHUNK& lastChunk = m_chunks[archetype.chunks[archetype.usedChunks - 1]];
+	uint32_t lastRow = lastChunk.count - 1;
+
+	if ((&lastChunk != &chunk) || (lastRow != slot.row))
+	{
+		CopyRow(chunk, slot.row, lastChunk, lastRow);
+		if (lastChunk.bDirty == true)
+		{
+			chunk.bDirty = true;
+		}
+
+		uint32_t moved = Column<uint32_t>(chunk, COLUMN_ENTITY)[slot.row];
+		m_slots[moved].chunk = slot.chunk;
+		m_slots[moved].row = slot.row;
+	}
+	lastChunk.count--;
+	if (lastChunk.count == 0)
+	{
+		archetype.usedChunks--;
+	}
+
+	slot.bAlive = false;
+	slot.generation++;
+	m_freeSlots.push_back(entity.slot);
+	m_drawList.pop_back();
+	return(true);
+}
+
+/***********************************************************
+ *  IsAlive()
+ *
+ *  This method is used for checking that a handle names an
+ *  entity that was not destroyed.
+ ***********************************************************/
+bool SceneWorld::IsAlive(ENTITY entity) const
+{
+	return((entity.slot < m_slots.size()) &&
+		(m_slots[entity.slot].bAlive == true) &&
+		(m_slots[entity.slot].generation == entity.generation));
+}
+
+/***********************************************************
+ *  CopyRow()
+ *
+ *  This method is used for copying one row between two
+ *  chunks of the same archetype, one array at a time.
+ ***********************************************************/
+void SceneWorld::CopyRow(CHUNK& target, uint32_t targetRow, const CHUNK& source, uint32_t sourceRow)
+{
+	const ARCHETYPE& archetype = m_archetypes[target.archetype];
+	for (int column = 0; column < COLUMN_VISIBLE; column++)
+	{
+		int component = g_Columns[column].component;
+		if ((component >= 0) && ((archetype.mask & (1u << component)) == 0))
+		{
+			continue;
+		}
+
+		size_t rowBytes = g_Columns[column].rowBytes;
+		size_t offset = archetype.columnOffsets[column];
+		memcpy(target.memory.data() + offset + rowBytes * targetRow,
+			source.memory.data() + offset + rowBytes * sourceRow,
+			rowBytes);
+	}
+}
+
+/***********************************************************
+ *  ResizeParents()
+ *
+ *  This method is used for replacing the parents with the
+ *  passed in number of identity parents.
+ ***********************************************************/
+void SceneWorld::ResizeParents(size_t count)
+{
+	TransformStore::AFFINE_3X4 identity =
+	{
+		{
+			1.0f, 0.0f, 0.0f, 0.0f,
+			0.0f, 1.0f, 0.0f, 0.0f,
+			0.0f, 0.0f, 1.0f, 0.0f
+		}
+	};
+	m_parentAffine.assign(count, identity);
+	m_parentFirstChild.assign(count, 0);
+	m_parentChildCount.assign(count, 0);
+}
+
+/***********************************************************
+ *  AttachChildren()
+ *
+ *  This method is used for remembering the range of slots
+ *  that are children of a parent, so that they are composed
+ *  again when the parent moves.
+ ***********************************************************/
+void SceneWorld::AttachChildren(uint32_t parent, uint32_t firstSlot, uint32_t slotCount)
+{
+	m_parentFirstChild[parent] = firstSlot;
+	m_parentChildCount[parent] = slotCount;
+}
+
+/***********************************************************
+ *  SetParentComposed()
+ *
+ *  This method is used for setting the matrix of a parent
+ *  without marking its children, whose matrices were passed
+ *  in already composed under it.
+ ***********************************************************/
+void SceneWorld::SetParentComposed(uint32_t parent, const TransformStore::AFFINE_3X4& affine)
+{
+	m_parentAffine[parent] = affine;
+}
+
+/***********************************************************
+ *  SetParentTransform()
+ *
+ *  This method is used for composing the matrix of a parent
+ *  now and marking the chunks of its children that are still
+ *  alive.
+ ***********************************************************/
+void SceneWorld::SetParentTransform(uint32_t parent, const glm::vec3& scale, const glm::vec3& rotation, const glm::vec3& position)
+{
+	const float* inputs[9] =
+	{
+		&scale.x, &scale.y, &scale.z,
+		&rotation.x, &rotation.y, &rotation.z,
+		&position.x, &position.y, &position.z
+	};
+	TransformStore::ComposeArrays(inputs, 1, &m_parentAffine[parent]);
+
+	uint32_t first = m_parentFirstChild[parent];
+	for (uint32_t i = first; i < first + m_parentChildCount[parent]; i++)
+	{
+		if (m_slots[i].bAlive == true)
+		{
+			m_chunks[m_slots[i].chunk].bDirty = true;
+		}
+	}
+}
+
+/***********************************************************
+ *  SetTransform()
+ *
+ *  This method is used for writing the transform of one
+ *  entity into its chunk and marking the chunk.
+ ***********************************************************/
+bool SceneWorld::SetTransform(ENTITY entity, const glm::vec3& scale, const glm::vec3& rotation, const glm::vec3& position)
+{
+	if (IsAlive(entity) == false)
+	{
+		return(false);
+	}
+
+	const SLOT& slot = m_slots[entity.slot];
+	CHUNK& chunk = m_chunks[slot.chunk];
+	uint32_t row = slot.row;
+	if ((m_archetypes[chunk.archetype].mask & (1u << COMPONENT_TRANSFORM)) == 0)
+	{
+		return(false);
+	}
+
+	Column<float>(chunk, COLUMN_SCALE_X)[row] = scale.x;
+	Column<float>(chunk, COLUMN_SCALE_Y)[row] = scale.y;
+	Column<float>(chunk, COLUMN_SCALE_Z)[row] = scale.z;
+	Column<float>(chunk, COLUMN_ROTATION_X)[row] = rotation.x;
+	Column<float>(chunk, COLUMN_ROTATION_Y)[row] = rotation.y;
+	Column<float>(chunk, COLUMN_ROTATION_Z)[row] = rotation.z;
+	Column<float>(chunk, COLUMN_POSITION_X)[row] = position.x;
+	Column<float>(chunk, COLUMN_POSITION_Y)[row] = position.y;
+	Column<float>(chunk, COLUMN_POSITION_Z)[row] = position.z;
+	chunk.bDirty = true;
+	return(true);
+}
+
+/***********************************************************
+ *  SetThreadCount()
+ *
+ *  This method is used for starting the worker threads the
+ *  systems are split across.
+ ***********************************************************/
+void SceneWorld::SetThreadCount(int threadCount)
+{
+	m_workers.Start(threadCount);
+}
+
+/***********************************************************
+ *  SetCullingView()
+ *
+ *  This method is used for taking the six frustum planes out
+ *  of a view-projection matrix.  Each plane is the last row
+ *  of the matrix plus or minus one of the other rows.
+ ***********************************************************/
+void SceneWorld::SetCullingView(const glm::mat4& viewProjection)
+{
+	const glm::mat4& m = viewProjection;
+	for (int axis = 0; axis < 3; axis++)
+	{
+		for (int side = 0; side < 2; side++)
+		{
+			float sign = (side == 0) ? 1.0f : -1.0f;
+			m_frustum[axis * 2 + side] = glm::vec4(
+				m[0][3] + sign * m[0][axis],
+				m[1][3] + sign * m[1][axis],
+				m[2][3] + sign * m[2][axis],
+				m[3][3] + sign * m[3][axis]);
+		}
+	}
+	m_bCulling = true;
+}
+
+/***********************************************************
+ *  Update()
+ *
+ *  This method is used for running the systems in order.
+ *  Each system is split across the worker threads by chunk,
+ *  and only the offsets of the chunks in the draw list are
+ *  added up between the culling and draw list systems.  Once
+ *  the transform system is done, the composed matrices that
+ *  differ from the ones of their slots are copied there and
+ *  marked for the GPU copy, so that moving one entity does
+ *  not mark every entity of its chunk.
+ ***********************************************************/
+void SceneWorld::Update()
+{
+	uint32_t chunkCount = (uint32_t)m_chunks.size();
+
+	m_lastComposed = 0;
+	m_composedChunks.clear();
+	for (uint32_t i = 0; i < chunkCount; i++)
+	{
+		if ((m_chunks[i].bDirty == true) && (m_chunks[i].count > 0))
+		{
+			m_lastComposed += m_chunks[i].count;
+			m_composedChunks.push_back(i);
+		}
+	}
+	if (m_lastComposed > 0)
+	{
+		m_workers.Run(TransformJob, this, chunkCount);
+	}
+
+	for (size_t i = 0; i < m_composedChunks.size(); i++)
+	{
+		CHUNK& chunk = m_chunks[m_composedChunks[i]];
+		const TransformStore::AFFINE_3X4* models = Column<TransformStore::AFFINE_3X4>(chunk, COLUMN_MODEL);
+		const uint32_t* slots = Column<uint32_t>(chunk, COLUMN_ENTITY);
+		for (uint32_t row = 0; row < chunk.count; row++)
+		{
+			TransformStore::AFFINE_3X4& slotModel = m_slotModels[slots[row]];
+			if (memcmp(&slotModel, &models[row], sizeof(slotModel)) != 0)
+			{
+				slotModel = models[row];
+				MarkSlotChanged(slots[row]);
+			}
+		}
+	}
+	CollectChangedRanges();
+
+	m_workers.Run(CullingJob, this, chunkCount);
+
+	m_drawCount = 0;
+	for (size_t i = 0; i < m_drawOrder.size(); i++)
+	{
+		CHUNK& chunk = m_chunks[m_drawOrder[i]];
+		chunk.drawOffset = m_drawCount;
+		m_drawCount += chunk.visibleCount;
+	}
+
+	m_workers.Run(DrawListJob, this, (uint32_t)m_drawOrder.size());
+}
+
+/***********************************************************
+ *  TransformJob()
+ *
+ *  These functions are used for running a system over a
+ *  range of chunks on a worker thread.  The draw list job's
+ *  range is of the draw order instead.
+ ***********************************************************/
+void SceneWorld::TransformJob(void* pContext, uint32_t first, uint32_t count)
+{
+	SceneWorld* pWorld = (SceneWorld*)pContext;
+	for (uint32_t i = first; i < first + count; i++)
+	{
+		pWorld->UpdateTransforms(pWorld->m_chunks[i]);
+	}
+}
+
+void SceneWorld::CullingJob(void* pContext, uint32_t first, uint32_t count)
+{
+	SceneWorld* pWorld = (SceneWorld*)pContext;
+	for (uint32_t i = first; i < first + count; i++)
+	{
+		pWorld->CullChunk(pWorld->m_chunks[i]);
+	}
+}
+
+void SceneWorld::DrawListJob(void* pContext, uint32_t first, uint32_t count)
+{
+	SceneWorld* pWorld = (SceneWorld*)pContext;
+	for (uint32_t i = first; i < first + count; i++)
+	{
+		pWorld->FillDrawList(pWorld->m_chunks[pWorld->m_drawOrder[i]]);
+	}
+}
+
+/***********************************************************
+ *  UpdateTransforms()
+ *
+ *  This method is the transform system.  The matrices of a
+ *  marked chunk are composed in one batch from its transform
+ *  arrays, moved under their parents, and the world boxes
+ *  are taken from the new matrices.
+ ***********************************************************/
+void SceneWorld::UpdateTransforms(CHUNK& chunk)
+{
+	const ARCHETYPE& archetype = m_archetypes[chunk.archetype];
+	if ((chunk.bDirty == false) || ((archetype.mask & TRANSFORM_SYSTEM_MASK) != TRANSFORM_SYSTEM_MASK))
+	{
+		return;
+	}
+
+	const float* inputs[9];
+	for (int i = 0; i < 9; i++)
+	{
+		inputs[i] = Column<float>(chunk, (COLUMN)(COLUMN_SCALE_X + i));
+	}
+	TransformStore::AFFINE_3X4* models = Column<TransformStore::AFFINE_3X4>(chunk, COLUMN_MODEL);
+	TransformStore::ComposeArrays(inputs, chunk.count, models);
+
+	if ((archetype.mask & (1u << COMPONENT_PARENT)) != 0)
+	{
+		const uint32_t* parents = Column<uint32_t>(chunk, COLUMN_PARENT);
+		for (uint32_t row = 0; row < chunk.count; row++)
+		{
+			TransformStore::Multiply(m_parentAffine[parents[row]], models[row], models[row]);
+		}
+	}
+
+	TransformStore::BOUNDS* bounds = Column<TransformStore::BOUNDS>(chunk, COLUMN_BOUNDS);
+	for (uint32_t row = 0; row < chunk.count; row++)
+	{
+		bounds[row] = TransformStore::ComputeBounds(models[row]);
+	}
+
+	chunk.bDirty = false;
+}
+
+/***********************************************************
+ *  CullChunk()
+ *
+ *  This method is the culling system.  The rows of a chunk
+ *  whose box is inside the frustum are listed in order, and
+ *  every row is listed while culling is off.
+ ***********************************************************/
+void SceneWorld::CullChunk(CHUNK& chunk)
+{
+	const ARCHETYPE& archetype = m_archetypes[chunk.archetype];
+	chunk.visibleCount = 0;
+	if ((archetype.mask & DRAW_SYSTEM_MASK) != DRAW_SYSTEM_MASK)
+	{
+		return;
+	}
+
+	const TransformStore::BOUNDS* bounds = Column<TransformStore::BOUNDS>(chunk, COLUMN_BOUNDS);
+	uint16_t* visible = Column<uint16_t>(chunk, COLUMN_VISIBLE);
+	for (uint32_t row = 0; row < chunk.count; row++)
+	{
+		if ((m_bCulling == false) || BoxInFrustum(bounds[row], m_frustum))
+		{
+			visible[chunk.visibleCount++] = (uint16_t)row;
+		}
+	}
+}
+
+/***********************************************************
+ *  FillDrawList()
+ *
+ *  This method is the draw list system.  The visible rows of
+ *  a chunk are written to the chunk's own part of the draw
+ *  list, so the chunks can be written at the same time.
+ ***********************************************************/
+void SceneWorld::FillDrawList(CHUNK& chunk)
+{
+	const ARCHETYPE& archetype = m_archetypes[chunk.archetype];
+	const uint16_t* visible = Column<uint16_t>(chunk, COLUMN_VISIBLE);
+	const TransformStore::AFFINE_3X4* models = Column<TransformStore::AFFINE_3X4>(chunk, COLUMN_MODEL);
+	const glm::vec4* colors = Column<glm::vec4>(chunk, COLUMN_COLOR);
+	const int* meshes = Column<int>(chunk, COLUMN_MESH);
+	const uint32_t* slots = Column<uint32_t>(chunk, COLUMN_ENTITY);
+	const int* materials = ((archetype.mask & (1u << COMPONENT_MATERIAL)) != 0) ? Column<int>(chunk, COLUMN_MATERIAL) : NULL;
+	const int* textures = ((archetype.mask & (1u << COMPONENT_TEXTURE)) != 0) ? Column<int>(chunk, COLUMN_TEXTURE) : NULL;
+
+	DRAW_ITEM* pItem = m_drawList.data() + chunk.drawOffset;
+	for (uint32_t i = 0; i < chunk.visibleCount; i++, pItem++)
+	{
+		uint32_t row = visible[i];
+		pItem->pModel = &models[row];
+		pItem->slot = slots[row];
+		pItem->pColor = &colors[row].r;
+		pItem->kind = archetype.kind;
+		pItem->mesh = meshes[row];
+		pItem->material = (NULL != materials) ? materials[row] : -1;
+		pItem->texture = (NULL != textures) ? textures[row] : -1;
+	}
+}
+
+/***********************************************************
+ *  MarkSlotChanged()
+ *
+ *  This method is used for flagging the block of a slot, and
+ *  listing the block the first time it is flagged.
+ ***********************************************************/
+void SceneWorld::MarkSlotChanged(uint32_t slot)
+{
+	uint32_t block = slot / CHANGED_BLOCK_SLOTS;
+	if (m_changedBlocks[block] == 0)
+	{
+		m_changedBlocks[block] = 1;
+		m_changedBlockList.push_back(block);
+	}
+}
+
+/***********************************************************
+ *  CollectChangedRanges()
+ *
+ *  This method is used for sorting the flagged blocks and
+ *  merging the neighbouring ones into ranges of slots, the
+ *  last range ending at the last slot.  The flags are
+ *  cleared for the next update.
+ ***********************************************************/
+void SceneWorld::CollectChangedRanges()
+{
+	m_changedRanges.clear();
+	std::sort(m_changedBlockList.begin(), m_changedBlockList.end());
+
+	uint32_t slotCount = (uint32_t)m_slots.size();
+	for (size_t i = 0; i < m_changedBlockList.size(); i++)
+	{
+		uint32_t block = m_changedBlockList[i];
+		m_changedBlocks[block] = 0;
+
+		uint32_t first = block * CHANGED_BLOCK_SLOTS;
+		uint32_t end = std::min(first + CHANGED_BLOCK_SLOTS, slotCount);
+		if (!m_changedRanges.empty() && (m_changedRanges.back().first + m_changedRanges.back().count == first))
+		{
+			m_changedRanges.back().count = end - m_changedRanges.back().first;
+		}
+		else
+		{
+			SLOT_RANGE range;
+			range.first = first;
+			range.count = end - first;
+			m_changedRanges.push_back(range);
+		}
+	}
+	m_changedBlockList.clear();
+}
+
+/***********************************************************
+ *  GetMemoryBytes()
+ *
+ *  This method is used for adding up the bytes held by the
+ *  chunks, the slot and parent tables, the slot matrices and
+ *  the draw list.
+ ***********************************************************/
+uint64_t SceneWorld::GetMemoryBytes() const
+{
+	uint64_t bytes =
+		m_archetypes.capacity() * sizeof(ARCHETYPE) +
+		m_chunks.capacity() * sizeof(CHUNK) +
+		m_slots.capacity() * sizeof(SLOT) +
+		m_freeSlots.capacity() * sizeof(uint32_t) +
+		m_slotModels.capacity() * sizeof(TransformStore::AFFINE_3X4) +
+		m_changedBlocks.capacity() +
+		(m_changedBlockList.capacity() + m_composedChunks.capacity()) * sizeof(uint32_t) +
+		m_changedRanges.capacity() * sizeof(SLOT_RANGE) +
+		m_drawOrder.capacity() * sizeof(uint32_t) +
+		m_parentAffine.capacity() * sizeof(TransformStore::AFFINE_3X4) +
+		(m_parentFirstChild.capacity() + m_parentChildCount.capacity()) * sizeof(uint32_t) +
+		m_drawList.capacity() * sizeof(DRAW_ITEM);
+	for (size_t i = 0; i < m_chunks.size(); i++)
+	{
+		bytes += m_chunks[i].memory.capacity();
+	}
+	for (size_t i = 0; i < m_archetypes.size(); i++)
+	{
+		bytes += m_archetypes[i].chunks.capacity() * sizeof(uint32_t);
+	}
+	return(bytes);
+}
@@ -0,0 +1,309 @@
+///////////////////////////////////////////////////////////////////////////////
+// sceneworld.h
+// ============
+// scene objects stored as entities in archetype chunks, updated by systems
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include "TransformStore.h"
+#include "WorkerPool.h"
+
+#include <glm/glm.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/***********************************************************
+ *  SceneWorld
+ *
+ *  This class stores every scene object as an entity made of
+ *  components.  The entities that have the same components
+ *  and the same kind share an archetype, whose entities are
+ *  kept in fixed size chunks with one dense array per
+ *  component, so a system walks each array from start to
+ *  end.  Three systems run every frame, each one over the
+ *  chunks split across the worker threads:
+ *
+ *    transform - composes the model matrices and world boxes
+ *                of the chunks whose transforms changed
+ *    culling   - lists the entities whose box is inside the
+ *                view frustum
+ *    draw list - copies the visible entities into one list,
+ *                grouped by kind
+ *
+ *  The transforms of the entities that belong to a parent,
+ *  such as the parts of a prefab instance, are relative to
+ *  the parent's matrix.
+ *
+ *  An entity is named by a handle of a slot and the slot's
+ *  generation, which goes up when the entity is destroyed so
+ *  that old handles stop working.  Next to the chunks, the
+ *  composed matrix of every entity is kept at its slot, for
+ *  the GPU copy, and the slots whose matrix changed are
+ *  listed as ranges after every update.
+ ***********************************************************/
+class SceneWorld
+{
+public:
+	// changed slots are tracked, and copied to the GPU, in
+	// blocks of this many
+	static const uint32_t CHANGED_BLOCK_SLOTS = 64;
+
+	enum COMPONENT
+	{
+		// local scale, rotation and position
+		COMPONENT_TRANSFORM = 0,
+		// composed world matrix
+		COMPONENT_MODEL,
+		// world space box
+		COMPONENT_BOUNDS,
+		// SceneManager::MESH_TYPE
+		COMPONENT_MESH,
+		COMPONENT_COLOR,
+		// SceneManager material and texture handles
+		COMPONENT_MATERIAL,
+		COMPONENT_TEXTURE,
+		// index of the parent the transform is relative to
+		COMPONENT_PARENT,
+		COMPONENT_COUNT
+	};
+
+	// one bit per COMPONENT
+	typedef uint32_t COMPONENT_MASK;
+
+	// the components of a new entity - the material, texture and
+	// parent are left out when they are -1
+	struct ENTITY_DESC
+	{
+		// SceneDescription::OBJECT_KIND
+		int kind;
+		int mesh;
+		glm::vec3 scale;
+		// X, Y and Z rotations in degrees
+		glm::vec3 rotation;
+		glm::vec3 position;
+		glm::vec4 color;
+		int material;
+		int texture;
+		int parent;
+		// already composed world matrix, or NULL to compose it
+		// from the transform on the next update
+		const TransformStore::AFFINE_3X4* pModel;
+		// keep the composed matrix without a transform component -
+		// the entity cannot be moved, and pModel must be set
+		bool bStatic;
+	};
+
+	// names an entity while its slot has the same generation
+	struct ENTITY
+	{
+		uint32_t slot;
+		uint32_t generation;
+	};
+
+	// a run of slots
+	struct SLOT_RANGE
+	{
+		uint32_t first;
+		uint32_t count;
+	};
+
+	// one visible entity of the draw list
+	struct DRAW_ITEM
+	{
+		const TransformStore::AFFINE_3X4* pModel;
+		uint32_t slot;
+		// red, green, blue and alpha
+		const float* pColor;
+		int kind;
+		int mesh;
+		// -1 when the entity has none
+		int material;
+		int texture;
+	};
+
+	// constructor
+	SceneWorld();
+
+	// remove every entity and parent - the slots are kept, so
+	// the handles taken before stay stale
+	void Clear();
+	// add an entity - the slots of destroyed entities are used
+	// again first, so until one is destroyed the slot of an
+	// entity is the number of entities added before it
+	ENTITY CreateEntity(const ENTITY_DESC& desc);
+	// remove an entity, moving the last entity of its archetype
+	// into its row - false when the handle is stale
+	bool DestroyEntity(ENTITY entity);
+	bool IsAlive(ENTITY entity) const;
+	size_t GetEntityCount() const { return(m_slots.size() - m_freeSlots.size()); }
+	// number of slots, the used and the free ones
+	uint32_t GetSlotCount() const { return((uint32_t)m_slots.size()); }
+
+	// replace the parents with the passed in number of parents
+	// with an identity matrix and no children
+	void ResizeParents(size_t count);
+	// make a range of slots the children of a parent
+	void AttachChildren(uint32_t parent, uint32_t firstSlot, uint32_t slotCount);
+	// set the matrix of a parent, as it was already composed
+	void SetParentComposed(uint32_t parent, const TransformStore::AFFINE_3X4& affine);
+	// compose the matrix of a parent from its transform - its
+	// children are composed again on the next update
+	void SetParentTransform(uint32_t parent, const glm::vec3& scale, const glm::vec3& rotation, const glm::vec3& position);
+	// change the transform of one entity, relative to its parent
+	// when it has one - false when the handle is stale or the
+	// entity is static
+	bool SetTransform(ENTITY entity, const glm::vec3& scale, const glm::vec3& rotation, const glm::vec3& position);
+
+	// split the systems across this many threads, counting the
+	// one that runs the update (default 1)
+	void SetThreadCount(int threadCount);
+	int GetThreadCount() const { return(m_workers.GetThreadCount()); }
+	// cull against the frustum of this view-projection matrix -
+	// every entity is drawn until the first one is set
+	void SetCullingView(const glm::mat4& viewProjection);
+
+	// run the transform, culling and draw list systems
+	void Update();
+	// the draw list built by the last update
+	const DRAW_ITEM* GetDrawList() const { return(m_drawList.data()); }
+	uint32_t GetDrawCount() const { return(m_drawCount); }
+	// number of matrices composed by the last update
+	uint32_t GetLastComposed() const { return(m_lastComposed); }
+	// the composed matrix of every slot, and the slots whose
+	// matrix changed before or during the last update
+	const TransformStore::AFFINE_3X4* GetSlotModels() const { return(m_slotModels.data()); }
+	const SLOT_RANGE* GetChangedRanges() const { return(m_changedRanges.data()); }
+	uint32_t GetChangedRangeCount() const { return((uint32_t)m_changedRanges.size()); }
+
+	// bytes held by the chunks and tables
+	uint64_t GetMemoryBytes() const;
+
+private:
+	// entities per chunk, about 16 KB of components
+	static const uint32_t CHUNK_CAPACITY = 128;
+
+	// the arrays of a chunk - the transform component is split
+	// into nine float arrays that the batch kernel takes as
+	// they are
+	enum COLUMN
+	{
+		COLUMN_SCALE_X = 0,
+		COLUMN_SCALE_Y,
+		COLUMN_SCALE_Z,
+		COLUMN_ROTATION_X,
+		COLUMN_ROTATION_Y,
+		COLUMN_ROTATION_Z,
+		COLUMN_POSITION_X,
+		COLUMN_POSITION_Y,
+		COLUMN_POSITION_Z,
+		COLUMN_MODEL,
+		COLUMN_BOUNDS,
+		COLUMN_MESH,
+		COLUMN_COLOR,
+		COLUMN_MATERIAL,
+		COLUMN_TEXTURE,
+		COLUMN_PARENT,
+		// slot of the entity in every row
+		COLUMN_ENTITY,
+		// rows that passed culling
+		COLUMN_VISIBLE,
+		COLUMN_COUNT
+	};
+
+	struct ARCHETYPE
+	{
+		COMPONENT_MASK mask;
+		int kind;
+		// byte offset of every array in a chunk, 0 when the
+		// archetype does not have it
+		size_t columnOffsets[COLUMN_COUNT];
+		size_t chunkBytes;
+		// indices of the chunks in m_chunks - the first
+		// usedChunks hold the entities, every one full but the
+		// last, and the rest were emptied and wait to be used
+		std::vector<uint32_t> chunks;
+		uint32_t usedChunks;
+	};
+
+	struct CHUNK
+	{
+		uint32_t archetype;
+		uint32_t count;
+		// the transforms changed since the matrices were composed
+		bool bDirty;
+		uint32_t visibleCount;
+		// first entry of the chunk in the draw list
+		uint32_t drawOffset;
+		std::vector<unsigned char> memory;
+	};
+
+	// where the entity of a slot is stored
+	struct SLOT
+	{
+		uint32_t chunk;
+		uint32_t row;
+		uint32_t generation;
+		bool bAlive;
+	};
+
+	std::vector<ARCHETYPE> m_archetypes;
+	std::vector<CHUNK> m_chunks;
+	std::vector<SLOT> m_slots;
+	std::vector<uint32_t> m_freeSlots;
+	// chunk indices ordered by kind, the order of the draw list
+	std::vector<uint32_t> m_drawOrder;
+
+	std::vector<TransformStore::AFFINE_3X4> m_parentAffine;
+	std::vector<uint32_t> m_parentFirstChild;
+	std::vector<uint32_t> m_parentChildCount;
+
+	// frustum planes as (a, b, c, d), inside where ax+by+cz+d >= 0
+	glm::vec4 m_frustum[6];
+	bool m_bCulling;
+
+	std::vector<DRAW_ITEM> m_drawList;
+	uint32_t m_drawCount;
+	uint32_t m_lastComposed;
+	// chunks composed by the current update
+	std::vector<uint32_t> m_composedChunks;
+
+	std::vector<TransformStore::AFFINE_3X4> m_slotModels;
+	// one flag per block of slots, the flagged blocks in the
+	// order they changed, and the ranges they were merged into
+	std::vector<unsigned char> m_changedBlocks;
+	std::vector<uint32_t> m_changedBlockList;
+	std::vector<SLOT_RANGE> m_changedRanges;
+
+	WorkerPool m_workers;
+
+	// get the archetype of a component mask and kind, adding it
+	// when there is none yet
+	uint32_t FindArchetype(COMPONENT_MASK mask, int kind);
+	// get a chunk of an archetype with a free row
+	uint32_t FindFreeChunk(uint32_t archetype);
+	// get a free slot, adding one when there is none
+	uint32_t AllocateSlot();
+	// copy every array of a row except the visible list
+	void CopyRow(CHUNK& target, uint32_t targetRow, const CHUNK& source, uint32_t sourceRow);
+	// flag the block of a slot as changed
+	void MarkSlotChanged(uint32_t slot);
+	// merge the flagged blocks into sorted ranges of slots
+	void CollectChangedRanges();
+	// get the array of a chunk
+	template <typename T>
+	T* Column(CHUNK& chunk, COLUMN column) const
+	{
+		return((T*)(chunk.memory.data() + m_archetypes[chunk.archetype].columnOffsets[column]));
+	}
+
+	// the systems, each run over a range of chunks
+	static void TransformJob(void* pContext, uint32_t first, uint32_t count);
+	static void CullingJob(void* pContext, uint32_t first, uint32_t count);
+	static void DrawListJob(void* pContext, uint32_t first, uint32_t count);
+	void UpdateTransforms(CHUNK& chunk);
+	void CullChunk(CHUNK& chunk);
+	void FillDrawList(CHUNK& chunk);
+};
@@ -0,0 +1,197 @@
+///////////////////////////////////////////////////////////////////////////////
+// startupbenchmark.cpp
+// ============
+// compare the time to the first frame with cold and warm file caches
+///////////////////////////////////////////////////////////////////////////////
+
+#include "StartupBenchmark.h"
+
+#include <fstream>
+#include <iostream>
+
+#ifdef __linux__
+#include <dirent.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+// declaration of global variables and helper functions
+namespace
+{
+	// directories whose files are read during startup
+	const char* g_StartupDirectories[] = { "textures", "shaders", "scenes" };
+
+#ifdef __linux__
+	/***********************************************************
+	 *  EvictDirectory()
+	 *
+	 *  This function is used for asking the kernel to drop the
+	 *  cached pages of every file in a directory.  Clean pages
+	 *  are dropped right away, which is all that the startup
+	 *  files ever have since they are only read.
+	 ***********************************************************/
+	bool EvictDirectory(const char* directory)
+	{
+		DIR* pDir = opendir(directory);
+		if (NULL == pDir)
+		{
+			return(false);
+		}
+
+		bool bReturn = true;
+		struct dirent* pEntry = NULL;
+		while ((pEntry = readdir(pDir)) != NULL)
+		{
+			if (pEntry->d_name[0] == '.')
+			{
+				continue;
+			}
+
+			std::string path = std::string(directory) + "/" + pEntry->d_name;
+			int fd = open(path.c_str(), O_RDONLY);
+			if (fd < 0)
+			{
+				bReturn = false;
+				continue;
+			}
+			if (posix_fadvise(fd, 0, 0, POSIX_FADV_DONTNEED) != 0)
+			{
+				bReturn = false;
+			}
+			close(fd);
+		}
+
+		closedir(pDir);
+		return(bReturn);
+	}
+#endif
+}
+
+/***********************************************************
+ *  EvictFileCache()
+ *
+ *  This method is used for dropping the startup files from
+ *  the file cache.  Only Linux lets an unprivileged process
+ *  do this, so elsewhere the cold runs are reported as not
+ *  evicted and are really warm.
+ ***********************************************************/
+bool StartupBenchmark::EvictFileCache()
+{
+#ifdef __linux__
+	bool bReturn = true;
+	for (size_t i = 0; i < sizeof(g_StartupDirectories) / sizeof(g_StartupDirectories[0]); i++)
+	{
+		if (EvictDirectory(g_StartupDirectories[i]) == false)
+		{
+			bReturn = false;
+		}
+	}
+	return(bReturn);
+#else
+	return(false);
+#endif
+}
+
+/***********************************************************
+ *  AddRun()
+ *
+ *  This method is used for storing the time to the first
+ *  frame and the phases of the run that just finished.
+ ***********************************************************/
+void StartupBenchmark::AddRun(bool bCold, bool bEvicted)
+{
+	RUN run;
+	run.bCold = bCold;
+	run.bEvicted = bEvicted;
+	run.firstFrameMs = StartupTimer::Instance().GetFirstFrameMs();
+	run.phases = StartupTimer::Instance().GetPhases();
+	m_runs.push_back(run);
+}
+
+/***********************************************************
+ *  WriteReport()
+ *
+ *  This method is used for writing the JSON report to the
+ *  passed in file path, or to stdout if the path is a single
+ *  dash.
+ ***********************************************************/
+bool StartupBenchmark::WriteReport(const std::string& reportPath) const
+{
+	if (reportPath == "-")
+	{
+		WriteReportJSON(std::cout);
+		return(true);
+	}
+
+	std::ofstream file(reportPath.c_str());
+	if (!file.is_open())
+	{
+		std::cerr << "Could not open benchmark report file:" << reportPath << std::endl;
+		return(false);
+	}
+
+	WriteReportJSON(file);
+	return(file.good());
+}
+
+/***********************************************************
+ *  WriteReportJSON()
+ *
+ *  This method is used for writing the cold runs followed by
+ *  the warm runs.
+ ***********************************************************/
+void StartupBenchmark::WriteReportJSON(std::ostream& out) const
+{
+	out << "{\n";
+	out << "  \"cold\": ";
+	WriteRunsJSON(out, true);
+	out << ",\n  \"warm\": ";
+	WriteRunsJSON(out, false);
+	out << "\n}" << std::endl;
+}
+
+/***********************************************************
+ *  WriteRunsJSON()
+ *
+ *  This method is used for writing the mean time to the
+ *  first frame of the cold or the warm runs, followed by
+ *  every run with its phases.
+ ***********************************************************/
+void StartupBenchmark::WriteRunsJSON(std::ostream& out, bool bCold) const
+{
+	double total = 0.0;
+	int count = 0;
+	for (size_t i = 0; i < m_runs.size(); i++)
+	{
+		if (m_runs[i].bCold == bCold)
+		{
+			total += m_runs[i].firstFrameMs;
+			count++;
+		}
+	}
+
+	out << "{\n";
+	out << "    \"mean_time_to_first_frame_ms\": " << ((count > 0) ? total / count : 0.0) << ",\n";
+	out << "    \"runs\": [\n";
+
+	int written = 0;
+	for (size_t i = 0; i < m_runs.size(); i++)
+	{
+		const RUN& run = m_runs[i];
+		if (run.bCold != bCold)
+		{
+			continue;
+		}
+
+		out << "      {\n";
+		out << "        \"cache_evicted\": " << (run.bEvicted ? "true" : "false") << ",\n";
+		out << "        \"time_to_first_frame_ms\": " << run.firstFrameMs << ",\n";
+		out << "        \"phases\": ";
+		StartupTimer::WritePhasesJSON(out, run.phases, "        ");
+		out << "\n      }";
+
+		written++;
+		out << ((written < count) ? ",\n" : "\n");
+	}
+	out << "    ]\n  }";
+}
@@ -0,0 +1,52 @@
+///////////////////////////////////////////////////////////////////////////////
+// startupbenchmark.h
+// ============
+// compare the time to the first frame with cold and warm file caches
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include "StartupTimer.h"
+
+#include <ostream>
+#include <string>
+#include <vector>
+
+/***********************************************************
+ *  StartupBenchmark
+ *
+ *  This class collects the startup phases of repeated
+ *  headless startups and writes them out as one report.
+ *  Before a cold run the texture and shader files are
+ *  dropped from the operating system file cache, so that
+ *  the cold runs include reading them from disk.
+ ***********************************************************/
+class StartupBenchmark
+{
+public:
+	// drop the texture and shader files from the file cache -
+	// returns false where this is not supported
+	static bool EvictFileCache();
+
+	// store the phases that the startup timer recorded for a run
+	void AddRun(bool bCold, bool bEvicted);
+	// write the JSON report to a file, or stdout for "-"
+	bool WriteReport(const std::string& reportPath) const;
+
+private:
+	struct RUN
+	{
+		bool bCold;
+		// whether the file cache was really dropped before the run
+		bool bEvicted;
+		double firstFrameMs;
+		std::vector<StartupTimer::PHASE> phases;
+	};
+
+	std::vector<RUN> m_runs;
+
+	// write the JSON report into the passed in stream
+	void WriteReportJSON(std::ostream& out) const;
+	// write the runs of one kind and their mean time to first frame
+	void WriteRunsJSON(std::ostream& out, bool bCold) const;
+};
@@ -0,0 +1,181 @@
+///////////////////////////////////////////////////////////////////////////////
+// startuptimer.cpp
+// ============
+// time the phases of application startup up to the first rendered frame
+///////////////////////////////////////////////////////////////////////////////
+
+#include "StartupTimer.h"
+
+#include <fstream>
+#include <iostream>
+
+/***********************************************************
+ *  Instance()
+ *
+ *  This method is used for getting the single startup timer
+ *  that all of the phases are recorded into.
+ ***********************************************************/
+StartupTimer& StartupTimer::Instance()
+{
+	static StartupTimer timer;
+	return(timer);
+}
+
+/***********************************************************
+ *  StartupTimer()
+ *
+ *  The constructor for the class
+ ***********************************************************/
+StartupTimer::StartupTimer()
+{
+	Reset();
+}
+
+/***********************************************************
+ *  Reset()
+ *
+ *  This method is used for restarting the clock, so that the
+ *  next phases and the first frame are timed from now.
+ ***********************************************************/
+void StartupTimer::Reset()
+{
+	m_start = std::chrono::steady_clock::now();
+	m_phases.clear();
+	m_depth = 0;
+	m_firstFrameMs = -1.0;
+}
+
+/***********************************************************
+ *  NowMs()
+ *
+ *  This method is used for getting the milliseconds since
+ *  the clock was started.
+ ***********************************************************/
+double StartupTimer::NowMs() const
+{
+	return(std::chrono::duration<double, std::milli>(
+		std::chrono::steady_clock::now() - m_start).count());
+}
+
+/***********************************************************
+ *  BeginPhase()
+ *
+ *  This method is used for opening a named phase.  The
+ *  returned index is passed to EndPhase() to close it.
+ ***********************************************************/
+int StartupTimer::BeginPhase(const std::string& name)
+{
+	PHASE phase;
+	phase.name = name;
+	phase.depth = m_depth;
+	phase.startMs = NowMs();
+	phase.durationMs = 0.0;
+	m_phases.push_back(phase);
+
+	m_depth++;
+	return((int)m_phases.size() - 1);
+}
+
+/***********************************************************
+ *  EndPhase()
+ *
+ *  This method is used for closing a phase that was opened
+ *  with BeginPhase().
+ ***********************************************************/
+void StartupTimer::EndPhase(int phaseIndex)
+{
+	if ((phaseIndex < 0) || (phaseIndex >= (int)m_phases.size()))
+	{
+		return;
+	}
+
+	m_phases[phaseIndex].durationMs = NowMs() - m_phases[phaseIndex].startMs;
+	m_depth--;
+}
+
+/***********************************************************
+ *  MarkFirstFrame()
+ *
+ *  This method is used for recording the time to the first
+ *  rendered frame.  Only the first call is recorded.
+ ***********************************************************/
+void StartupTimer::MarkFirstFrame()
+{
+	if (m_firstFrameMs < 0.0)
+	{
+		m_firstFrameMs = NowMs();
+	}
+}
+
+/***********************************************************
+ *  WriteReport()
+ *
+ *  This method is used for writing the time to the first
+ *  frame and the recorded phases to the passed in file path,
+ *  or to stdout if the path is a single dash.
+ ***********************************************************/
+bool StartupTimer::WriteReport(const std::string& reportPath) const
+{
+	if (reportPath == "-")
+	{
+		WriteReportJSON(std::cout);
+		return(true);
+	}
+
+	std::ofstream file(reportPath.c_str());
+	if (!file.is_open())
+	{
+		std::cerr << "Could not open startup report file:" << reportPath << std::endl;
+		return(false);
+	}
+
+	WriteReportJSON(file);
+	return(file.good());
+}
+
+/***********************************************************
+ *  WriteReportJSON()
+ *
+ *  This method is used for writing the time to the first
+ *  frame followed by the recorded phases.
+ ***********************************************************/
+void StartupTimer::WriteReportJSON(std::ostream& out) const
+{
+	out << "{\n";
+	out << "  \"time_to_first_frame_ms\": " << m_firstFrameMs << ",\n";
+	out << "  \"phases\": ";
+	WritePhasesJSON(out, m_phases, "  ");
+	out << "\n}" << std::endl;
+}
+
+/***********************************************************
+ *  WritePhasesJSON()
+ *
+ *  This method is used for writing the passed in phases as a
+ *  JSON array with one phase object per line.
+ ***********************************************************/
+void StartupTimer::WritePhasesJSON(std::ostream& out, const std::vector<PHASE>& phases, const char* indent)
+{
+	out << "[\n";
+	for (size_t i = 0; i < phases.size(); i++)
+	{
+		const PHASE& phase = phases[i];
+
+		out << indent << "  { \"name\": \"";
+		// the names are file paths and literals, so only the JSON
+		// special characters that can show up in paths are escaped
+		for (size_t c = 0; c < phase.name.size(); c++)
+		{
+			if ((phase.name[c] == '"') || (phase.name[c] == '\\'))
+			{
+				out << '\\';
+			}
+			out << phase.name[c];
+		}
+		out << "\", \"depth\": " << phase.depth
+			<< ", \"start_ms\": " << phase.startMs
+			<< ", \"duration_ms\": " << phase.durationMs << " }"
+			<< ((i + 1 < phases.size()) ? ",\n" : "\n");
+	}
+	out << indent << "]";
+}
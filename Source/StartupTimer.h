@@ -0,0 +1,99 @@
+///////////////////////////////////////////////////////////////////////////////
+// startuptimer.h
+// ============
+// time the phases of application startup up to the first rendered frame
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <chrono>
+#include <ostream>
+#include <string>
+#include <vector>
+
+/***********************************************************
+ *  StartupTimer
+ *
+ *  This class records the wall clock time of named, nested
+ *  startup phases such as the window creation, the shader
+ *  compile and every texture decode and upload, along with
+ *  the time until the first frame was rendered.  Startup only
+ *  happens once, so the phase names are copied and there is
+ *  no attempt to keep the recording cheap.
+ ***********************************************************/
+class StartupTimer
+{
+public:
+	struct PHASE
+	{
+		std::string name;
+		// nesting depth, 0 for the outermost phases
+		int depth;
+		// start time relative to the start of the clock
+		double startMs;
+		double durationMs;
+	};
+
+	// get the single startup timer instance
+	static StartupTimer& Instance();
+
+	// restart the clock and forget the recorded phases
+	void Reset();
+
+	// open and close a named phase
+	int BeginPhase(const std::string& name);
+	void EndPhase(int phaseIndex);
+
+	// mark the end of the first rendered frame - later calls are ignored
+	void MarkFirstFrame();
+	// time from the start of the clock to the first frame, or -1
+	double GetFirstFrameMs() const { return(m_firstFrameMs); }
+	const std::vector<PHASE>& GetPhases() const { return(m_phases); }
+
+	// write the JSON startup report to a file, or stdout for "-"
+	bool WriteReport(const std::string& reportPath) const;
+	// write a list of phases as a JSON array, each line indented
+	static void WritePhasesJSON(std::ostream& out, const std::vector<PHASE>& phases, const char* indent);
+
+private:
+	// constructor
+	StartupTimer();
+
+	std::chrono::steady_clock::time_point m_start;
+	std::vector<PHASE> m_phases;
+	// current nesting depth of the open phases
+	int m_depth;
+	double m_firstFrameMs;
+
+	// milliseconds since the start of the clock
+	double NowMs() const;
+	// write the JSON report into the passed in stream
+	void WriteReportJSON(std::ostream& out) const;
+};
+
+/***********************************************************
+ *  StartupPhase
+ *
+ *  This class opens a startup phase when it is constructed
+ *  and closes it again when it goes out of scope.
+ ***********************************************************/
+class StartupPhase
+{
+public:
+	explicit StartupPhase(const std::string& name)
+	{
+		m_phaseIndex = StartupTimer::Instance().BeginPhase(name);
+	}
+	~StartupPhase()
+	{
+		StartupTimer::Instance().EndPhase(m_phaseIndex);
+	}
+
+private:
+	int m_phaseIndex;
+};
+
+#define STARTUP_PHASE_CONCAT2(a, b) a##b
+#define STARTUP_PHASE_CONCAT(a, b) STARTUP_PHASE_CONCAT2(a, b)
+// time the rest of the enclosing scope as a startup phase
+#define STARTUP_PHASE(name) StartupPhase STARTUP_PHASE_CONCAT(startupPhase, __LINE__)(name)
@@ -0,0 +1,119 @@
+///////////////////////////////////////////////////////////////////////////////
+// stressscene.cpp
+// ============
+// generate large seeded scenes of the tree, mountain and cloud shapes
+///////////////////////////////////////////////////////////////////////////////
+
+#include "StressScene.h"
+
+#include <random>
+
+// declaration of global variables
+namespace
+{
+	// area of the ground plane the trees are placed on, in
+	// front of the default camera
+	const float GROUND_MIN_X = -100.0f;
+	const float GROUND_MAX_X = 100.0f;
+	const float GROUND_MIN_Z = -200.0f;
+	const float GROUND_MAX_Z = 0.0f;
+
+	// the mountains stand in the back half of the ground, and
+	// sink into it by half their size like the hand-placed ones
+	const float MOUNTAIN_MIN_Z = -200.0f;
+	const float MOUNTAIN_MAX_Z = -70.0f;
+	const float MOUNTAIN_MIN_SCALE = 20.0f;
+	const float MOUNTAIN_MAX_SCALE = 50.0f;
+
+	// the clouds float above the whole ground plane
+	const float CLOUD_MIN_Y = 50.0f;
+	const float CLOUD_MAX_Y = 100.0f;
+	const float CLOUD_MIN_SCALE = 1.0f;
+	const float CLOUD_MAX_SCALE = 3.0f;
+}
+
+/***********************************************************
+ *  Generate()
+ *
+ *  This method is used for placing the objects of each kind
+ *  with a random generator seeded by the passed in seed.
+ *  The first kinds get one extra object each when the count
+ *  does not divide evenly.
+ ***********************************************************/
+void StressScene::Generate(uint32_t objectCount, uint32_t seed)
+{
+	std::mt19937 random(seed);
+	std::uniform_real_distribution<float> groundX(GROUND_MIN_X, GROUND_MAX_X);
+	std::uniform_real_distribution<float> groundZ(GROUND_MIN_Z, GROUND_MAX_Z);
+	std::uniform_real_distribution<float> mountainZ(MOUNTAIN_MIN_Z, MOUNTAIN_MAX_Z);
+	std::uniform_real_distribution<float> mountainScale(MOUNTAIN_MIN_SCALE, MOUNTAIN_MAX_SCALE);
+	std::uniform_real_distribution<float> cloudY(CLOUD_MIN_Y, CLOUD_MAX_Y);
+	std::uniform_real_distribution<float> cloudScale(CLOUD_MIN_SCALE, CLOUD_MAX_SCALE);
+
+	m_objects.clear();
+	m_objects.reserve(objectCount);
+
+	for (int kind = 0; kind < KIND_COUNT; kind++)
+	{
+		uint32_t kindCount = objectCount / KIND_COUNT;
+		if ((uint32_t)kind < objectCount % KIND_COUNT)
+		{
+			kindCount++;
+		}
+
+		for (uint32_t i = 0; i < kindCount; i++)
+		{
+			OBJECT object;
+			object.kind = (OBJECT_KIND)kind;
+			object.x = groundX(random);
+			object.y = 0.0f;
+			object.z = groundZ(random);
+			object.scale = 1.0f;
+
+			if (object.kind == KIND_MOUNTAIN)
+			{
+				object.z = mountainZ(random);
+				object.scale = mountainScale(random);
+				object.y = object.scale * 0.5f;
+			}
+			else if (object.kind == KIND_CLOUD)
+			{
+				object.y = cloudY(random);
+				object.scale = cloudScale(random);
+			}
+
+			m_objects.push_back(object);
+		}
+	}
+}
+
+/***********************************************************
+ *  AddToScene()
+ *
+ *  This method is used for expanding every generated object
+ *  into the meshes of its composite shape.
+ ***********************************************************/
+void StressScene::AddToScene(SceneDescription& scene) const
+{
+	for (size_t i = 0; i < m_objects.size(); i++)
+	{
+		const OBJECT& object = m_objects[i];
+		switch (object.kind)
+		{
+		case KIND_PYRAMID_TREE:
+			scene.AddPyramidTree(object.x, object.y, object.z);
+			break;
+		case KIND_SPHERICAL_TREE:
+			scene.AddSphericalTree(object.x, object.y, object.z);
+			break;
+		case KIND_MOUNTAIN:
+			scene.AddMountain(object.x, object.y, object.z, object.scale);
+			break;
+		case KIND_CLOUD:
+			scene.AddCloud(object.x, object.y, object.z, object.scale);
+			break;
+		default:
+			break;
+		}
+	}
+}
@@ -0,0 +1,58 @@
+///////////////////////////////////////////////////////////////////////////////
+// stressscene.h
+// ============
+// generate large seeded scenes of the tree, mountain and cloud shapes
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include "SceneDescription.h"
+
+#include <cstdint>
+#include <vector>
+
+/***********************************************************
+ *  StressScene
+ *
+ *  This class places a requested number of pyramid trees,
+ *  spherical trees, mountains and clouds at random over the
+ *  ground plane of the scene.  The objects are split evenly
+ *  between the four kinds, and the same seed always gives
+ *  the same scene, so runs with the same count compare.  The
+ *  objects are added to a scene description with the same
+ *  composite shapes as the scene file uses.
+ ***********************************************************/
+class StressScene
+{
+public:
+	enum OBJECT_KIND
+	{
+		KIND_PYRAMID_TREE = 0,
+		KIND_SPHERICAL_TREE,
+		KIND_MOUNTAIN,
+		KIND_CLOUD,
+		KIND_COUNT
+	};
+
+	struct OBJECT
+	{
+		OBJECT_KIND kind;
+		float x;
+		float y;
+		float z;
+		// only used by the mountains and clouds
+		float scale;
+	};
+
+	// replace the objects with a newly placed set
+	void Generate(uint32_t objectCount, uint32_t seed);
+
+	// objects sorted by kind, so that each kind is drawn as
+	// one run of draws
+	const std::vector<OBJECT>& GetObjects() const { return(m_objects); }
+	// add the meshes of every object to the passed in scene
+	void AddToScene(SceneDescription& scene) const;
+
+private:
+	std::vector<OBJECT> m_objects;
+};
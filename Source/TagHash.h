@@ -0,0 +1,33 @@
+///////////////////////////////////////////////////////////////////////////////
+// taghash.h
+// ============
+// hash texture and material tags, at compile time for string literals
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <cstdint>
+
+/***********************************************************
+ *  HashTag()
+ *
+ *  This function is used for getting the 32-bit FNV-1a hash
+ *  of a tag.  It is a constant expression, so the hash of a
+ *  literal tag can be computed by the compiler:
+ *
+ *    constexpr uint32_t LOG_TAG = HashTag("log");
+ *
+ *  and passed to SceneManager::ResolveTexture() or
+ *  ResolveMaterial() to get the tag's handle.
+ ***********************************************************/
+constexpr uint32_t HashTag(const char* tag)
+{
+	uint32_t hash = 2166136261u;
+	while (*tag != '\0')
+	{
+		hash ^= (uint8_t)*tag;
+		hash *= 16777619u;
+		tag++;
+	}
+	return(hash);
+}
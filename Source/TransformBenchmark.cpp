@@ -0,0 +1,184 @@
+///////////////////////////////////////////////////////////////////////////////
+// transformbenchmark.cpp
+// ============
+// compare per-object matrix building against the batched transform store
+///////////////////////////////////////////////////////////////////////////////
+
+#include "TransformBenchmark.h"
+#include "TransformStore.h"
+
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <iostream>
+
+// declaration of global variables and helper functions
+namespace
+{
+	// each measurement is repeated and the fastest run is kept
+	const int REPEAT_COUNT = 5;
+
+	const int OBJECT_COUNTS[] = { 1000, 10000, 100000, 1000000 };
+
+	typedef std::chrono::steady_clock Clock;
+
+	/***********************************************************
+	 *  NsPerObject()
+	 *
+	 *  This function is used for converting a timed run into
+	 *  nanoseconds per object.
+	 ***********************************************************/
+	double NsPerObject(Clock::time_point start, Clock::time_point end, int objects)
+	{
+		return(std::chrono::duration<double, std::nano>(end - start).count() / objects);
+	}
+
+	/***********************************************************
+	 *  MakeTransform()
+	 *
+	 *  This function is used for building a varied transform for
+	 *  the numbered object, the same for every method.
+	 ***********************************************************/
+	void MakeTransform(int index, glm::vec3& scale, glm::vec3& rotation, glm::vec3& position)
+	{
+		float value = (float)(index & 255);
+		scale = glm::vec3(1.0f + value, 2.0f, 3.0f);
+		rotation = glm::vec3(value, 15.0f + value * 0.5f, -value);
+		position = glm::vec3(value, 0.0f, -value);
+	}
+}
+
+/***********************************************************
+ *  RunSetTransformations()
+ *
+ *  This method is used for timing one SetTransformations call
+ *  per object, the way the scene was drawn before the
+ *  transform store.
+ ***********************************************************/
+void TransformBenchmark::RunSetTransformations(int objects)
+{
+	SceneManager scene(NULL);
+	double best = 0.0;
+
+	for (int repeat = 0; repeat < REPEAT_COUNT; repeat++)
+	{
+		Clock::time_point start = Clock::now();
+		for (int i = 0; i < objects; i++)
+		{
+			glm::vec3 scale, rotation, position;
+			MakeTransform(i, scale, rotation, position);
+			scene.SetTransformations(scale, rotation.x, rotation.y, rotation.z, position);
+		}
+		Clock::time_point end = Clock::now();
+
+		double ns = NsPerObject(start, end, objects);
+		best = (repeat == 0) ? ns : std::min(best, ns);
+	}
+
+	RESULT result = { "SetTransformations", objects, best };
+	m_results.push_back(result);
+}
+
+/***********************************************************
+ *  RunTransformStore()
+ *
+ *  This method is used for timing the composition of every
+ *  matrix of a filled transform store, once with the plain
+ *  C++ kernel and once with the built batch kernel.
+ ***********************************************************/
+void TransformBenchmark::RunTransformStore(int objects)
+{
+	TransformStore store;
+	store.Resize(objects);
+	for (int i = 0; i < objects; i++)
+	{
+		glm::vec3 scale, rotation, position;
+		MakeTransform(i, scale, rotation, position);
+		store.Set((uint32_t)i, scale, rotation, position);
+	}
+
+	double bestScalar = 0.0;
+	double bestBatch = 0.0;
+	for (int repeat = 0; repeat < REPEAT_COUNT; repeat++)
+	{
+		Clock::time_point start = Clock::now();
+		store.ComposeAll(true);
+		Clock::time_point middle = Clock::now();
+		store.ComposeAll(false);
+		Clock::time_point end = Clock::now();
+
+		double scalarNs = NsPerObject(start, middle, objects);
+		double batchNs = NsPerObject(middle, end, objects);
+		bestScalar = (repeat == 0) ? scalarNs : std::min(bestScalar, scalarNs);
+		bestBatch = (repeat == 0) ? batchNs : std::min(bestBatch, batchNs);
+	}
+
+	RESULT scalarResult = { "TransformStore scalar", objects, bestScalar };
+	RESULT batchResult = { "TransformStore batch", objects, bestBatch };
+	m_results.push_back(scalarResult);
+	m_results.push_back(batchResult);
+}
+
+/***********************************************************
+ *  Run()
+ *
+ *  This method is used for running every method over every
+ *  object count.
+ ***********************************************************/
+void TransformBenchmark::Run()
+{
+	m_results.clear();
+
+	for (size_t o = 0; o < sizeof(OBJECT_COUNTS) / sizeof(OBJECT_COUNTS[0]); o++)
+	{
+		RunSetTransformations(OBJECT_COUNTS[o]);
+		RunTransformStore(OBJECT_COUNTS[o]);
+	}
+}
+
+/***********************************************************
+ *  WriteReport()
+ *
+ *  This method is used for writing the JSON report to the
+ *  passed in file path, or to stdout if the path is a single
+ *  dash.
+ ***********************************************************/
+bool TransformBenchmark::WriteReport(const std::string& reportPath) const
+{
+	if (reportPath == "-")
+	{
+		WriteReportJSON(std::cout);
+		return(true);
+	}
+
+	std::ofstream file(reportPath.c_str());
+	if (!file.is_open())
+	{
+		std::cerr << "Could not open benchmark report file:" << reportPath << std::endl;
+		return(false);
+	}
+
+	WriteReportJSON(file);
+	return(file.good());
+}
+
+/***********************************************************
+ *  WriteReportJSON()
+ *
+ *  This method is used for writing the batch kernel name and
+ *  one JSON entry for every method and object count.
+ ***********************************************************/
+void TransformBenchmark::WriteReportJSON(std::ostream& out) const
+{
+	out << "{\n  \"kernel\": \"" << TransformStore::GetKernelName() << "\",\n"
+		<< "  \"transform_benchmarks\": [\n";
+	for (size_t i = 0; i < m_results.size(); i++)
+	{
+		const RESULT& result = m_results[i];
+		out << "    { \"method\": \"" << result.method << "\""
+			<< ", \"objects\": " << result.objects
+			<< ", \"ns_per_object\": " << result.nsPerObject << " }"
+			<< ((i + 1 < m_results.size()) ? ",\n" : "\n");
+	}
+	out << "  ]\n}" << std::endl;
+}
@@ -0,0 +1,48 @@
+///////////////////////////////////////////////////////////////////////////////
+// transformbenchmark.h
+// ============
+// compare per-object matrix building against the batched transform store
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include "SceneManager.h"
+
+#include <ostream>
+#include <string>
+#include <vector>
+
+/***********************************************************
+ *  TransformBenchmark
+ *
+ *  This class times building the model matrices of 1k to 1M
+ *  objects three ways - one SetTransformations call per
+ *  object, the transform store with its plain C++ kernel and
+ *  the transform store with the SIMD kernel the build uses.
+ *  No OpenGL context is needed.
+ ***********************************************************/
+class TransformBenchmark
+{
+public:
+	struct RESULT
+	{
+		const char* method;
+		int objects;
+		// fastest time of the repeated runs
+		double nsPerObject;
+	};
+
+	// run every method over every object count
+	void Run();
+	// write the JSON report to a file, or stdout for "-"
+	bool WriteReport(const std::string& reportPath) const;
+
+private:
+	std::vector<RESULT> m_results;
+
+	void RunSetTransformations(int objects);
+	void RunTransformStore(int objects);
+
+	// write the JSON report into the passed in stream
+	void WriteReportJSON(std::ostream& out) const;
+};
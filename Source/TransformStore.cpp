@@ -0,0 +1,767 @@
+///////////////////////////////////////////////////////////////////////////////
+// transformstore.cpp
+// ============
+// structure-of-arrays object transforms composed into affine matrices in batches
+///////////////////////////////////////////////////////////////////////////////
+
+#include "TransformStore.h"
+
+#include <cmath>
+
+#if defined(__AVX2__)
+#define TRANSFORM_STORE_AVX2
+#include <immintrin.h>
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && (_M_IX86_FP >= 2))
+#define TRANSFORM_STORE_SSE2
+#include <emmintrin.h>
+#endif
+
+// declaration of global variables and helper functions
+namespace
+{
+	const float DEGREES_TO_RADIANS = 3.14159265358979f / 180.0f;
+	const float TWO_OVER_PI = 0.636619772367581f;
+
+	// pi / 2 split into three parts, so that subtracting whole
+	// quarter turns from an angle stays exact
+	const float HALF_PI_1 = 1.5703125f;
+	const float HALF_PI_2 = 4.837512969970703125e-4f;
+	const float HALF_PI_3 = 7.54978995489188216e-8f;
+
+	// minimax polynomials of sine and cosine on [-pi/4, pi/4]
+	const float SIN_1 = -1.6666654611e-1f;
+	const float SIN_2 = 8.3321608736e-3f;
+	const float SIN_3 = -1.9515295891e-4f;
+	const float COS_1 = 4.166664568298827e-2f;
+	const float COS_2 = -1.388731625493765e-3f;
+	const float COS_3 = 2.443315711809948e-5f;
+
+	// the dirty objects are copied together in groups of this
+	// many before they are composed
+	const int GATHER_SIZE = 8;
+
+	// pointers to the nine input arrays of a batch
+	struct SOA_INPUT
+	{
+		const float* scale[3];
+		const float* rotation[3];
+		const float* position[3];
+	};
+
+	/***********************************************************
+	 *  SinCos()
+	 *
+	 *  This function is used for getting the sine and cosine of
+	 *  an angle in degrees.  The angle is reduced to a quarter
+	 *  turn around zero and the quarter selects which of the
+	 *  two polynomials gives which result and their signs - the
+	 *  SIMD kernels follow the same steps lane by lane.
+	 ***********************************************************/
+	void SinCos(float degrees, float& sine, float& cosine)
+	{
+		float x = degrees * DEGREES_TO_RADIANS;
+		int quarter = (int)std::lrint(x * TWO_OVER_PI);
+		float q = (float)quarter;
+		float r = ((x - q * HALF_PI_1) - q * HALF_PI_2) - q * HALF_PI_3;
+		float r2 = r * r;
+
+		float s = r + r * r2 * (SIN_1 + r2 * (SIN_2 + r2 * SIN_3));
+		float c = 1.0f - 0.5f * r2 + r2 * r2 * (COS_1 + r2 * (COS_2 + r2 * COS_3));
+
+		if (quarter & 1)
+		{
+			float swap = s;
+			s = c;
+			c = swap;
+		}
+		sine = (quarter & 2) ? -s : s;
+		cosine = ((quarter + 1) & 2) ? -c : c;
+	}
+
+	/***********************************************************
+	 *  ComposeScalar()
+	 *
+	 *  This function is used for composing the matrices of a
+	 *  range of objects one at a time.
+	 ***********************************************************/
+	void ComposeScalar(const SOA_INPUT& in, size_t first, size_t count, TransformStore::AFFINE_3X4* pOut)
+	{
+		for (size_t i = first; i < first + count; i++)
+		{
+			float sx, cx, sy, cy, sz, cz;
+			SinCos(in.rotation[0][i], sx, cx);
+			SinCos(in.rotation[1][i], sy, cy);
+			SinCos(in.rotation[2][i], sz, cz);
+
+			float scaleX = in.scale[0][i];
+			float scaleY = in.scale[1][i];
+			float scaleZ = in.scale[2][i];
+			float* m = pOut[i].m;
+
+			// rotation Rz * Ry * Rx with each column scaled
+			m[0] = cy * cz * scaleX;
+			m[1] = (sx * sy * cz - cx * sz) * scaleY;
+			m[2] = (cx * sy * cz + sx * sz) * scaleZ;
+			m[3] = in.position[0][i];
+			m[4] = cy * sz * scaleX;
+			m[5] = (sx * sy * sz + cx * cz) * scaleY;
+			m[6] = (cx * sy * sz - sx * cz) * scaleZ;
+			m[7] = in.position[1][i];
+			m[8] = -sy * scaleX;
+			m[9] = sx * cy * scaleY;
+			m[10] = cx * cy * scaleZ;
+			m[11] = in.position[2][i];
+		}
+	}
+
+#if defined(TRANSFORM_STORE_AVX2)
+	/***********************************************************
+	 *  SinCos8()
+	 *
+	 *  This function is used for getting the sines and cosines
+	 *  of eight angles in degrees.
+	 ***********************************************************/
+	void SinCos8(__m256 degrees, __m256& sine, __m256& cosine)
+	{
+		__m256 x = _mm256_mul_ps(degrees, _mm256_set1_ps(DEGREES_TO_RADIANS));
+		__m256i quarter = _mm256_cvtps_epi32(_mm256_mul_ps(x, _mm256_set1_ps(TWO_OVER_PI)));
+		__m256 q = _mm256_cvtepi32_ps(quarter);
+		__m256 r = _mm256_sub_ps(x, _mm256_mul_ps(q, _mm256_set1_ps(HALF_PI_1)));
+		r = _mm256_sub_ps(r, _mm256_mul_ps(q, _mm256_set1_ps(HALF_PI_2)));
+		r = _mm256_sub_ps(r, _mm256_mul_ps(q, _mm256_set1_ps(HALF_PI_3)));
+		__m256 r2 = _mm256_mul_ps(r, r);
+
+		__m256 s = _mm256_add_ps(_mm256_set1_ps(SIN_2), _mm256_mul_ps(r2, _mm256_set1_ps(SIN_3)));
+		s = _mm256_add_ps(_mm256_set1_ps(SIN_1), _mm256_mul_ps(r2, s));
+		s = _mm256_add_ps(r, _mm256_mul_ps(_mm256_mul_ps(r, r2), s));
+
+		__m256 c = _mm256_add_ps(_mm256_set1_ps(COS_2), _mm256_mul_ps(r2, _mm256_set1_ps(COS_3)));
+		c = _mm256_add_ps(_mm256_set1_ps(COS_1), _mm256_mul_ps(r2, c));
+		c = _mm256_add_ps(_mm256_mul_ps(_mm256_mul_ps(r2, r2), c),
+			_mm256_sub_ps(_mm256_set1_ps(1.0f), _mm256_mul_ps(_mm256_set1_ps(0.5f), r2)));
+
+		__m256i one = _mm256_set1_epi32(1);
+		__m256i two = _mm256_set1_epi32(2);
+		__m256 swap = _mm256_castsi256_ps(_mm256_cmpeq_epi32(_mm256_and_si256(quarter, one), one));
+		__m256 sineSign = _mm256_castsi256_ps(_mm256_slli_epi32(_mm256_and_si256(quarter, two), 30));
+		__m256 cosineSign = _mm256_castsi256_ps(
+			_mm256_slli_epi32(_mm256_and_si256(_mm256_add_epi32(quarter, one), two), 30));
+
+		sine = _mm256_xor_ps(_mm256_blendv_ps(s, c, swap), sineSign);
+		cosine = _mm256_xor_ps(_mm256_blendv_ps(c, s, swap), cosineSign);
+	}
+
+	/***********************************************************
+	 *  StoreRows8()
+	 *
+	 *  This function is used for transposing one row of eight
+	 *  matrices, held as four registers of eight lanes, and
+	 *  storing it into the matrices.
+	 ***********************************************************/
+	void StoreRows8(__m256 c0, __m256 c1, __m256 c2, __m256 c3, int row, TransformStore::AFFINE_3X4* pOut)
+	{
+		__m256 t0 = _mm256_unpacklo_ps(c0, c1);
+		__m256 t1 = _mm256_unpackhi_ps(c0, c1);
+		__m256 t2 = _mm256_unpacklo_ps(c2, c3);
+		__m256 t3 = _mm256_unpackhi_ps(c2, c3);
+		// each 128 bit half holds the row of one matrix, the low
+		// halves are matrices 0-3 and the high halves 4-7
+		__m256 u0 = _mm256_shuffle_ps(t0, t2, _MM_SHUFFLE(1, 0, 1, 0));
+		__m256 u1 = _mm256_shuffle_ps(t0, t2, _MM_SHUFFLE(3, 2, 3, 2));
+		__m256 u2 = _mm256_shuffle_ps(t1, t3, _MM_SHUFFLE(1, 0, 1, 0));
+		__m256 u3 = _mm256_shuffle_ps(t1, t3, _MM_SHUFFLE(3, 2, 3, 2));
+
+		_mm_storeu_ps(pOut[0].m + row * 4, _mm256_castps256_ps128(u0));
+		_mm_storeu_ps(pOut[1].m + row * 4, _mm256_castps256_ps128(u1));
+		_mm_storeu_ps(pOut[2].m + row * 4, _mm256_castps256_ps128(u2));
+		_mm_storeu_ps(pOut[3].m + row * 4, _mm256_castps256_ps128(u3));
+		_mm_storeu_ps(pOut[4].m + row * 4, _mm256_extractf128_ps(u0, 1));
+		_mm_storeu_ps(pOut[5].m + row * 4, _mm256_extractf128_ps(u1, 1));
+		_mm_storeu_ps(pOut[6].m + row * 4, _mm256_extractf128_ps(u2, 1));
+		_mm_storeu_ps(pOut[7].m + row * 4, _mm256_extractf128_ps(u3, 1));
+	}
+
+	/***********************************************************
+	 *  ComposeSIMD()
+	 *
+	 *  This function is used for composing the matrices of a
+	 *  range of objects eight at a time, and the remainder with
+	 *  the scalar kernel.
+	 ***********************************************************/
+	void ComposeSIMD(const SOA_INPUT& in, size_t first, size_t count, TransformStore::AFFINE_3X4* pOut)
+	{
+		size_t end = first + count;
+		size_t i = first;
+		for (; i + 8 <= end; i += 8)
+		{
+			__m256 sx, cx, sy, cy, sz, cz;
+			SinCos8(_mm256_loadu_ps(in.rotation[0] + i), sx, cx);
+			SinCos8(_mm256_loadu_ps(in.rotation[1] + i), sy, cy);
+			SinCos8(_mm256_loadu_ps(in.rotation[2] + i), sz, cz);
+
+			__m256 scaleX = _mm256_loadu_ps(in.scale[0] + i);
+			__m256 scaleY = _mm256_loadu_ps(in.scale[1] + i);
+			__m256 scaleZ = _mm256_loadu_ps(in.scale[2] + i);
+			__m256 sxsy = _mm256_mul_ps(sx, sy);
+			__m256 cxsy = _mm256_mul_ps(cx, sy);
+
+			__m256 m00 = _mm256_mul_ps(_mm256_mul_ps(cy, cz), scaleX);
+			__m256 m01 = _mm256_mul_ps(_mm256_sub_ps(_mm256_mul_ps(sxsy, cz), _mm256_mul_ps(cx, sz)), scaleY);
+			__m256 m02 = _mm256_mul_ps(_mm256_add_ps(_mm256_mul_ps(cxsy, cz), _mm256_mul_ps(sx, sz)), scaleZ);
+			__m256 m10 = _mm256_mul_ps(_mm256_mul_ps(cy, sz), scaleX);
+			__m256 m11 = _mm256_mul_ps(_mm256_add_ps(_mm256_mul_ps(sxsy, sz), _mm256_mul_ps(cx, cz)), scaleY);
+			__m256 m12 = _mm256_mul_ps(_mm256_sub_ps(_mm256_mul_ps(cxsy, sz), _mm256_mul_ps(sx, cz)), scaleZ);
+			__m256 m20 = _mm256_mul_ps(_mm256_sub_ps(_mm256_setzero_ps(), sy), scaleX);
+			__m256 m21 = _mm256_mul_ps(_mm256_mul_ps(sx, cy), scaleY);
+			__m256 m22 = _mm256_mul_ps(_mm256_mul_ps(cx, cy), scaleZ);
+
+			StoreRows8(m00, m01, m02, _mm256_loadu_ps(in.position[0] + i), 0, pOut + i);
+			StoreRows8(m10, m11, m12, _mm256_loadu_ps(in.position[1] + i), 1, pOut + i);
+			StoreRows8(m20, m21, m22, _mm256_loadu_ps(in.position[2] + i), 2, pOut + i);
+		}
+
+		ComposeScalar(in, i, end - i, pOut);
+	}
+#elif defined(TRANSFORM_STORE_SSE2)
+	/***********************************************************
+	 *  SinCos4()
+	 *
+	 *  This function is used for getting the sines and cosines
+	 *  of four angles in degrees.
+	 ***********************************************************/
+	void SinCos4(__m128 degrees, __m128& sine, __m128& cosine)
+	{
+		__m128 x = _mm_mul_ps(degrees, _mm_set1_ps(DEGREES_TO_RADIANS));
+		__m128i quarter = _mm_cvtps_epi32(_mm_mul_ps(x, _mm_set1_ps(TWO_OVER_PI)));
+		__m128 q = _mm_cvtepi32_ps(quarter);
+		__m128 r = _mm_sub_ps(x, _mm_mul_ps(q, _mm_set1_ps(HALF_PI_1)));
+		r = _mm_sub_ps(r, _mm_mul_ps(q, _mm_set1_ps(HALF_PI_2)));
+		r = _mm_sub_ps(r, _mm_mul_ps(q, _mm_set1_ps(HALF_PI_3)));
+		__m128 r2 = _mm_mul_ps(r, r);
+
+		__m128 s = _mm_add_ps(_mm_set1_ps(SIN_2), _mm_mul_ps(r2, _mm_set1_ps(SIN_3)));
+		s = _mm_add_ps(_mm_set1_ps(SIN_1), _mm_mul_ps(r2, s));
+		s = _mm_add_ps(r, _mm_mul_ps(_mm_mul_ps(r, r2), s));
+
+		__m128 c = _mm_add_ps(_mm_set1_ps(COS_2), _mm_mul_ps(r2, _mm_set1_ps(COS_3)));
+		c = _mm_add_ps(_mm_set1_ps(COS_1), _mm_mul_ps(r2, c));
+		c = _mm_add_ps(_mm_mul_ps(_mm_mul_ps(r2, r2), c),
+			_mm_sub_ps(_mm_set1_ps(1.0f), _mm_mul_ps(_mm_set1_ps(0.5f), r2)));
+
+		__m128i one = _mm_set1_epi32(1);
+		__m128i two = _mm_set1_epi32(2);
+		__m128 swap = _mm_castsi128_ps(_mm_cmpeq_epi32(_mm_and_si128(quarter, one), one));
+		__m128 sineSign = _mm_castsi128_ps(_mm_slli_epi32(_mm_and_si128(quarter, two), 30));
+		__m128 cosineSign = _mm_castsi128_ps(
+			_mm_slli_epi32(_mm_and_si128(_mm_add_epi32(quarter, one), two), 30));
+
+		// SSE2 has no blend, so the lanes are picked with masks
+		sine = _mm_xor_ps(_mm_or_ps(_mm_and_ps(swap, c), _mm_andnot_ps(swap, s)), sineSign);
+		cosine = _mm_xor_ps(_mm_or_ps(_mm_and_ps(swap, s), _mm_andnot_ps(swap, c)), cosineSign);
+	}
+
+	/***********************************************************
+	 *  ComposeSIMD()
+	 *
+	 *  This function is used for composing the matrices of a
+	 *  range of objects four at a time, and the remainder with
+	 *  the scalar kernel.
+	 ***********************************************************/
+	void ComposeSIMD(const SOA_INPUT& in, size_t first, size_t count, TransformStore::AFFINE_3X4* pOut)
+	{
+		size_t end = first + count;
+		size_t i = first;
+		for (; i + 4 <= end; i += 4)
+		{
+			__m128 sx, cx, sy, cy, sz, cz;
+			SinCos4(_mm_loadu_ps(in.rotation[0] + i), sx, cx);
+			SinCos4(_mm_loadu_ps(in.rotation[1] + i), sy, cy);
+			SinCos4(_mm_loadu_ps(in.rotation[2] + i), sz, cz);
+
+			__m128 scaleX = _mm_loadu_ps(in.scale[0] + i);
+			__m128 scaleY = _mm_loadu_ps(in.scale[1] + i);
+			__m128 scaleZ = _mm_loadu_ps(in.scale[2] + i);
+			__m128 sxsy = _mm_mul_ps(sx, sy);
+			__m128 cxsy = _mm_mul_ps(cx, sy);
+
+			__m128 row0[4] =
+			{
+				_mm_mul_ps(_mm_mul_ps(cy, cz), scaleX),
+				_mm_mul_ps(_mm_sub_ps(_mm_mul_ps(sxsy, cz), _mm_mul_ps(cx, sz)), scaleY),
+				_mm_mul_ps(_mm_add_ps(_mm_mul_ps(cxsy, cz), _mm_mul_ps(sx, sz)), scaleZ),
+				_mm_loadu_ps(in.position[0] + i)
+			};
+			__m128 row1[4] =
+			{
+				_mm_mul_ps(_mm_mul_ps(cy, sz), scaleX),
+				_mm_mul_ps(_mm_add_ps(_mm_mul_ps(sxsy, sz), _mm_mul_ps(cx, cz)), scaleY),
+				_mm_mul_ps(_mm_sub_ps(_mm_mul_ps(cxsy, sz), _mm_mul_ps(sx, cz)), scaleZ),
+				_mm_loadu_ps(in.position[1] + i)
+			};
+			__m128 row2[4] =
+			{
+				_mm_mul_ps(_mm_sub_ps(_mm_setzero_ps(), sy), scaleX),
+				_mm_mul_ps(_mm_mul_ps(sx, cy), scaleY),
+				_mm_mul_ps(_mm_mul_ps(cx, cy), scaleZ),
+				_mm_loadu_ps(in.position[2] + i)
+			};
+
+			// after the transpose register j holds the row of matrix j
+			_MM_TRANSPOSE4_PS(row0[0], row0[1], row0[2], row0[3]);
+			_MM_TRANSPOSE4_PS(row1[0], row1[1], row1[2], row1[3]);
+			_MM_TRANSPOSE4_PS(row2[0], row2[1], row2[2], row2[3]);
+			for (int j = 0; j < 4; j++)
+			{
+				_mm_storeu_ps(pOut[i + j].m, row0[j]);
+				_mm_storeu_ps(pOut[i + j].m + 4, row1[j]);
+				_mm_storeu_ps(pOut[i + j].m + 8, row2[j]);
+			}
+		}
+
+		ComposeScalar(in, i, end - i, pOut);
+	}
+#endif
+
+	/***********************************************************
+	 *  ComposeBest()
+	 *
+	 *  This function is used for composing a range of objects
+	 *  with the fastest kernel of the build.
+	 ***********************************************************/
+	void ComposeBest(const SOA_INPUT& in, size_t first, size_t count, TransformStore::AFFINE_3X4* pOut)
+	{
+#if defined(TRANSFORM_STORE_AVX2) || defined(TRANSFORM_STORE_SSE2)
+		ComposeSIMD(in, first, count, pOut);
+#else
+		ComposeScalar(in, first, count, pOut);
+#endif
+	}
+}
+
+/***********************************************************
+ *  TransformStore()
+ *
+ *  The constructor for the class
+ ***********************************************************/
+TransformStore::TransformStore()
+{
+	m_lastComposed = 0;
+}
+
+/***********************************************************
+ *  Resize()
+ *
+ *  This method is used for replacing the store with identity
+ *  transforms that are all waiting to be composed.
+ ***********************************************************/
+void TransformStore::Resize(size_t count)
+{
+	m_scaleX.assign(count, 1.0f);
+	m_scaleY.assign(count, 1.0f);
+	m_scaleZ.assign(count, 1.0f);
+	m_rotationX.assign(count, 0.0f);
+	m_rotationY.assign(count, 0.0f);
+	m_rotationZ.assign(count, 0.0f);
+	m_positionX.assign(count, 0.0f);
+	m_positionY.assign(count, 0.0f);
+	m_positionZ.assign(count, 0.0f);
+	m_affine.resize(count);
+	m_parents.assign(count, -1);
+	m_parentAffine.clear();
+	m_parentFirstChild.clear();
+	m_parentChildCount.clear();
+
+	m_dirty.assign(count, 1);
+	m_dirtyObjects.resize(count);
+	for (size_t i = 0; i < count; i++)
+	{
+		m_dirtyObjects[i] = (uint32_t)i;
+	}
+}
+
+/***********************************************************
+ *  ResizeParents()
+ *
+ *  This method is used for replacing the parents with
+ *  identity parents that have no children.  Objects keep
+ *  their parent index, so the children are attached again
+ *  afterwards.
+ ***********************************************************/
+void TransformStore::ResizeParents(size_t count)
+{
+	AFFINE_3X4 identity =
+	{
+		{ 1.0f, 0.0f, 0.0f, 0.0f,
+		  0.0f, 1.0f, 0.0f, 0.0f,
+		  0.0f, 0.0f, 1.0f, 0.0f }
+	};
+
+	m_parentAffine.assign(count, identity);
+	m_parentFirstChild.assign(count, 0);
+	m_parentChildCount.assign(count, 0);
+}
+
+/***********************************************************
+ *  AttachChildren()
+ *
+ *  This method is used for making a range of objects the
+ *  children of a parent and queueing them to be composed.
+ ***********************************************************/
+void TransformStore::AttachChildren(uint32_t parent, uint32_t firstObject, uint32_t objectCount)
+{
+	m_parentFirstChild[parent] = firstObject;
+	m_parentChildCount[parent] = objectCount;
+
+	for (uint32_t i = firstObject; i < firstObject + objectCount; i++)
+	{
+		m_parents[i] = (int32_t)parent;
+		if (m_dirty[i] == 0)
+		{
+			m_dirty[i] = 1;
+			m_dirtyObjects.push_back(i);
+		}
+	}
+}
+
+/***********************************************************
+ *  SetParentTransform()
+ *
+ *  This method is used for composing the matrix of a parent
+ *  straight away and queueing its children, which are
+ *  composed again with the next batch.
+ ***********************************************************/
+void TransformStore::SetParentTransform(uint32_t parent, const glm::vec3& scale, const glm::vec3& rotation, const glm::vec3& position)
+{
+	float values[9] =
+	{
+		scale.x, scale.y, scale.z,
+		rotation.x, rotation.y, rotation.z,
+		position.x, position.y, position.z
+	};
+	SOA_INPUT in =
+	{
+		{ &values[0], &values[1], &values[2] },
+		{ &values[3], &values[4], &values[5] },
+		{ &values[6], &values[7], &values[8] }
+	};
+	ComposeScalar(in, 0, 1, &m_parentAffine[parent]);
+
+	uint32_t first = m_parentFirstChild[parent];
+	for (uint32_t i = first; i < first + m_parentChildCount[parent]; i++)
+	{
+		if (m_dirty[i] == 0)
+		{
+			m_dirty[i] = 1;
+			m_dirtyObjects.push_back(i);
+		}
+	}
+}
+
+/***********************************************************
+ *  SetChildrenComposed()
+ *
+ *  This method is used for setting the matrices of every
+ *  child of a parent to the parent's matrix times the passed
+ *  in local matrices.  It is what makes placing a prefab
+ *  cheap - the local matrices are shared by every instance,
+ *  and the children are skipped when the queue is composed.
+ ***********************************************************/
+void TransformStore::SetChildrenComposed(uint32_t parent, const AFFINE_3X4* pLocals)
+{
+	uint32_t first = m_parentFirstChild[parent];
+	for (uint32_t i = 0; i < m_parentChildCount[parent]; i++)
+	{
+		Multiply(m_parentAffine[parent], pLocals[i], m_affine[first + i]);
+		m_dirty[first + i] = 0;
+	}
+}
+
+/***********************************************************
+ *  Set()
+ *
+ *  This method is used for changing the transform of one
+ *  object and queueing it to be composed.
+ ***********************************************************/
+void TransformStore::Set(uint32_t index, const glm::vec3& scale, const glm::vec3& rotation, const glm::vec3& position)
+{
+	m_scaleX[index] = scale.x;
+	m_scaleY[index] = scale.y;
+	m_scaleZ[index] = scale.z;
+	m_rotationX[index] = rotation.x;
+	m_rotationY[index] = rotation.y;
+	m_rotationZ[index] = rotation.z;
+	m_positionX[index] = position.x;
+	m_positionY[index] = position.y;
+	m_positionZ[index] = position.z;
+
+	if (m_dirty[index] == 0)
+	{
+		m_dirty[index] = 1;
+		m_dirtyObjects.push_back(index);
+	}
+}
+
+/***********************************************************
+ *  SetComposed()
+ *
+ *  This method is used for changing the transform of one
+ *  object along with its matrix.  The object stays in the
+ *  queue if it was there, and is skipped when the queue is
+ *  composed.
+ ***********************************************************/
+void TransformStore::SetComposed(uint32_t index, const glm::vec3& scale, const glm::vec3& rotation, const glm::vec3& position,
+	const AFFINE_3X4& affine)
+{
+	m_scaleX[index] = scale.x;
+	m_scaleY[index] = scale.y;
+	m_scaleZ[index] = scale.z;
+	m_rotationX[index] = rotation.x;
+	m_rotationY[index] = rotation.y;
+	m_rotationZ[index] = rotation.z;
+	m_positionX[index] = position.x;
+	m_positionY[index] = position.y;
+	m_positionZ[index] = position.z;
+
+	m_affine[index] = affine;
+	m_dirty[index] = 0;
+}
+
+/***********************************************************
+ *  ComposeDirty()
+ *
+ *  This method is used for composing the matrices of the
+ *  queued objects.  When most objects are queued the whole
+ *  arrays are composed in place; otherwise the queued objects
+ *  are copied together in small groups so the batch kernel
+ *  still gets contiguous input.
+ ***********************************************************/
+void TransformStore::ComposeDirty()
+{
+	// drop the queued objects that were given a composed matrix
+	size_t queued = 0;
+	for (size_t i = 0; i < m_dirtyObjects.size(); i++)
+	{
+		if (m_dirty[m_dirtyObjects[i]] != 0)
+		{
+			m_dirtyObjects[queued++] = m_dirtyObjects[i];
+		}
+	}
+	m_dirtyObjects.resize(queued);
+
+	m_lastComposed = (uint32_t)m_dirtyObjects.size();
+	if (m_dirtyObjects.empty())
+	{
+		return;
+	}
+
+	if (m_dirtyObjects.size() * 2 >= m_affine.size())
+	{
+		ComposeAll(false);
+		return;
+	}
+
+	float gathered[9][GATHER_SIZE];
+	AFFINE_3X4 composed[GATHER_SIZE];
+	SOA_INPUT in =
+	{
+		{ gathered[0], gathered[1], gathered[2] },
+		{ gathered[3], gathered[4], gathered[5] },
+		{ gathered[6], gathered[7], gathered[8] }
+	};
+
+	for (size_t first = 0; first < m_dirtyObjects.size(); first += GATHER_SIZE)
+	{
+		size_t count = m_dirtyObjects.size() - first;
+		count = (count < (size_t)GATHER_SIZE) ? count : (size_t)GATHER_SIZE;
+
+		for (size_t j = 0; j < count; j++)
+		{
+			uint32_t object = m_dirtyObjects[first + j];
+			gathered[0][j] = m_scaleX[object];
+			gathered[1][j] = m_scaleY[object];
+			gathered[2][j] = m_scaleZ[object];
+			gathered[3][j] = m_rotationX[object];
+			gathered[4][j] = m_rotationY[object];
+			gathered[5][j] = m_rotationZ[object];
+			gathered[6][j] = m_positionX[object];
+			gathered[7][j] = m_positionY[object];
+			gathered[8][j] = m_positionZ[object];
+		}
+
+		ComposeBest(in, 0, count, composed);
+
+		for (size_t j = 0; j < count; j++)
+		{
+			uint32_t object = m_dirtyObjects[first + j];
+			if (m_parents[object] >= 0)
+			{
+				Multiply(m_parentAffine[m_parents[object]], composed[j], m_affine[object]);
+			}
+			else
+			{
+				m_affine[object] = composed[j];
+			}
+			m_dirty[object] = 0;
+		}
+	}
+
+	m_dirtyObjects.clear();
+}
+
+/***********************************************************
+ *  ComposeAll()
+ *
+ *  This method is used for composing the matrix of every
+ *  object straight from the arrays.
+ ***********************************************************/
+void TransformStore::ComposeAll(bool bForceScalar)
+{
+	SOA_INPUT in =
+	{
+		{ m_scaleX.data(), m_scaleY.data(), m_scaleZ.data() },
+		{ m_rotationX.data(), m_rotationY.data(), m_rotationZ.data() },
+		{ m_positionX.data(), m_positionY.data(), m_positionZ.data() }
+	};
+
+	if (bForceScalar)
+	{
+		ComposeScalar(in, 0, m_affine.size(), m_affine.data());
+	}
+	else
+	{
+		ComposeBest(in, 0, m_affine.size(), m_affine.data());
+	}
+
+	// the kernels compose the children's local matrices, which
+	// are then moved under their parents
+	for (size_t parent = 0; parent < m_parentAffine.size(); parent++)
+	{
+		uint32_t first = m_parentFirstChild[parent];
+		for (uint32_t i = first; i < first + m_parentChildCount[parent]; i++)
+		{
+			Multiply(m_parentAffine[parent], m_affine[i], m_affine[i]);
+		}
+	}
+
+	m_dirty.assign(m_dirty.size(), 0);
+	m_dirtyObjects.clear();
+	m_lastComposed = (uint32_t)m_affine.size();
+}
+
+/***********************************************************
+ *  ToMat4()
+ *
+ *  This method is used for expanding an affine matrix into
+ *  a column-major 4x4 matrix.
+ ***********************************************************/
+glm::mat4 TransformStore::ToMat4(const AFFINE_3X4& affine)
+{
+	const float* m = affine.m;
+	return(glm::mat4(
+		m[0], m[4], m[8], 0.0f,
+		m[1], m[5], m[9], 0.0f,
+		m[2], m[6], m[10], 0.0f,
+		m[3], m[7], m[11], 1.0f));
+}
+
+/***********************************************************
+ *  Multiply()
+ *
+ *  This method is used for multiplying two affine matrices.
+ *  The result may be the same matrix as either input.
+ ***********************************************************/
+void TransformStore::Multiply(const AFFINE_3X4& parent, const AFFINE_3X4& local, AFFINE_3X4& result)
+{
+	const float* a = parent.m;
+	const float* b = local.m;
+	float m[12];
+
+	for (int row = 0; row < 3; row++)
+	{
+		const float* r = a + row * 4;
+		m[row * 4 + 0] = r[0] * b[0] + r[1] * b[4] + r[2] * b[8];
+		m[row * 4 + 1] = r[0] * b[1] + r[1] * b[5] + r[2] * b[9];
+		m[row * 4 + 2] = r[0] * b[2] + r[1] * b[6] + r[2] * b[10];
+		m[row * 4 + 3] = r[0] * b[3] + r[1] * b[7] + r[2] * b[11] + r[3];
+	}
+
+	for (int i = 0; i < 12; i++)
+	{
+		result.m[i] = m[i];
+	}
+}
+
+/***********************************************************
+ *  ComposeArrays()
+ *
+ *  This method is used for composing matrices from arrays
+ *  that are kept outside of a store, such as the transform
+ *  columns of a scene world chunk.
+ ***********************************************************/
+void TransformStore::ComposeArrays(const float* const* ppInputs, size_t count, AFFINE_3X4* pOut)
+{
+	SOA_INPUT in =
+	{
+		{ ppInputs[0], ppInputs[1], ppInputs[2] },
+		{ ppInputs[3], ppInputs[4], ppInputs[5] },
+		{ ppInputs[6], ppInputs[7], ppInputs[8] }
+	};
+	ComposeBest(in, 0, count, pOut);
+}
+
+/***********************************************************
+ *  ComputeBounds()
+ *
+ *  This method is used for getting the world space box
+ *  around an object.  Every basic mesh fits inside the
+ *  [-1, 1] cube, so the box is that cube transformed by the
+ *  model matrix, which may be a little larger than the
+ *  mesh itself.
+ ***********************************************************/
+TransformStore::BOUNDS TransformStore::ComputeBounds(const AFFINE_3X4& model)
+{
+	BOUNDS bounds;
+	for (int row = 0; row < 3; row++)
+	{
+		const float* m = model.m + row * 4;
+		float extent = std::fabs(m[0]) + std::fabs(m[1]) + std::fabs(m[2]);
+		bounds.min[row] = m[3] - extent;
+		bounds.max[row] = m[3] + extent;
+	}
+	return(bounds);
+}
+
+/***********************************************************
+ *  GetKernelName()
+ *
+ *  This method is used for getting the name of the batch
+ *  kernel that was compiled in.
+ ***********************************************************/
+const char* TransformStore::GetKernelName()
+{
+#if defined(TRANSFORM_STORE_AVX2)
+	return("avx2");
+#elif defined(TRANSFORM_STORE_SSE2)
+	return("sse2");
+#else
+	return("scalar");
+#endif
+}
+
+/***********************************************************
+ *  GetMemoryBytes()
+ *
+ *  This method is used for adding up the bytes reserved by
+ *  the arrays.
+ ***********************************************************/
+uint64_t TransformStore::GetMemoryBytes() const
+{
+	return((m_scaleX.capacity() + m_scaleY.capacity() + m_scaleZ.capacity() +
+		m_rotationX.capacity() + m_rotationY.capacity() + m_rotationZ.capacity() +
+		m_positionX.capacity() + m_positionY.capacity() + m_positionZ.capacity()) * sizeof(float) +
+		(m_affine.capacity() + m_parentAffine.capacity()) * sizeof(AFFINE_3X4) +
+		m_parents.capacity() * sizeof(int32_t) +
+		(m_parentFirstChild.capacity() + m_parentChildCount.capacity()) * sizeof(uint32_t) +
+		m_dirty.capacity() * sizeof(uint8_t) +
+		m_dirtyObjects.capacity() * sizeof(uint32_t));
+}
@@ -0,0 +1,134 @@
+///////////////////////////////////////////////////////////////////////////////
+// transformstore.h
+// ============
+// structure-of-arrays object transforms composed into affine matrices in batches
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <glm/glm.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/***********************************************************
+ *  TransformStore
+ *
+ *  This class keeps the scale, Euler rotation and position
+ *  of every object in separate float arrays, and composes
+ *  the model matrices of the objects whose transform has
+ *  changed in one batch.  The batch kernel computes eight
+ *  objects at a time with AVX2 or four with SSE2, whichever
+ *  the build targets, and falls back to plain C++ otherwise.
+ *  It builds the matrix terms directly from the sines and
+ *  cosines of the angles and writes the upper 3x4 of each
+ *  matrix, the same matrix as T * Rz * Ry * Rx * S.
+ *  Objects can be children of a parent, such as the parts of
+ *  a prefab instance, and their matrices are then the
+ *  parent's matrix times their own.
+ ***********************************************************/
+class TransformStore
+{
+public:
+	// upper three rows of a model matrix, row after row - the
+	// fourth row is always 0 0 0 1
+	struct AFFINE_3X4
+	{
+		float m[12];
+	};
+
+	// world space box around an object
+	struct BOUNDS
+	{
+		float min[3];
+		float max[3];
+	};
+
+	// constructor
+	TransformStore();
+
+	// replace the store with the passed in number of identity
+	// transforms without parents, all marked dirty
+	void Resize(size_t count);
+	size_t GetCount() const { return(m_affine.size()); }
+
+	// set the transform of one object and mark it dirty - the
+	// rotation is the X, Y and Z angle in degrees
+	void Set(uint32_t index, const glm::vec3& scale, const glm::vec3& rotation, const glm::vec3& position);
+	// set the transform of one object together with its already
+	// composed matrix, such as one baked at build time - the
+	// object is no longer dirty
+	void SetComposed(uint32_t index, const glm::vec3& scale, const glm::vec3& rotation, const glm::vec3& position,
+		const AFFINE_3X4& affine);
+
+	// replace the parents with the passed in number of identity
+	// parents without children
+	void ResizeParents(size_t count);
+	size_t GetParentCount() const { return(m_parentAffine.size()); }
+	// make a range of objects children of a parent - their
+	// transforms are then relative to it, and their matrices are
+	// the parent's matrix times their own
+	void AttachChildren(uint32_t parent, uint32_t firstObject, uint32_t objectCount);
+	// set the transform of a parent, composing its matrix now and
+	// marking its children dirty
+	void SetParentTransform(uint32_t parent, const glm::vec3& scale, const glm::vec3& rotation, const glm::vec3& position);
+	// set the matrices of a parent's children from already
+	// composed local matrices, one per child, without composing
+	// their transforms - the children are no longer dirty
+	void SetChildrenComposed(uint32_t parent, const AFFINE_3X4* pLocals);
+	const AFFINE_3X4& GetParentAffine(uint32_t parent) const { return(m_parentAffine[parent]); }
+
+	// compose the matrices of the dirty objects
+	void ComposeDirty();
+	// compose the matrices of every object, optionally with the
+	// plain C++ kernel even when a SIMD kernel is built in
+	void ComposeAll(bool bForceScalar);
+	// number of matrices composed by the last call
+	uint32_t GetLastComposed() const { return(m_lastComposed); }
+
+	const AFFINE_3X4& GetAffine(uint32_t index) const { return(m_affine[index]); }
+	// every object's matrix, GetCount() long
+	const AFFINE_3X4* GetAffines() const { return(m_affine.data()); }
+	// expand an affine matrix to the 4x4 the shaders take
+	static glm::mat4 ToMat4(const AFFINE_3X4& affine);
+	// multiply two affine matrices, parent * local
+	static void Multiply(const AFFINE_3X4& parent, const AFFINE_3X4& local, AFFINE_3X4& result);
+	// compose the matrices of count objects with the batch
+	// kernel, from nine arrays holding the X, Y and Z scale,
+	// rotation and position in that order
+	static void ComposeArrays(const float* const* ppInputs, size_t count, AFFINE_3X4* pOut);
+	// get the world space box around a basic mesh placed with
+	// the passed in model matrix
+	static BOUNDS ComputeBounds(const AFFINE_3X4& model);
+
+	// name of the batch kernel the build uses
+	static const char* GetKernelName();
+	// bytes held by the arrays
+	uint64_t GetMemoryBytes() const;
+
+private:
+	std::vector<float> m_scaleX;
+	std::vector<float> m_scaleY;
+	std::vector<float> m_scaleZ;
+	std::vector<float> m_rotationX;
+	std::vector<float> m_rotationY;
+	std::vector<float> m_rotationZ;
+	std::vector<float> m_positionX;
+	std::vector<float> m_positionY;
+	std::vector<float> m_positionZ;
+	std::vector<AFFINE_3X4> m_affine;
+
+	// parent of every object, -1 for none, and the matrix and
+	// child range of every parent
+	std::vector<int32_t> m_parents;
+	std::vector<AFFINE_3X4> m_parentAffine;
+	std::vector<uint32_t> m_parentFirstChild;
+	std::vector<uint32_t> m_parentChildCount;
+
+	// set for the objects whose matrix is out of date, and the
+	// list of those objects
+	std::vector<uint8_t> m_dirty;
+	std::vector<uint32_t> m_dirtyObjects;
+	uint32_t m_lastComposed;
+};
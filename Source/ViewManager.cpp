@@ -8,12 +8,17 @@
 ///////////////////////////////////////////////////////////////////////////////
 
 #include "ViewManager.h"
+#include "FrameProfiler.h"
+#include "StartupTimer.h"
+#include "Logger.h"
 
 // GLM Math Header inclusions
 #include <glm/glm.hpp>
 #include <glm/gtx/transform.hpp>
 #include <glm/gtc/type_ptr.hpp>    
 
+#include <chrono>
+
 // declaration of the global variables and defines
 namespace
 {
@@ -22,6 +27,7 @@ namespace
 	const int WINDOW_HEIGHT = 800;
 	const char* g_ViewName = "view";
 	const char* g_ProjectionName = "projection";
+	const char* g_DebugModeName = "debugMode";
 
 	// camera object used for viewing and interacting with
 	// the 3D scene
@@ -35,10 +41,20 @@ namespace
 	// time between current frame and last frame
 	float gDeltaTime = 0.0f;
 	float gLastFrame = 0.0f;
+	// start of the frame clock used without a window, when GLFW
+	// may not be initialized
+	std::chrono::steady_clock::time_point gClockStart = std::chrono::steady_clock::now();
 
 	// if orthographic projection is on, this value will be
 	// true
 	bool bOrthographicProjection = false;
+
+	// state of the profiler dump key during the last frame
+	bool gDumpKeyWasPressed = false;
+
+	// when the camera follows a scripted path, the mouse and the
+	// movement keys are ignored
+	bool gScriptedCamera = false;
 }
 
 /***********************************************************
@@ -52,6 +68,15 @@ ViewManager::ViewManager(
 	// initialize the member variables
 	m_pShaderManager = pShaderManager;
 	m_pWindow = NULL;
+	m_pRecorder = NULL;
+	m_pCameraPath = NULL;
+	m_pathTime = 0.0f;
+	m_pathTimeStep = 0.0f;
+	m_debugView = VIEW_SHADED;
+	m_appliedDebugView = -1;
+	m_pFramePacing = NULL;
+	m_viewProjection = glm::mat4(1.0f);
+	m_cameraPosition = glm::vec3(0.0f, 0.0f, 0.0f);
 	g_pCamera = new Camera();
 	// default camera view parameters
 	g_pCamera->Position = glm::vec3(10.0f, 20.0f, 100.0f);
@@ -71,6 +96,8 @@ ViewManager::~ViewManager()
 	// free up allocated memory
 	m_pShaderManager = NULL;
 	m_pWindow = NULL;
+	m_pCameraPath = NULL;
+	gScriptedCamera = false;
 	if (NULL != g_pCamera)
 	{
 		delete g_pCamera;
@@ -85,6 +112,8 @@ ViewManager::~ViewManager()
  ***********************************************************/
 GLFWwindow* ViewManager::CreateDisplayWindow(const char* windowTitle)
 {
+	STARTUP_PHASE("CreateDisplayWindow");
+
 	GLFWwindow* window = nullptr;
 
 	// try to create the displayed OpenGL window
@@ -95,7 +124,7 @@ GLFWwindow* ViewManager::CreateDisplayWindow(const char* windowTitle)
 		NULL, NULL);
 	if (window == NULL)
 	{
-		std::cout << "Failed to create GLFW window" << std::endl;
+		LOG_ERROR("Failed to create GLFW window");
 		glfwTerminate();
 		return NULL;
 	}
@@ -127,6 +156,12 @@ GLFWwindow* ViewManager::CreateDisplayWindow(const char* windowTitle)
  ***********************************************************/
 void ViewManager::Mouse_Position_Callback(GLFWwindow* window, double xMousePos, double yMousePos)
 {
+	// the scripted camera path owns the camera
+	if (gScriptedCamera)
+	{
+		return;
+	}
+
 	// When the first mouse move event is received, this needs to be recorded so that
 	// all subsequent mouse moves can correctly calculate the X position offset and Y
 	// position offset for proper operation
@@ -157,6 +192,12 @@ void ViewManager::Mouse_Position_Callback(GLFWwindow* window, double xMousePos,
  ***********************************************************/
 void ViewManager::ProcessKeyboardEvents()
 {
+	// there is no window to read keys from when rendering offscreen
+	if (NULL == m_pWindow)
+	{
+		return;
+	}
+
 	// Close the window if the escape key has been pressed
 	if (glfwGetKey(m_pWindow, GLFW_KEY_ESCAPE) == GLFW_PRESS)
 	{
@@ -171,8 +212,31 @@ void ViewManager::ProcessKeyboardEvents()
 		bOrthographicProjection = true;
 	}
 
-	// If the camera object is null, then exit this method
-	if (NULL == g_pCamera)
+	// switch between the shaded output and the debug views
+	if (glfwGetKey(m_pWindow, GLFW_KEY_F1) == GLFW_PRESS)
+	{
+		m_debugView = VIEW_SHADED;
+	}
+	else if (glfwGetKey(m_pWindow, GLFW_KEY_F2) == GLFW_PRESS)
+	{
+		m_debugView = VIEW_OVERDRAW;
+	}
+	else if (glfwGetKey(m_pWindow, GLFW_KEY_F3) == GLFW_PRESS)
+	{
+		m_debugView = VIEW_SHADER_COST;
+	}
+
+	// ask for the profiler trace once each time F12 goes down
+	bool bDumpKeyPressed = (glfwGetKey(m_pWindow, GLFW_KEY_F12) == GLFW_PRESS);
+	if (bDumpKeyPressed && !gDumpKeyWasPressed)
+	{
+		FrameProfiler::Instance().RequestDump();
+	}
+	gDumpKeyWasPressed = bDumpKeyPressed;
+
+	// If the camera object is null or follows a scripted path,
+	// then exit this method
+	if ((NULL == g_pCamera) || gScriptedCamera)
 	{
 		return;
 	}
@@ -211,10 +275,32 @@ void ViewManager::ProcessKeyboardEvents()
 // Callback function for mouse scroll events
 void ViewManager::Mouse_Scroll_Callback(GLFWwindow* window, double xoffset, double yoffset)
 {
+	// the scripted camera path owns the zoom level
+	if (gScriptedCamera)
+	{
+		return;
+	}
+
 	// Update the camera's zoom level based on the mouse scroll offset
 	g_pCamera->ProcessMouseScroll(-yoffset);
 }
 
+/***********************************************************
+ *  SetCameraPath()
+ *
+ *  This method is used for playing back a scripted camera
+ *  path from its start.  Every frame moves the path forward
+ *  by the fixed time step, so the same frame always sees the
+ *  same camera no matter how long the frames take.
+ ***********************************************************/
+void ViewManager::SetCameraPath(const CameraPath* pPath, float timeStep)
+{
+	m_pCameraPath = pPath;
+	m_pathTime = 0.0f;
+	m_pathTimeStep = timeStep;
+	gScriptedCamera = (NULL != pPath);
+}
+
 /***********************************************************
  *  PrepareSceneView()
  *
@@ -227,11 +313,41 @@ void ViewManager::PrepareSceneView()
 	glm::mat4 view;
 	glm::mat4 projection;
 
-	// per-frame timing
-	float currentFrame = glfwGetTime();
-	gDeltaTime = currentFrame - gLastFrame;
+	// per-frame timing - the offscreen paths may run without
+	// GLFW, so they take the time from the standard clock
+	float currentFrame = 0.0f;
+	if (NULL != m_pWindow)
+	{
+		currentFrame = (float)glfwGetTime();
+	}
+	else
+	{
+		currentFrame = std::chrono::duration<float>(std::chrono::steady_clock::now() - gClockStart).count();
+	}
+	float frameTime = currentFrame - gLastFrame;
+	bool bFirstFrame = (gLastFrame == 0.0f);
+	gDeltaTime = frameTime;
 	gLastFrame = currentFrame;
 
+	// the first delta is measured from the library start, so it
+	// is not a frame time
+	if ((NULL != m_pFramePacing) && !bFirstFrame)
+	{
+		m_pFramePacing->RecordFrame(frameTime);
+	}
+
+	if (NULL != m_pCameraPath)
+	{
+		// simulated per-frame timing along the scripted path
+		gDeltaTime = m_pathTimeStep;
+
+		CameraPath::KEYFRAME key = m_pCameraPath->Sample(m_pathTime);
+		g_pCamera->Position = key.position;
+		g_pCamera->Front = key.front;
+		g_pCamera->Zoom = key.zoom;
+		m_pathTime += m_pathTimeStep;
+	}
+
 	// process any keyboard events that may be waiting in the 
 	// event queue
 	ProcessKeyboardEvents();
@@ -262,6 +378,11 @@ void ViewManager::PrepareSceneView()
 		);
 	}
 
+	// the scene culls its objects against this view, and streams
+	// its cells in around the camera
+	m_viewProjection = projection * view;
+	m_cameraPosition = g_pCamera->Position;
+
 	// if the shader manager object is valid
 	if (NULL != m_pShaderManager)
 	{
@@ -272,4 +393,45 @@ void ViewManager::PrepareSceneView()
 		// set the view position of the camera into the shader for proper rendering
 		m_pShaderManager->setVec3Value("viewPosition", g_pCamera->Position);
 	}
+
+	ApplyDebugView();
+
+	// the view uniforms are part of the recorded draw stream
+	if (NULL != m_pRecorder)
+	{
+		m_pRecorder->RecordMat4(g_ViewName, view);
+		m_pRecorder->RecordMat4(g_ProjectionName, projection);
+		m_pRecorder->RecordVec3("viewPosition", g_pCamera->Position);
+	}
+}
+
+/***********************************************************
+ *  ApplyDebugView()
+ *
+ *  This method is used for passing the debug view into the
+ *  shader.  The overdraw view adds up every written fragment,
+ *  so it swaps the alpha blending for additive blending, and
+ *  the blend state is only touched when the view changes.
+ ***********************************************************/
+void ViewManager::ApplyDebugView()
+{
+	if (NULL != m_pShaderManager)
+	{
+		m_pShaderManager->setIntValue(g_DebugModeName, m_debugView);
+	}
+
+	if (m_appliedDebugView == m_debugView)
+	{
+		return;
+	}
+
+	if (m_debugView == VIEW_OVERDRAW)
+	{
+		glBlendFunc(GL_ONE, GL_ONE);
+	}
+	else
+	{
+		glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+	}
+	m_appliedDebugView = m_debugView;
 }
\ No newline at end of file
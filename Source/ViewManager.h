@@ -10,6 +10,9 @@
 #pragma once
 
 #include "ShaderManager.h"
+#include "DrawStream.h"
+#include "CameraPath.h"
+#include "FramePacing.h"
 #include "camera.h"
 
 // GLFW library
@@ -18,6 +21,14 @@
 class ViewManager
 {
 public:
+	// render modes that replace the shaded output of the scene
+	enum DEBUG_VIEW
+	{
+		VIEW_SHADED = 0,
+		VIEW_OVERDRAW,
+		VIEW_SHADER_COST
+	};
+
 	// constructor
 	ViewManager(
 		ShaderManager* pShaderManager);
@@ -34,9 +45,27 @@ private:
 	ShaderManager* m_pShaderManager;
 	// active OpenGL display window
 	GLFWwindow* m_pWindow;
+	// optional recorder of the view uniform writes
+	DrawStreamRecorder* m_pRecorder;
+	// optional scripted camera path and its playback clock
+	const CameraPath* m_pCameraPath;
+	float m_pathTime;
+	float m_pathTimeStep;
+	// debug view that is rendered, and the one whose blend state
+	// was last applied
+	DEBUG_VIEW m_debugView;
+	int m_appliedDebugView;
+	// optional receiver of the measured frame times
+	FramePacing* m_pFramePacing;
+	// projection times view of the last prepared frame, and the
+	// camera position it was seen from
+	glm::mat4 m_viewProjection;
+	glm::vec3 m_cameraPosition;
 
 	// process keyboard events for interaction with the 3D scene
 	void ProcessKeyboardEvents();
+	// set the debug view uniform and its blend state
+	void ApplyDebugView();
 
 public:
 	// create the initial OpenGL display window
@@ -44,4 +73,23 @@ public:
 
 	// prepare the conversion from 3D object display to 2D scene display
 	void PrepareSceneView();
+	// view-projection matrix set by the last PrepareSceneView()
+	const glm::mat4& GetViewProjection() const { return(m_viewProjection); }
+	// camera position set by the last PrepareSceneView()
+	const glm::vec3& GetCameraPosition() const { return(m_cameraPosition); }
+
+	// record the view uniform writes into the passed in recorder
+	void SetDrawStreamRecorder(DrawStreamRecorder* pRecorder) { m_pRecorder = pRecorder; }
+
+	// drive the camera from the passed in path, advancing it by a
+	// fixed time step every frame instead of the wall clock and
+	// the keyboard and mouse - NULL returns to interactive control
+	void SetCameraPath(const CameraPath* pPath, float timeStep);
+
+	// switch the debug view - the F1, F2 and F3 keys do the same
+	void SetDebugView(DEBUG_VIEW view) { m_debugView = view; }
+	DEBUG_VIEW GetDebugView() const { return(m_debugView); }
+
+	// pass the measured time between frames to the pacing telemetry
+	void SetFramePacing(FramePacing* pFramePacing) { m_pFramePacing = pFramePacing; }
 };
\ No newline at end of file
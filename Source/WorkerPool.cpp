@@ -0,0 +1,164 @@
+///////////////////////////////////////////////////////////////////////////////
+// workerpool.cpp
+// ============
+// split a range of work items across a fixed set of threads
+///////////////////////////////////////////////////////////////////////////////
+
+#include "WorkerPool.h"
+#include "AllocationCounter.h"
+
+/***********************************************************
+ *  WorkerPool()
+ *
+ *  The constructor for the class
+ ***********************************************************/
+WorkerPool::WorkerPool()
+{
+	m_job = NULL;
+	m_pContext = NULL;
+	m_itemCount = 0;
+	m_jobNumber = 0;
+	m_pendingShares = 0;
+	m_bStopping = false;
+}
+
+/***********************************************************
+ *  ~WorkerPool()
+ *
+ *  The destructor for the class
+ ***********************************************************/
+WorkerPool::~WorkerPool()
+{
+	Stop();
+}
+
+/***********************************************************
+ *  Start()
+ *
+ *  This method is used for starting the pool threads.  The
+ *  thread that runs the jobs does the first share of every
+ *  job, so one thread fewer is started than asked for.
+ ***********************************************************/
+void WorkerPool::Start(int threadCount)
+{
+	Stop();
+
+	m_bStopping = false;
+	for (int i = 1; i < threadCount; i++)
+	{
+		m_threads.push_back(std::thread(&WorkerPool::ThreadMain, this, i, m_jobNumber));
+	}
+}
+
+/***********************************************************
+ *  Stop()
+ *
+ *  This method is used for waking the pool threads to exit
+ *  and waiting for them.
+ ***********************************************************/
+void WorkerPool::Stop()
+{
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_bStopping = true;
+	}
+	m_wake.notify_all();
+
+	for (size_t i = 0; i < m_threads.size(); i++)
+	{
+		m_threads[i].join();
+	}
+	m_threads.clear();
+}
+
+/***********************************************************
+ *  Run()
+ *
+ *  This method is used for posting a job to the pool
+ *  threads, running the first share on the calling thread
+ *  and waiting for the other shares to finish.
+ ***********************************************************/
+void WorkerPool::Run(JOB_FUNCTION job, void* pContext, uint32_t itemCount)
+{
+	if (m_threads.empty())
+	{
+		job(pContext, 0, itemCount);
+		return;
+	}
+
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_job = job;
+		m_pContext = pContext;
+		m_itemCount = itemCount;
+		m_pendingShares = (int)m_threads.size();
+		m_jobNumber++;
+	}
+	m_wake.notify_all();
+
+	RunShare(0);
+
+	std::unique_lock<std::mutex> lock(m_mutex);
+	while (m_pendingShares > 0)
+	{
+		m_done.wait(lock);
+	}
+}
+
+/***********************************************************
+ *  RunShare()
+ *
+ *  This method is used for running the items of the posted
+ *  job that belong to one thread - the items are split into
+ *  as many equal runs as there are threads.
+ ***********************************************************/
+void WorkerPool::RunShare(int threadIndex)
+{
+	uint64_t threadCount = (uint64_t)GetThreadCount();
+	uint32_t first = (uint32_t)(m_itemCount * (uint64_t)threadIndex / threadCount);
+	uint32_t end = (uint32_t)(m_itemCount * (uint64_t)(threadIndex + 1) / threadCount);
+	if (end > first)
+	{
+		m_job(m_pContext, first, end - first);
+	}
+}
+
+/***********************************************************
+ *  ThreadMain()
+ *
+ *  This method is used for waiting for posted jobs and
+ *  running this thread's share of each one until the pool
+ *  is stopped.  The number of the last job posted before
+ *  the thread was started is passed in, so that a job posted
+ *  before the thread first runs is not missed.  The jobs are
+ *  part of the frame, so the allocations of the thread are
+ *  counted along with those of the thread that renders it.
+ ***********************************************************/
+void WorkerPool::ThreadMain(int threadIndex, uint64_t lastJob)
+{
+	AllocationCounter::MarkThread();
+
+	std::unique_lock<std::mutex> lock(m_mutex);
+	for (;;)
+	{
+		while ((m_bStopping == false) && (m_jobNumber == lastJob))
+		{
+			m_wake.wait(lock);
+		}
+		if (m_bStopping == true)
+		{
+			return;
+		}
+		lastJob = m_jobNumber;
+
+		lock.unlock();
+		RunShare(threadIndex);
+		lock.lock();
+
+		m_pendingShares--;
+		if (m_pendingShares == 0)
+		{
+			m_done.notify_one();
+		}
+	}
+}
@@ -0,0 +1,68 @@
+///////////////////////////////////////////////////////////////////////////////
+// workerpool.h
+// ============
+// split a range of work items across a fixed set of threads
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/***********************************************************
+ *  WorkerPool
+ *
+ *  This class keeps a fixed number of threads waiting for
+ *  work.  A job is a plain function that is called once per
+ *  thread with its share of a range of items, and the caller
+ *  runs the first share itself and waits for the others, so
+ *  running a job neither allocates nor starts any thread.
+ *  With one thread the job simply runs on the caller.
+ ***********************************************************/
+class WorkerPool
+{
+public:
+	// a job processes the items from first on, count of them
+	typedef void (*JOB_FUNCTION)(void* pContext, uint32_t first, uint32_t count);
+
+	// constructor
+	WorkerPool();
+	// destructor
+	~WorkerPool();
+
+	// start the passed in number of threads, counting the one
+	// that runs the jobs, after stopping the current ones
+	void Start(int threadCount);
+	// stop every thread but the caller
+	void Stop();
+	int GetThreadCount() const { return((int)m_threads.size() + 1); }
+
+	// run a job over itemCount items and wait until every share
+	// of them is done
+	void Run(JOB_FUNCTION job, void* pContext, uint32_t itemCount);
+
+private:
+	std::vector<std::thread> m_threads;
+	std::mutex m_mutex;
+	// signalled when a job is posted and when a share is done
+	std::condition_variable m_wake;
+	std::condition_variable m_done;
+
+	// the posted job
+	JOB_FUNCTION m_job;
+	void* m_pContext;
+	uint32_t m_itemCount;
+	// counts the posted jobs, so each thread runs each one once
+	uint64_t m_jobNumber;
+	// shares still running on the pool threads
+	int m_pendingShares;
+	bool m_bStopping;
+
+	// run the share of a job that belongs to one thread
+	void RunShare(int threadIndex);
+	// pool thread body
+	void ThreadMain(int threadIndex, uint64_t lastJob);
+};
@@ -61,6 +61,13 @@ uniform Material material;
 uniform sampler2D objectTexture;
 uniform vec2 UVscale = vec2(1.0f, 1.0f);
 
+// debug views - 0 is the normal shaded output, 1 counts the
+// fragments written to each pixel (drawn with additive blending)
+// and 2 shows the number of lights and texture fetches per fragment
+#define DEBUG_VIEW_OVERDRAW 1
+#define DEBUG_VIEW_SHADER_COST 2
+uniform int debugMode = 0;
+
 // the scaled texture coordinate to use in calculations
 vec2 fragmentTextureCoordinateScaled = fragmentTextureCoordinate * UVscale;
 
@@ -68,9 +75,23 @@ vec2 fragmentTextureCoordinateScaled = fragmentTextureCoordinate * UVscale;
 vec3 CalcDirectionalLight(DirectionalLight light, vec3 normal, vec3 viewDir);
 vec3 CalcPointLight(PointLight light, vec3 normal, vec3 fragPos, vec3 viewDir);
 vec3 CalcSpotLight(SpotLight light, vec3 normal, vec3 fragPos, vec3 viewDir);
+vec4 CalcShaderCost();
 
 void main()
 {   
+    if(debugMode == DEBUG_VIEW_OVERDRAW)
+    {
+        // every written fragment adds one step, so a pixel goes from
+        // dark red through orange and yellow to white as layers pile up
+        fragmentColor = vec4(1.0f / 8.0f, 1.0f / 16.0f, 1.0f / 32.0f, 1.0f);
+        return;
+    }
+    if(debugMode == DEBUG_VIEW_SHADER_COST)
+    {
+        fragmentColor = CalcShaderCost();
+        return;
+    }
+
     if(bUseLighting == true)
     {
         vec3 phongResult = vec3(0.0f);
@@ -226,3 +247,48 @@ vec3 CalcSpotLight(SpotLight light, vec3 normal, vec3 fragPos, vec3 viewDir)
     specular *= attenuation * intensity;
     return (ambient + diffuse + specular);
 }
+
+// colors a fragment by the work the normal path does for it - the
+// active lights and the texture fetches made by the functions above -
+// from blue for a flat color up to red at 16 or more units of work
+vec4 CalcShaderCost()
+{
+    int lights = 0;
+    int fetches = 0;
+
+    if(bUseLighting == true)
+    {
+        if(directionalLight.bActive == true)
+        {
+            lights++;
+            fetches += 3;
+        }
+        for(int i = 0; i < TOTAL_POINT_LIGHTS; i++)
+        {
+            if(pointLights[i].bActive == true)
+            {
+                lights++;
+                fetches += 2;
+            }
+        }
+        if(spotLight.bActive == true)
+        {
+            lights++;
+            fetches += 3;
+        }
+    }
+    // the final color reads the texture once more
+    fetches += 1;
+    if(bUseTexture == false)
+    {
+        fetches = 0;
+    }
+
+    float cost = clamp(float(lights + fetches) / 16.0f, 0.0f, 1.0f);
+    vec3 cheap = vec3(0.0f, 0.0f, 1.0f);
+    vec3 middle = vec3(0.0f, 1.0f, 0.0f);
+    vec3 expensive = vec3(1.0f, 0.0f, 0.0f);
+    vec3 color = (cost < 0.5f) ? mix(cheap, middle, cost * 2.0f) : mix(middle, expensive, cost * 2.0f - 1.0f);
+
+    return vec4(color, 1.0f);
+}
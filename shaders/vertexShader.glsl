@@ -11,10 +11,31 @@ uniform mat4 model;
 uniform mat4 view;
 uniform mat4 projection;
 
+// model matrices of the scene objects, three rows per object,
+// used in place of the model uniform while bUseObjectBuffer is set
+uniform samplerBuffer objectModels;
+uniform int objectIndex;
+uniform bool bUseObjectBuffer;
+
+mat4 GetModelMatrix()
+{
+   if (!bUseObjectBuffer)
+   {
+      return model;
+   }
+
+   int texel = objectIndex * 3;
+   vec4 row0 = texelFetch(objectModels, texel);
+   vec4 row1 = texelFetch(objectModels, texel + 1);
+   vec4 row2 = texelFetch(objectModels, texel + 2);
+   return transpose(mat4(row0, row1, row2, vec4(0.0, 0.0, 0.0, 1.0)));
+}
+
 void main()
 {
-   fragmentPosition = vec3(model * vec4(inVertexPosition, 1.0));
-   gl_Position = projection * view * model * vec4(inVertexPosition, 1.0f);
+   mat4 objectModel = GetModelMatrix();
+   fragmentPosition = vec3(objectModel * vec4(inVertexPosition, 1.0));
+   gl_Position = projection * view * objectModel * vec4(inVertexPosition, 1.0f);
    fragmentVertexNormal = inVertexNormal;
    fragmentTextureCoordinate = inTextureCoordinate;
 }
\ No newline at end of file